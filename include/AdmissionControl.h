@@ -0,0 +1,89 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <utility> // Include this line before Boost.Asio headers
+#include <boost/asio/ip/address.hpp>
+#include "./config/export_libs.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+namespace SN_Server
+{
+    // Whether A New Connection May Come In, And If Not Which Limit Turned It Away
+    enum AdmissionDecision
+    {
+        Admitted = 0b0,
+        RejectedTooManyConnections = 0b1,
+        RejectedTooManyFromAddress = 0b10,
+        RejectedAcceptRate = 0b100,
+        RejectedBufferedMemory = 0b1000
+    };
+
+    //* Limits Checked Before A Connection Gets A Session Or A Thread (0 Turns A Limit Off)
+    struct AdmissionLimits
+    {
+        // Connections Open At Once (Every One Of Them Has Its Own Thread)
+        std::size_t max_connections = 1024;
+
+        // Connections Open At Once From One IP Address
+        std::size_t max_connections_per_address = 64;
+
+        // Token Bucket: Accepts Refill At This Rate, Up To accept_burst At Once
+        double accepts_per_second = 200.0;
+        std::size_t accept_burst = 100;
+
+        // Bytes Waiting In All Send Queues Past Which New Clients Are Turned Away
+        std::size_t max_buffered_bytes = 256 * 1024 * 1024;
+
+        // Rejected Plain TCP Clients Get "BUSY retry-after=<seconds>" Before The Close
+        // (TLS Clients Are Always Just Closed: A Frame Needs A Handshake First)
+        bool send_busy_frame = true;
+        std::chrono::seconds retry_after = std::chrono::seconds(1);
+    };
+
+    //* Decides At Accept Time Whether A Connection Is Served
+    // Admit() And Release() Are Called In Pairs For Every Admitted Connection
+    class AdmissionControl
+    {
+    private:
+        mutable std::mutex admission_mutex;
+        AdmissionLimits limits;
+
+        std::size_t open_connections = 0;
+        std::map<boost::asio::ip::address, std::size_t> connections_per_address;
+
+        // Token Bucket Of The Accept Rate
+        double accept_tokens;
+        std::chrono::steady_clock::time_point last_refill;
+
+        // Rejections So Far, Indexed By The Bit Of Their AdmissionDecision
+        std::array<std::atomic<std::uint64_t>, 4> rejected{};
+
+        void RefillAcceptTokens(std::chrono::steady_clock::time_point now);
+
+    public:
+        explicit AdmissionControl(const AdmissionLimits &limits = AdmissionLimits());
+
+        AdmissionControl(const AdmissionControl &) = delete;
+        AdmissionControl &operator=(const AdmissionControl &) = delete;
+
+        void SetLimits(const AdmissionLimits &limits);
+        AdmissionLimits GetLimits() const;
+
+        // Check Every Limit, And Count The Connection In If It Passes
+        AdmissionDecision Admit(const boost::asio::ip::address &address, std::size_t buffered_bytes);
+
+        // An Admitted Connection Is Gone
+        void Release(const boost::asio::ip::address &address);
+
+        std::size_t OpenConnections() const;
+        std::uint64_t RejectedCount(AdmissionDecision reason) const;
+        std::uint64_t RejectedCount() const;
+    };
+}
+
+#endif // ADMISSION_CONTROL_H
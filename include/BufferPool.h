@@ -0,0 +1,47 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include "./config/export_libs.h"
+#include "ClientConnection.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SN_Server
+{
+    //* Recycles Output Buffers, So Building A Message Reuses The Capacity Of An Earlier One
+    // A Buffer Shared With The Send Queues Comes Back Here When The Last Queue Drops It
+    // Create It With std::make_shared (Shared Buffers Only Hold A weak_ptr To The Pool)
+    class BufferPool : public std::enable_shared_from_this<BufferPool>
+    {
+    private:
+        std::mutex free_buffers_mutex;
+        std::vector<std::unique_ptr<std::string>> free_buffers;
+
+        // At Most This Many Idle Buffers Are Kept
+        std::size_t max_pooled_buffers;
+
+        // Buffers That Grew Past This Are Freed Instead Of Kept
+        std::size_t max_pooled_capacity;
+
+    public:
+        BufferPool(std::size_t max_pooled_buffers = 64, std::size_t max_pooled_capacity = 1 << 20);
+
+        BufferPool(const BufferPool &) = delete;
+        BufferPool &operator=(const BufferPool &) = delete;
+
+        // An Empty Buffer, With The Capacity Of A Recycled One When There Is One
+        std::unique_ptr<std::string> Acquire();
+
+        // Give A Buffer Back Without Sending It
+        void Release(std::unique_ptr<std::string> buffer);
+
+        // Turn A Filled Buffer Into A SharedBuffer That Returns To The Pool When Released
+        SharedBuffer Share(std::unique_ptr<std::string> buffer);
+
+        std::size_t PooledBuffers();
+    };
+}
+
+#endif // BUFFER_POOL_H
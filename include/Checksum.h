@@ -0,0 +1,84 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include "./config/export_libs.h"
+#include <openssl/evp.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace SN_Server
+{
+    //* Incremental CRC32C (Castagnoli)
+    // Uses The SSE4.2 crc32 Instruction When The CPU Has It, Slice-By-8 Tables Otherwise
+    class Crc32c
+    {
+    private:
+        // Raw CRC Register (Pre-Inverted)
+        std::uint32_t state = 0xFFFFFFFF;
+
+    public:
+        // Feed More Bytes Into The Checksum
+        void Update(const void *data, std::size_t size);
+
+        // The Checksum Of Every Byte Fed So Far
+        std::uint32_t Value() const;
+
+        // Whether Update Runs On The Hardware Instruction
+        static bool HasHardwareSupport();
+    };
+
+    //* Incremental SHA-256 On Top Of libcrypto's EVP Interface
+    class Sha256Digest
+    {
+    private:
+        EVP_MD_CTX *context;
+
+    public:
+        Sha256Digest();
+        ~Sha256Digest();
+
+        Sha256Digest(const Sha256Digest &) = delete;
+        Sha256Digest &operator=(const Sha256Digest &) = delete;
+
+        // Feed More Bytes Into The Digest
+        void Update(const void *data, std::size_t size);
+
+        // Finish The Digest And Return It As 64 Lowercase Hex Characters
+        std::string FinalHex();
+    };
+
+    enum TransferIntegrity
+    {
+        IntegrityNone = 0b0,
+        IntegrityCrc32c = 0b1,
+        IntegrityCrc32cSha256 = 0b11
+    };
+
+    //* Checksums Of One Transfer, Updated As Every Chunk Passes Through
+    // Trailer Format: "crc32c:<8 hex>" Or "crc32c:<8 hex> sha256:<64 hex>"
+    class TransferChecksum
+    {
+    private:
+        TransferIntegrity integrity;
+        Crc32c crc32c;
+
+        // Only Made For IntegrityCrc32cSha256: Any Other Transfer Skips The EVP Context Allocation
+        std::optional<Sha256Digest> sha256;
+
+    public:
+        TransferChecksum(TransferIntegrity integrity);
+
+        void Update(std::string_view chunk);
+
+        // Finish The Checksums And Format Them As A Trailer
+        std::string FinalTrailer();
+
+        // Compare A Received Trailer With The Computed One
+        // Only The Fields That Are Present In The Received Trailer Are Compared
+        static bool TrailerMatches(std::string_view received_trailer, std::string_view computed_trailer);
+    };
+}
+
+#endif // CHECKSUM_H
@@ -0,0 +1,312 @@
+#ifndef CLIENT_CONNECTION_H
+#define CLIENT_CONNECTION_H
+
+#include <utility> // Include this line before Boost.Asio headers
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include "./config/export_libs.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace SN_Server
+{
+    // TLS Over A TCP Socket
+    using TlsStream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+    // Unix Domain Stream Socket, For Clients On The Same Host
+    using LocalSocket = boost::asio::local::stream_protocol::socket;
+
+    // Immutable Message That Many Send Queues Can Share Without Copying
+    using SharedBuffer = std::shared_ptr<const std::string>;
+
+    // Called On The Connection's Strand Once A Queued Message Is Written (Or Failed)
+    using SendHandler = std::function<void(const boost::system::error_code &, std::size_t)>;
+
+    // What AsyncSend Does When A Send Queue Is Over Its High Watermark
+    enum OverflowPolicy
+    {
+        // Wait Until The Queue Is Back Under The Low Watermark (Never On An io_context Thread)
+        OverflowBlock = 0b1,
+        // Queue The New Message And Drop The Oldest AsyncSend Messages Not Being Written Yet
+        OverflowDropOldest = 0b10,
+        // Give Up On The Client: Close It
+        OverflowDisconnect = 0b100
+    };
+
+    // What Happened To A Message Given To AsyncSend
+    enum SendOutcome
+    {
+        SendQueued = 0b1,
+        // Queued, But The Queue Is Over Its High Watermark: Slow Down Or Wait (WaitUntilWritable)
+        SendQueuedAboveHighWatermark = 0b10,
+        // Not Queued (The Client Was Disconnected Or Is Closed)
+        SendRejected = 0b100
+    };
+
+    //* Limits Of One Send Queue, In Bytes Of Queued Messages
+    struct SendQueueLimits
+    {
+        std::size_t high_watermark = 8 * 1024 * 1024;
+        std::size_t low_watermark = 2 * 1024 * 1024;
+        OverflowPolicy overflow_policy = OverflowPolicy::OverflowBlock;
+    };
+
+    //* Bytes Queued Across Every Send Queue Sharing This Account
+    // Once Over The Limit, Every Queue Over Its Low Watermark Counts As Overflowing
+    // (A Broadcast Frame Is Counted Once Per Queue, So The Figure Errs On The High Side)
+    class SendMemoryAccount
+    {
+    private:
+        std::atomic<std::size_t> total_bytes{0};
+        std::atomic<std::size_t> limit_bytes;
+
+    public:
+        explicit SendMemoryAccount(std::size_t limit_bytes = 256 * 1024 * 1024);
+
+        void Add(std::size_t bytes);
+        void Remove(std::size_t bytes);
+
+        std::size_t TotalBytes() const;
+        std::size_t LimitBytes() const;
+        void SetLimitBytes(std::size_t limit_bytes);
+        bool IsOverLimit() const;
+    };
+
+    // Where A Client Is In Its Request/Reply Cycle (Read By The Server's Drain)
+    enum RequestState
+    {
+        RequestIdle = 0b0,
+        RequestBusy = 0b1,
+        RequestClosing = 0b10
+    };
+
+    //* One Connected Client, Over Plain TCP, TLS Or A Unix Domain Socket
+    // The Server's Send/Get Protocols Only Talk To The Client Through This Class
+    // Every Operation On The Transport Runs On The Connection's Strand, So The
+    // Client Thread's Reads And The Send Queue's Writes Never Race (Required For TLS)
+    // Except Reads Of Plain TCP: They Share No State With The Writes, The Client Thread recv()s Itself
+    class ClientConnection : public std::enable_shared_from_this<ClientConnection>
+    {
+    private:
+        // One Entry Of The Send Queue: A Shared Buffer Or A Range Of An Open File
+        struct OutboundMessage
+        {
+            SharedBuffer data;
+            int file_descriptor = -1;
+            std::uint64_t offset = 0;
+            std::uint64_t count = 0;
+            std::uint64_t sent = 0;
+            SendHandler on_sent;
+
+            // Passed Along With The First Byte (SCM_RIGHTS, Local Clients Only), Still Owned By The Sender
+            std::vector<int> descriptors;
+
+            // Bytes Counted In queued_bytes For This Message
+            std::size_t accounted_bytes = 0;
+
+            // Queued By AsyncSend (Broadcasts, Notifications): OverflowDropOldest May Drop It
+            // Never Set For Parts Of A Reply Or For Messages A Producer Is Waiting On
+            bool is_droppable = false;
+        };
+
+        // The Transport Of This Client
+        std::variant<boost::asio::ip::tcp::socket, TlsStream, LocalSocket> stream;
+
+        // Serializes Every Operation On The Transport
+        boost::asio::strand<boost::asio::any_io_executor> strand;
+
+        // Outbound Messages, Written One After Another (Only Touched On The Strand)
+        std::deque<OutboundMessage> send_queue;
+        bool write_in_progress = false;
+
+        // Bytes Of Buffers Queued And Not Yet Written (Updated From Any Thread)
+        std::atomic<std::size_t> queued_bytes{0};
+        SendQueueLimits send_limits;
+        std::shared_ptr<SendMemoryAccount> memory_account;
+
+        // Producers Waiting For The Queue To Drain Under The Low Watermark
+        std::mutex writable_mutex;
+        std::condition_variable writable_condition;
+        std::vector<std::function<void()>> writable_waiters; // Only Touched On The Strand
+
+        // Set Once Close() Ran, Wakes Producers Waiting For Room
+        std::atomic<bool> is_closed{false};
+
+        // The io_context Running The Strand (To Refuse Blocking On Its Threads)
+        boost::asio::io_context *owner_io_context;
+        bool IsOnIoThread() const;
+
+        // TLS Writes Must Wait For The Handshake, Or They Would Race It Inside The Engine
+        bool ready_to_write;
+
+        // RequestState, Changed Only Through The Atomic Transitions Below
+        std::atomic<int> request_state{RequestIdle};
+
+        // AsyncSend Messages Arriving While A Request Is Busy, Queued Once Its Reply Is Done
+        // Idle <-> Busy And The Choice To Hold Happen Under request_mutex, So None Lands Inside A Reply
+        // Held Bytes Are Not In queued_bytes (Nothing Drains Them Before EndRequest), They Have Their Own Bound
+        std::mutex request_mutex;
+        std::condition_variable held_condition;
+        std::deque<OutboundMessage> held_messages;
+        std::size_t held_bytes = 0;
+
+        // The Thread Serving The Busy Request (It Must Never Wait For Its Own Request To End)
+        std::thread::id request_thread;
+
+        // Activity Times For The Server's Timeouts (steady_clock Ticks, 0 -> Not Waiting)
+        std::atomic<std::int64_t> read_waiting_since{0};
+        std::atomic<std::int64_t> write_waiting_since{0};
+        std::atomic<std::int64_t> last_write_time;
+
+        // "address:port" (Or "unix:pid=<pid>") Of The Client, Kept So It Can Still Be Logged After Close
+        std::string remote_address;
+
+        // Native Socket Handle (For sendfile And Direct Reads)
+        int native_handle;
+
+        // File Descriptors A Local Client Passed With SCM_RIGHTS, Oldest First (Owned Until Taken)
+        std::mutex descriptors_mutex;
+        std::deque<int> received_descriptors;
+
+        // Call function With The Socket Under The Transport (TCP Or Unix Domain)
+        template <typename Function>
+        decltype(auto) VisitLowestLayer(Function &&function);
+
+        //* Read Of A Local Client, Keeping The File Descriptors Sent Along (On The Strand)
+        void ReceiveWithDescriptors(boost::asio::mutable_buffer buffer, SendHandler done);
+
+#ifdef __linux__
+        //* Read Of A Plain TCP Client, Blocking The Client Thread Only (No Strand Round Trip)
+        std::size_t ReceiveDirect(boost::asio::mutable_buffer buffer, boost::system::error_code &error);
+#endif
+
+        //* Put An AsyncSend Message On The Strand's Queue (From Any Thread)
+        void PostAsyncMessage(OutboundMessage message);
+
+        //* Send Queue Steps (On The Strand)
+        void Enqueue(OutboundMessage message);
+        void StartNextWrite();
+        void ContinueFileSend();
+        void ContinueDescriptorSend();
+        void FinishFrontMessage(const boost::system::error_code &error);
+        void DropOldestOverHighWatermark();
+
+        //* Queue Accounting
+        void ReserveQueuedBytes(std::size_t bytes);
+        void ReleaseQueuedBytes(std::size_t bytes);
+        bool IsOverflowing() const;
+        void NotifyWritable();
+
+        //* Run An Asynchronous Operation On The Strand And Block Until It Completes
+        // Must Not Be Called From The io_context Threads
+        std::size_t RunAndWait(const std::function<void(SendHandler)> &start, boost::system::error_code &error);
+
+    public:
+        // Plain TCP Client
+        explicit ClientConnection(boost::asio::ip::tcp::socket socket);
+
+        // TLS Client, The Handshake Is Done By Handshake()
+        ClientConnection(boost::asio::ip::tcp::socket socket, boost::asio::ssl::context &tls_context);
+
+        // Local Client Of A Unix Domain Socket
+        explicit ClientConnection(LocalSocket socket);
+
+        ~ClientConnection();
+
+        ClientConnection(const ClientConnection &) = delete;
+        ClientConnection &operator=(const ClientConnection &) = delete;
+
+        bool IsTls() const;
+        bool IsLocal() const;
+        bool IsOpen() const;
+
+        // Server Side TLS Handshake (Does Nothing For Plain TCP)
+        void Handshake(boost::system::error_code &error);
+
+        // Whether The TLS Session Was Resumed From A Ticket Or The Session Cache
+        bool IsSessionReused();
+
+        // Synchronous Read Of Whatever Is Available (At Least 1 Byte)
+        std::size_t ReadSome(boost::asio::mutable_buffer buffer, boost::system::error_code &error);
+
+        // The Oldest File Descriptor A Local Client Passed Along With Its Bytes (SCM_RIGHTS)
+        // -1 If There Is None, Otherwise The Caller Owns (And Closes) It
+        int TakeReceivedDescriptor();
+
+        // Queue A Message, on_sent Runs Once It Is Written (Or Dropped/Failed)
+        // Returns At Once Unless The Queue Overflows Under OverflowBlock
+        // While A Request Is Busy The Message Waits For EndRequest(), So It Never Splits A Reply
+        SendOutcome AsyncSend(SharedBuffer message, SendHandler on_sent = nullptr);
+
+        // Queue A Message And Wait Until It Is Written
+        std::size_t Send(SharedBuffer message, boost::system::error_code &error);
+
+        // Synchronous Write Of The Whole Buffer (Copied Into The Send Queue)
+        std::size_t Write(boost::asio::const_buffer buffer, boost::system::error_code &error);
+
+        // Send A Message With Open Files Attached (SCM_RIGHTS), Local Clients Only
+        // The Descriptors Must Stay Open Until This Returns, The Client Gets Its Own Copies
+        std::size_t SendDescriptors(SharedBuffer message, const std::vector<int> &descriptors, boost::system::error_code &error);
+
+        // Send count Bytes Of An Open File Starting At offset, In Queue Order
+        // Zero-Copy Through sendfile For Plain TCP And Local Clients, Read And Encrypt For TLS
+        std::size_t SendFile(int file_descriptor, std::uint64_t offset, std::uint64_t count, boost::system::error_code &error);
+
+        // Shut Down The Transport (Wakes Up A Blocked ReadSome)
+        // The Descriptor Stays Valid Until The Connection Is Destroyed, After Its Client Thread Let Go Of It
+        void Close();
+
+        //* Request Bookkeeping For A Draining Server
+        // Idle -> Busy Once Bytes Of A Request Arrive, False If The Client Is Already Closing
+        bool BeginRequest();
+
+        // Busy -> Idle Once The Reply Is Done, Then The AsyncSend Messages Held Meanwhile Are Queued
+        void EndRequest();
+
+        // Idle -> Closing, False If A Request Is In Flight (Or It Was Already Closing)
+        bool MarkClosing();
+
+        RequestState GetRequestState() const;
+
+        const std::string &RemoteAddress() const;
+
+        // The Socket's Descriptor (To Watch It For A Hang-Up, Never To Read Or Write It)
+        int NativeHandle() const;
+
+        //* Activity, For Timeouts And Heartbeats (time_point{} -> Not Waiting)
+        // Since When A ReadSome Has Been Waiting For Bytes
+        std::chrono::steady_clock::time_point ReadWaitingSince() const;
+
+        // Since When The Write At The Front Of The Send Queue Has Made No Progress
+        std::chrono::steady_clock::time_point WriteWaitingSince() const;
+
+        // When Bytes Were Last Written (The Connect Time Before That)
+        std::chrono::steady_clock::time_point LastWriteTime() const;
+
+        //* Send Queue Backpressure
+        void SetSendLimits(const SendQueueLimits &send_limits, std::shared_ptr<SendMemoryAccount> memory_account = nullptr);
+        const SendQueueLimits &GetSendLimits() const;
+
+        std::size_t QueuedBytes() const;
+        bool IsAboveHighWatermark() const;
+
+        // Block Until The Queue Is Under The Low Watermark (Or The Client Closed, Or timeout)
+        // Return Whether It Is Writable
+        bool WaitUntilWritable(std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+        // Run handler On The Strand Once The Queue Is Under The Low Watermark
+        void AsyncWaitWritable(std::function<void()> handler);
+    };
+}
+
+#endif // CLIENT_CONNECTION_H
@@ -0,0 +1,121 @@
+#ifndef COMMAND_TABLE_H
+#define COMMAND_TABLE_H
+
+#include "./config/export_libs.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SN_Server
+{
+    //* Seeded FNV-1a Of A Command Name (Also Usable At Compile Time)
+    constexpr std::uint32_t CommandHash(std::string_view name, std::uint32_t seed)
+    {
+        std::uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+        for (char character : name)
+        {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 16777619u;
+        }
+
+        // Final Mix, So Nearby Seeds Spread The Names Differently
+        hash ^= hash >> 15;
+        hash *= 0x2c1b3c6du;
+        hash ^= hash >> 12;
+        return hash;
+    }
+
+    // Slots For count Names: A Power Of Two, At Least Twice count (So A Seed Is Found Fast)
+    constexpr std::size_t CommandSlotCount(std::size_t count)
+    {
+        std::size_t slot_count = 4;
+        while (slot_count < 2 * count)
+        {
+            slot_count <<= 1;
+        }
+        return slot_count;
+    }
+
+    //* Perfect Hash Of A Fixed Set Of Names, Built By The Compiler
+    // Find() Costs One Hash, One Slot And One Comparison, No Map And No Virtual Call
+    // The Names Must Be Distinct (Otherwise No Seed Exists And Compiling Fails)
+    template <std::size_t Count>
+    class StaticCommandTable
+    {
+    private:
+        static constexpr std::size_t SLOT_COUNT = CommandSlotCount(Count);
+
+        std::array<std::string_view, Count> names;
+
+        // Index + 1 Of The Name In Each Slot (0 -> Empty)
+        std::array<std::size_t, SLOT_COUNT> slots{};
+        std::uint32_t seed = 0;
+
+        constexpr bool TryFill()
+        {
+            this->slots.fill(0);
+            for (std::size_t index = 0; index < Count; index++)
+            {
+                std::size_t slot = CommandHash(this->names[index], this->seed) & (SLOT_COUNT - 1);
+                if (this->slots[slot] != 0)
+                {
+                    return false;
+                }
+                this->slots[slot] = index + 1;
+            }
+            return true;
+        }
+
+    public:
+        // What Find() Returns For A Name Not In The Table
+        static constexpr std::size_t NOT_FOUND = Count;
+
+        constexpr explicit StaticCommandTable(const std::array<std::string_view, Count> &names) : names(names)
+        {
+            while (!this->TryFill())
+            {
+                this->seed++;
+            }
+        }
+
+        // Index Of name In The Names Given, Or NOT_FOUND
+        constexpr std::size_t Find(std::string_view name) const
+        {
+            std::size_t slot = this->slots[CommandHash(name, this->seed) & (SLOT_COUNT - 1)];
+            if (slot != 0 && this->names[slot - 1] == name)
+            {
+                return slot - 1;
+            }
+            return NOT_FOUND;
+        }
+    };
+
+    //* Same Perfect Hash, For Names Only Known At Run Time (Registered By The Application)
+    // Built Once Before The Server Starts, Then Only Read (Safe From Every Client Thread)
+    class CommandTable
+    {
+    private:
+        std::vector<std::string> names;
+
+        // Index + 1 Of The Name In Each Slot (0 -> Empty)
+        std::vector<std::size_t> slots;
+        std::size_t slot_mask = 0;
+        std::uint32_t seed = 0;
+
+    public:
+        // What Find() Returns For A Name Not In The Table
+        static constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+        // Search A Seed Without Collisions For names (Duplicates Are Ignored, The First One Wins)
+        void Build(const std::vector<std::string> &names);
+
+        // Index Of name In The Names Built From, Or NOT_FOUND
+        std::size_t Find(std::string_view name) const;
+
+        std::size_t Size() const;
+    };
+}
+
+#endif // COMMAND_TABLE_H
@@ -0,0 +1,82 @@
+#ifndef CONTENT_STORE_H
+#define CONTENT_STORE_H
+
+#include "./config/export_libs.h"
+#include "Checksum.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace SN_Server
+{
+    //* Files Stored Under Their SHA-256 Digest
+    // Layout: <root>/objects/<first 2 hex>/<digest>
+    //         <root>/staging/<unique name>   (uploads in progress)
+    class ContentStore
+    {
+    private:
+        // Root Directory Of The Store
+        std::string root_directory;
+
+        // To Give Every Staging File A Unique Name
+        std::atomic<std::uint64_t> staging_counter;
+
+    public:
+        //* Streams One Upload Into The Store, Hashing Every Byte On The Fly
+        class Writer
+        {
+        private:
+            ContentStore *store;
+            std::string staging_file;
+            std::ofstream staging_stream;
+            Sha256Digest digest;
+            std::uint64_t total_written = 0;
+            bool finished = false;
+
+        public:
+            Writer(ContentStore *store, std::string staging_file);
+            ~Writer();
+
+            Writer(const Writer &) = delete;
+            Writer &operator=(const Writer &) = delete;
+
+            bool IsOpen() const;
+            void Write(const void *data, std::size_t size);
+
+            // Copy A Whole Open File Into The Upload (Hashed Like Write), From Its Start
+            // Return Whether It Was Read To The End
+            bool WriteFromDescriptor(int file_descriptor);
+            std::uint64_t TotalWritten() const;
+
+            // Move The Staging File Under Its Digest
+            // If The Store Already Has That Digest The Staging Copy Is Dropped
+            // Return The Digest Or An Empty String On Error
+            std::string Commit();
+
+            // Throw Away The Staging File
+            void Abort();
+        };
+
+        ContentStore(std::string_view root_directory = "store");
+
+        // Check The Digest Is 64 Hex Characters
+        static bool IsValidDigest(std::string_view digest);
+
+        std::string_view GetRootDirectory() const;
+        std::string ObjectPath(std::string_view digest) const;
+
+        // Whether An Object With That Digest Already Exists
+        bool Contains(std::string_view digest) const;
+
+        // Start Storing A New Upload
+        Writer BeginWrite();
+
+        // Hard-Link The Stored Object Into destination (Replacing It Atomically)
+        // Fall Back To A Copy If The Destination Is On Another Filesystem
+        bool LinkInto(std::string_view digest, const std::string &destination) const;
+    };
+}
+
+#endif // CONTENT_STORE_H
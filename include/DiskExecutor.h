@@ -0,0 +1,330 @@
+#ifndef DISK_EXECUTOR_H
+#define DISK_EXECUTOR_H
+
+#include "./config/export_libs.h"
+#include "BufferPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SN_Server
+{
+    //* Fixed-Size Lock-Free Queue Between Exactly One Producer Thread And One Consumer Thread
+    template <typename T>
+    class SpscQueue
+    {
+    private:
+        std::vector<T> slots;
+        std::size_t mask;
+
+        // Positions Only Grow, Each Written By One Side (Own Cache Line, No False Sharing)
+        alignas(64) std::atomic<std::size_t> head{0}; // Next Slot To Pop (Consumer)
+        alignas(64) std::atomic<std::size_t> tail{0}; // Next Slot To Push (Producer)
+
+    public:
+        // capacity Is Rounded Up To A Power Of Two
+        explicit SpscQueue(std::size_t capacity)
+        {
+            std::size_t slot_count = 2;
+            while (slot_count < capacity)
+            {
+                slot_count <<= 1;
+            }
+            this->slots.resize(slot_count);
+            this->mask = slot_count - 1;
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        // Producer: Move item In (Left Untouched If The Queue Is Full)
+        bool TryPush(T &item)
+        {
+            std::size_t tail = this->tail.load(std::memory_order_relaxed);
+            if (tail - this->head.load(std::memory_order_acquire) == this->slots.size())
+            {
+                return false;
+            }
+            this->slots[tail & this->mask] = std::move(item);
+            this->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer: Move The Oldest Item Out
+        bool TryPop(T &item)
+        {
+            std::size_t head = this->head.load(std::memory_order_relaxed);
+            if (head == this->tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = std::move(this->slots[head & this->mask]);
+            this->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool IsEmpty() const
+        {
+            return this->head.load(std::memory_order_acquire) == this->tail.load(std::memory_order_acquire);
+        }
+
+        bool IsFull() const
+        {
+            return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire) == this->slots.size();
+        }
+    };
+
+    //* Memory Block Of A DiskWriter, Aligned So O_DIRECT Can Write It As Is
+    struct AlignedBlock
+    {
+        // Alignment Of The Memory, And Of The Offsets And Sizes Written With O_DIRECT
+        static constexpr std::size_t ALIGNMENT = 4096;
+
+        char *data;
+        std::size_t capacity;
+        std::size_t size = 0;
+
+        // capacity Is Rounded Up To A Multiple Of ALIGNMENT
+        explicit AlignedBlock(std::size_t capacity);
+        ~AlignedBlock();
+
+        AlignedBlock(const AlignedBlock &) = delete;
+        AlignedBlock &operator=(const AlignedBlock &) = delete;
+    };
+
+    //* Recycles AlignedBlocks Between Writers (Allocating Aligned Memory Per Block Would Cost More Than Copying Into It)
+    class AlignedBufferPool
+    {
+    private:
+        std::mutex free_blocks_mutex;
+        std::vector<std::unique_ptr<AlignedBlock>> free_blocks;
+        std::size_t max_pooled_blocks;
+
+    public:
+        explicit AlignedBufferPool(std::size_t max_pooled_blocks = 64);
+
+        AlignedBufferPool(const AlignedBufferPool &) = delete;
+        AlignedBufferPool &operator=(const AlignedBufferPool &) = delete;
+
+        // An Empty Block Of At Least capacity Bytes
+        std::unique_ptr<AlignedBlock> Acquire(std::size_t capacity);
+        void Release(std::unique_ptr<AlignedBlock> block);
+    };
+
+    // One Disk Thread And The Streams Waiting For It (Defined In DiskExecutor.cpp)
+    class DiskWorker;
+
+    //* A File Written Or Read On A Disk Thread, Fed Or Drained By One Network Thread
+    // Blocks Travel Between The Two Through An SpscQueue Of The Stream, And Go Back To A Pool Once Used
+    // A Stream Stays On One Disk Thread, So Its Blocks Hit The Disk In Order
+    class DiskStream : public std::enable_shared_from_this<DiskStream>
+    {
+        friend class DiskWorker;
+
+    private:
+        std::shared_ptr<DiskWorker> worker;
+
+        // Whether The Stream Is Queued On (Or Running On) Its Disk Thread
+        std::atomic<bool> is_scheduled{false};
+
+        // Called By The Disk Thread: Run, Then Go Again If Work Came Meanwhile
+        void RunScheduled();
+
+    protected:
+        int descriptor;
+
+        // The Network Thread Waits Here For Room, Blocks Or The End
+        std::mutex progress_mutex;
+        std::condition_variable progress;
+
+        // errno Of The First Failed Read Or Write (0 -> None)
+        std::atomic<int> error_number{0};
+
+        // Make Sure The Disk Thread Will Look At This Stream
+        void Schedule();
+        void NotifyProgress();
+
+        virtual bool HasDiskWork() const = 0;
+        virtual void RunOnDisk() = 0;
+
+    public:
+        DiskStream(std::shared_ptr<DiskWorker> worker, int descriptor);
+        virtual ~DiskStream();
+
+        DiskStream(const DiskStream &) = delete;
+        DiskStream &operator=(const DiskStream &) = delete;
+
+        bool HasFailed() const;
+    };
+
+    //* Direct I/O Of A DiskWriter
+    struct DirectIoOptions
+    {
+        // A Writer Switches To O_DIRECT Once Its File Is Known (Announced) Or Seen (Written) To Reach This (0 -> Never)
+        // Bulk Uploads Then Bypass The Page Cache Instead Of Evicting The Rest Of The Machine's Working Set
+        std::uint64_t threshold_bytes = 1ull << 30;
+    };
+
+    //* A File Filled By The Network Thread: Write() Only Copies Into A Block, The Disk Thread Writes It
+    // Blocks Are Written With pwrite() At Their Own Offset, Into The Preallocated Extent When There Is One
+    // Past The Direct I/O Threshold Full Blocks Go Through A Second O_DIRECT Descriptor, Only The Tail Through The Page Cache
+    class DiskWriter : public DiskStream
+    {
+    private:
+        std::string path;
+        std::size_t block_size;
+        std::shared_ptr<AlignedBufferPool> aligned_blocks;
+        SpscQueue<std::unique_ptr<AlignedBlock>> blocks;
+        std::unique_ptr<AlignedBlock> current_block;
+
+        // Bytes fallocate() Reserved Up Front (0 -> The File Grows As It Is Written)
+        std::uint64_t preallocated_bytes;
+
+        // Where The First Byte Goes (Not 0 For A Range Of A File Written By Several Writers)
+        std::uint64_t start_offset;
+
+        // O_DIRECT Descriptor Of The Same File, Opened By The Disk Thread Past The Threshold
+        DirectIoOptions direct_io;
+        int direct_descriptor = -1;
+        bool is_direct_unavailable = false;
+        std::atomic<std::uint64_t> direct_bytes{0};
+
+        // Whether The Block At offset Should Go Through O_DIRECT (Opening The Descriptor On First Use)
+        bool UseDirectIo(const AlignedBlock &block, std::uint64_t offset);
+
+        // Blocks Handed Over But Not Yet Written
+        std::atomic<std::size_t> queued_blocks{0};
+        std::uint64_t written_bytes = 0; // Only Touched On The Disk Thread (Read By Finish Once It Is Idle)
+
+        void PushBlock();
+
+        bool HasDiskWork() const override;
+        void RunOnDisk() override;
+
+    public:
+        DiskWriter(
+            std::shared_ptr<DiskWorker> worker,
+            int descriptor,
+            const std::string &path,
+            std::shared_ptr<AlignedBufferPool> aligned_blocks,
+            std::size_t queue_depth,
+            std::size_t block_size,
+            std::uint64_t preallocated_bytes,
+            const DirectIoOptions &direct_io,
+            std::uint64_t start_offset = 0
+        );
+        ~DiskWriter() override;
+
+        // Waits Only When queue_depth Blocks Are Already Waiting For The Disk
+        // False Once A Write Has Failed
+        bool Write(std::string_view data);
+
+        // Hand Over The Last Block, Wait Until Everything Is Written And Close The File
+        // A Preallocated File Written Short Is Cut Back To What Was Written
+        // True If Every Byte Was Written
+        bool Finish();
+
+        // Bytes Written So Far (Exact Once Finish Returned)
+        std::uint64_t BytesWritten() const;
+
+        // Of Them, Bytes Written With O_DIRECT
+        std::uint64_t DirectBytesWritten() const;
+    };
+
+    //* A File (Or A Range Of It) Read Ahead By The Disk Thread While The Network Thread Sends What Came Before
+    class DiskReader : public DiskStream
+    {
+    private:
+        std::shared_ptr<BufferPool> buffers;
+        SpscQueue<std::unique_ptr<std::string>> blocks;
+
+        std::size_t block_size;
+        std::uint64_t file_size;
+        std::uint64_t read_offset; // Only Touched On The Disk Thread
+        std::uint64_t end_offset;  // Reading Stops Here (The End Of The File Or Of The Range)
+        std::atomic<bool> is_at_end{false};
+
+        bool HasDiskWork() const override;
+        void RunOnDisk() override;
+
+    public:
+        DiskReader(
+            std::shared_ptr<DiskWorker> worker,
+            int descriptor,
+            std::shared_ptr<BufferPool> buffers,
+            std::size_t queue_depth,
+            std::size_t block_size,
+            std::uint64_t file_size,
+            std::uint64_t start_offset = 0,
+            std::uint64_t end_offset = UINT64_MAX
+        );
+
+        // The Next Block, Waiting For The Disk If Needed (False At The End Of The File Or On An Error)
+        bool Read(std::unique_ptr<std::string> &block);
+
+        // Give A Block Read Back To The Pool
+        void Release(std::unique_ptr<std::string> block);
+
+        std::uint64_t FileSize() const;
+    };
+
+    //* Small Pool Of Disk Threads, So A Slow Disk Never Stalls The Threads Serving Sockets
+    // The Network Side Only Copies Into (Or Out Of) Pooled Blocks, Reading And Writing Overlap With It
+    //! Streams May Outlive The Executor: Their Work Then Runs On The Thread Handing It Over
+    class DiskExecutor
+    {
+    private:
+        std::vector<std::shared_ptr<DiskWorker>> workers;
+        std::atomic<std::size_t> next_worker{0};
+
+        std::shared_ptr<BufferPool> buffers;
+        std::shared_ptr<AlignedBufferPool> aligned_blocks;
+        std::size_t queue_depth;
+
+        std::mutex direct_io_mutex;
+        DirectIoOptions direct_io;
+
+        // Streams Are Spread Over The Threads Round-Robin
+        std::shared_ptr<DiskWorker> PickWorker();
+
+        // A Reader Owning descriptor (Closed Here If It Cannot Be Made)
+        std::shared_ptr<DiskReader> AdoptReader(int descriptor, std::size_t block_size, std::uint64_t offset, std::uint64_t length);
+
+    public:
+        explicit DiskExecutor(std::size_t thread_count = 2, std::size_t queue_depth = 8);
+        ~DiskExecutor();
+
+        DiskExecutor(const DiskExecutor &) = delete;
+        DiskExecutor &operator=(const DiskExecutor &) = delete;
+
+        // Set-Get When New Writers Switch To O_DIRECT
+        void SetDirectIoOptions(const DirectIoOptions &direct_io);
+        DirectIoOptions GetDirectIoOptions();
+
+        // Create (Or Truncate) path For Writing (nullptr If It Cannot Be Opened)
+        // With preallocate_bytes The Blocks Are Reserved Now (nullptr If The Disk Has No Room For Them)
+        // block_size Is Rounded Up To A Multiple Of AlignedBlock::ALIGNMENT
+        std::shared_ptr<DiskWriter> OpenWriter(const std::string &path, std::size_t block_size = 256 * 1024, std::uint64_t preallocate_bytes = 0);
+
+        // Open An Existing path To Write A Range Of It, From offset On (nullptr If It Cannot Be Opened)
+        // Several Range Writers Can Fill One File At Once, Each Through Its Own Descriptor
+        std::shared_ptr<DiskWriter> OpenRangeWriter(const std::string &path, std::uint64_t offset, std::size_t block_size = 256 * 1024);
+
+        // Open path For Reading, Block After Block (nullptr If It Cannot Be Opened)
+        // Only length Bytes From offset Are Read (Past The End Of The File Nothing Is)
+        std::shared_ptr<DiskReader> OpenReader(const std::string &path, std::size_t block_size = 256 * 1024, std::uint64_t offset = 0, std::uint64_t length = UINT64_MAX);
+
+        // Read A File Already Open As descriptor (Its Own Duplicate Is Taken, descriptor Stays The Caller's)
+        // So The Bytes Come From The Very File The Caller Looked At, Even If Its Path Was Replaced Since
+        std::shared_ptr<DiskReader> OpenReader(int descriptor, std::size_t block_size = 256 * 1024, std::uint64_t offset = 0, std::uint64_t length = UINT64_MAX);
+
+        std::size_t ThreadCount() const;
+    };
+}
+
+#endif // DISK_EXECUTOR_H
@@ -0,0 +1,121 @@
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include "./config/export_libs.h"
+#include "ClientConnection.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace SN_Server
+{
+    //* What Tells One Version Of A File From The Next (Any Change -> A Different Identity)
+    struct FileIdentity
+    {
+        std::uint64_t device = 0;
+        std::uint64_t inode = 0;
+        std::uint64_t size = 0;
+        std::int64_t modified_ns = 0;
+        std::int64_t changed_ns = 0; // ctime: Also Moves When A Write Keeps The Same mtime
+
+        bool operator==(const FileIdentity &other) const = default;
+    };
+
+    // Turns The Bytes Of A File Into What Is Cached For It (An Encoding Of Them, For Instance)
+    using FileTransform = std::function<std::string(std::string file_contents)>;
+
+    //* Contents Of Hot Files, Held In Memory Up To A Byte Budget
+    // Every Download Of A Cached File Shares One Immutable Buffer, Queued As Is (No Open, No Read, No Copy)
+    // An Entry Is Checked Against The File On Every Get: A Changed Or Replaced File Is Dropped And Read Again
+    // Eviction Is S3-FIFO: New Files Go Through A Small FIFO, Only Those Read Again There Reach The Main FIFO,
+    // So A Scan Of Many Files Read Once Never Pushes Out The Hot Ones (A Ghost FIFO Of Recently Dropped
+    // Names Lets A File That Comes Back Soon Go Straight To The Main FIFO)
+    // Concurrent Misses On One File Share A Single Read (And Transform): The Others Wait For Its Result
+    class FileCache
+    {
+    private:
+        struct Entry
+        {
+            FileIdentity identity;
+            SharedBuffer contents;
+
+            // Gets Since It Was Inserted Or Last Looked At By Eviction (Capped At 3)
+            std::uint8_t frequency = 0;
+            bool is_main = false;
+            std::list<std::string>::iterator position;
+        };
+
+        std::mutex cache_mutex;
+        std::unordered_map<std::string, Entry> entries;
+
+        // Oldest At The Front, Of Paths In entries
+        std::list<std::string> small_queue;
+        std::list<std::string> main_queue;
+        std::size_t small_bytes = 0;
+        std::size_t main_bytes = 0;
+
+        // Paths Dropped From The Small FIFO, With Their Sizes (Bounded Like The Main FIFO)
+        std::list<std::pair<std::string, std::size_t>> ghost_queue;
+        std::unordered_map<std::string, std::list<std::pair<std::string, std::size_t>>::iterator> ghost_index;
+        std::size_t ghost_bytes = 0;
+
+        std::size_t capacity_bytes;
+
+        // Applied To Every File Read (nullptr -> Its Bytes Are Cached As They Are)
+        FileTransform transform;
+
+        //* Files Being Read Right Now, So A Second Miss Waits Instead Of Reading Again
+        struct Loading
+        {
+            FileIdentity identity;
+            std::uint64_t load_id;
+            std::shared_future<SharedBuffer> contents;
+        };
+        std::unordered_map<std::string, Loading> loading;
+        std::uint64_t last_load_id = 0;
+
+        // Read (And Transform) The File Open As descriptor (nullptr If It Changed Meanwhile)
+        SharedBuffer Load(int descriptor, const FileIdentity &identity);
+
+        std::atomic<std::uint64_t> hit_count{0};
+        std::atomic<std::uint64_t> miss_count{0};
+
+        //* Under cache_mutex
+        void Insert(const std::string &path, const FileIdentity &identity, SharedBuffer contents);
+        void Erase(std::unordered_map<std::string, Entry>::iterator entry);
+        void Evict();
+        void EvictSmall();
+        void EvictMain();
+        void RememberGhost(const std::string &path, std::size_t size);
+
+    public:
+        // capacity_bytes 0 Turns The Cache Off
+        explicit FileCache(std::size_t capacity_bytes = 64 * 1024 * 1024, FileTransform transform = nullptr);
+
+        FileCache(const FileCache &) = delete;
+        FileCache &operator=(const FileCache &) = delete;
+
+        // The Contents Of path (Transformed), From Memory When They Are Still Current, Otherwise Read And Cached
+        // nullptr If It Is No Regular File, Cannot Be Read, Changes While It Is Read, Or Is Over MaxEntryBytes
+        // (The Caller Then Sends It From Disk)
+        SharedBuffer Get(const std::string &path);
+
+        // Set-Get The Byte Budget (A Smaller One Evicts At Once)
+        void SetCapacity(std::size_t capacity_bytes);
+        std::size_t Capacity();
+
+        // Largest File Cached: An Eighth Of The Budget, So One File Cannot Flush The Rest
+        std::size_t MaxEntryBytes();
+
+        std::size_t CachedBytes();
+        std::uint64_t HitCount() const;
+        std::uint64_t MissCount() const;
+    };
+}
+
+#endif // FILE_CACHE_H
@@ -0,0 +1,125 @@
+#ifndef JSON_MESSAGE_H
+#define JSON_MESSAGE_H
+
+#include "./config/export_libs.h"
+#include "simdjson.h"
+#include "ClientConnection.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace SN_Server
+{
+    //* Called With Every Record Of An NDJSON Stream
+    // The Record Points Into The Session's Buffers: Do Not Keep It After The Handler Returns
+    using JsonRecordHandler = std::function<void(simdjson::ondemand::document_reference &)>;
+
+    //* Called With The Client And Every Record Of An NDJSON Stream It Sent (Same Lifetime As Above)
+    using NdjsonRecordHandler = std::function<void(std::shared_ptr<ClientConnection>, simdjson::ondemand::document_reference &)>;
+
+    //* One Client's JSON Parsing State, Reused For Every Frame Of That Client
+    // The Parser Keeps Its Internal Buffers Between Frames, And The Frame Buffer
+    // Always Has SIMDJSON_PADDING Spare Bytes, So Parsing Never Allocates Or Copies
+    // Once The Session Has Seen Its Largest Frame
+    class JsonSession
+    {
+    private:
+        simdjson::ondemand::parser parser;
+
+        // The Frame Being Received (Capacity Is Kept Past size() + SIMDJSON_PADDING)
+        std::string frame;
+
+    public:
+        JsonSession() = default;
+
+        JsonSession(const JsonSession &) = delete;
+        JsonSession &operator=(const JsonSession &) = delete;
+
+        // Forget The Previous Frame (Its Documents Become Invalid)
+        void Clear();
+
+        // Add Received Bytes To The Frame
+        void Append(std::string_view chunk);
+
+        std::string_view Frame() const;
+
+        // Parse The Frame In Place, document Stays Valid Until The Next Clear()
+        simdjson::error_code Parse(simdjson::ondemand::document &document);
+
+        // Parse The First length Bytes As Newline-Delimited Records, Calling on_record For Each
+        simdjson::error_code ParseRecords(
+            std::size_t length,
+            const JsonRecordHandler &on_record,
+            std::size_t &record_count
+        );
+
+        // Drop The First length Bytes (Records Already Parsed), Keeping The Rest
+        void Consume(std::size_t length);
+    };
+
+    //* Writes JSON Straight Into An Output Buffer (Usually One From A BufferPool)
+    // No Temporary Strings: Strings Are Escaped 16 Bytes At A Time With SSE2 And
+    // Numbers Are Formatted In Place With std::to_chars (Shortest Round-Trip For Doubles)
+    // Commas And Colons Are Placed Automatically, Nesting Is Limited To 64 Levels
+    class JsonWriter
+    {
+    private:
+        std::string &output;
+
+        // Bit N: A Value Was Already Written At Nesting Level N (The Next One Needs A Comma)
+        std::uint64_t has_value = 0;
+        int depth = 0;
+
+        // A Key Was Just Written, The Next Value Belongs To It
+        bool after_key = false;
+
+        void BeforeValue();
+        void Open(char bracket);
+        void Close(char bracket);
+        void WriteEscaped(std::string_view text);
+
+    public:
+        explicit JsonWriter(std::string &output);
+
+        JsonWriter &BeginObject();
+        JsonWriter &EndObject();
+        JsonWriter &BeginArray();
+        JsonWriter &EndArray();
+
+        // The Key Of The Next Value In The Current Object
+        JsonWriter &Key(std::string_view key);
+
+        JsonWriter &String(std::string_view value);
+        JsonWriter &Int(std::int64_t value);
+        JsonWriter &UInt(std::uint64_t value);
+        JsonWriter &Double(double value);
+        JsonWriter &Bool(bool value);
+        JsonWriter &Null();
+
+        // Whether Every Object And Array Has Been Closed
+        bool IsComplete() const;
+    };
+
+    //* Called With The Client And The On-Demand Document Of One Message
+    // The Document Points Into The Session's Buffers: Do Not Keep It (Or Its
+    // string_views) After The Handler Returns
+    using JsonHandler = std::function<void(std::shared_ptr<ClientConnection>, simdjson::ondemand::document &)>;
+
+    //* Lets Handlers Be Looked Up By The string_view Of "type" Without Building A std::string
+    struct TransparentStringHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view text) const
+        {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+    using JsonHandlerMap = std::unordered_map<std::string, JsonHandler, TransparentStringHash, std::equal_to<>>;
+}
+
+#endif // JSON_MESSAGE_H
@@ -4,11 +4,31 @@
 #include <utility> // Include this line before Boost.Asio headers
 #include <boost/asio.hpp>
 #include "./config/export_libs.h"
+#include "AdmissionControl.h"
+#include "BufferPool.h"
+#include "Checksum.h"
+#include "ClientConnection.h"
+#include "CommandTable.h"
+#include "ContentStore.h"
+#include "DiskExecutor.h"
+#include "FileCache.h"
+#include "JsonMessage.h"
+#include "SharedMemoryRing.h"
+#include "StripedUpload.h"
+#include "TimingWheel.h"
+#include "Tracing.h"
+#include "TransferJournal.h"
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <stdint.h>
 #include <thread>
 #include <atomic>
 #include <set>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 namespace SN_Server
 {
@@ -18,12 +38,53 @@ namespace SN_Server
         ConnectionClose = 0b10
     };
 
+    // Handler Of One Text Command: Gets What Follows "<COMMAND> " In The Request
+    // Runs On The Client's Thread, May Send Replies And Receive More Frames Like The Built-In Commands
+    using CommandHandler = std::function<ClientConnectionStatus(std::shared_ptr<ClientConnection>, std::string_view arguments)>;
+
+    //* Per-Client Timeouts, Checked On The Server's Timing Wheel (0 Turns One Off)
+    struct SessionTimeouts
+    {
+        // Waiting For The First Bytes Of A Request (Or For The TLS Handshake)
+        std::chrono::milliseconds idle_timeout = std::chrono::minutes(5);
+
+        // Waiting For More Bytes Of A Request Already Started
+        std::chrono::milliseconds read_timeout = std::chrono::seconds(30);
+
+        // The Write At The Front Of The Send Queue Making No Progress
+        std::chrono::milliseconds write_timeout = std::chrono::seconds(30);
+
+        // Send The Heartbeat Frame To An Idle Client Nothing Was Written To For This Long
+        std::chrono::milliseconds heartbeat_interval = std::chrono::milliseconds(0);
+    };
+
+    //* Options Of The Listening Socket And Of Every Accepted Socket
+    struct SocketOptions
+    {
+        // TCP_NODELAY: Send Small Frames At Once Instead Of Coalescing Them (Latency Over Throughput)
+        bool no_delay = false;
+
+        // SO_KEEPALIVE: Let The Kernel Find Peers That Vanished
+        bool keep_alive = false;
+
+        // SO_RCVBUF/SO_SNDBUF In Bytes (0 -> Kernel Default, Which Autotunes)
+        int receive_buffer_size = 0;
+        int send_buffer_size = 0;
+
+        // Listening Socket
+        bool reuse_address = true;
+        int listen_backlog = boost::asio::socket_base::max_listen_connections;
+    };
+
     class Server
     {
     private:
         //* Create io_context for Server
         boost::asio::io_context io_context;
 
+        // Serializes The Server's Own Handlers (Accept, Signals, Drain) When Several Threads Run io_context
+        boost::asio::strand<boost::asio::io_context::executor_type> server_strand;
+
         // Server IP Address Object
         boost::asio::ip::address_v4 server_ipv4_address;
 
@@ -33,15 +94,68 @@ namespace SN_Server
         // To Concurrently shutdown
         std::atomic<bool> is_running;
 
+        // Draining: No New Clients Or Requests, Those In Flight May Finish Until The Deadline
+        std::atomic<bool> is_draining{false};
+        bool drain_finished = false; // Only Touched On server_strand
+        std::shared_ptr<boost::asio::steady_timer> drain_timer;
+
+        // Frame Sent To Clients Let Go By A Drain
+        std::string going_away_text = "GOING AWAY";
+
+        // Frame Sent To Idle Clients Every heartbeat_interval
+        std::string heartbeat_text = "HEARTBEAT";
+
+        // Timeouts Of Every Client, All On One Timing Wheel Instead Of A Timer Per Socket
+        SessionTimeouts session_timeouts;
+        std::shared_ptr<TimingWheel> timing_wheel;
+
+        // Options Applied To The Acceptor And To Every Accepted Socket
+        SocketOptions socket_options;
+
+        // Signals Delivered As Ordinary Handlers On The io_context
+        std::shared_ptr<boost::asio::signal_set> signals;
+
+        // TLS Settings, Certificate And Session Cache (nullptr -> Plain TCP)
+        std::shared_ptr<boost::asio::ssl::context> tls_context;
+
         // Acceptor Object
         // For Listenning to new Connections
         std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor_server;
 
+        // Unix Domain Socket For Clients On The Same Host (Empty Path -> Not Listening)
+        std::string local_socket_path;
+        std::shared_ptr<boost::asio::local::stream_protocol::acceptor> local_acceptor;
+
         // Listenning Thread To Accpet New Client Connections
         std::shared_ptr<std::thread> listening_thread;
 
+        // Threads Running io_context Besides The Listening Thread (io_thread_count - 1 Of Them)
+        std::size_t io_thread_count = 1;
+        std::vector<std::thread> io_threads;
+
+        // Keeps io_context.run() Alive Between Client Operations
+        std::shared_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> io_work_guard;
+
         // To Store All The Client Connections
-        std::set<std::shared_ptr<boost::asio::ip::tcp::socket>> clients_connections;
+        std::mutex clients_mutex;
+        std::set<std::shared_ptr<ClientConnection>> clients_connections;
+
+        // Detached Client Threads Still Running (Guarded By clients_mutex), Stop Waits For None To Be Left
+        // They Use The io_context And The Strands Through Their Connections Until They Return
+        std::size_t client_thread_count = 0;
+        std::condition_variable client_threads_done;
+
+        // main() Stops The Server And The Destructor Stops It Again: Only The First Stop Runs
+        std::once_flag stop_flag;
+
+        // Bytes Read Past The end_signal Of A Frame, Kept For The Next Frame Of That Client
+        std::mutex pending_input_mutex;
+        std::map<ClientConnection *, std::string> pending_input;
+
+        // Local Clients That Moved Their Messages Onto Shared Memory Rings
+        SharedMemoryOptions shared_memory_options;
+        std::mutex shared_memory_mutex;
+        std::map<ClientConnection *, std::shared_ptr<SharedMemoryChannel>> shared_memory_channels;
 
         // Chunk Size of Data to Send/Get
         std::size_t CHUNK_SIZE = 255;
@@ -49,16 +163,205 @@ namespace SN_Server
         // End Signal of the Text
         std::string end_signal = "|end";
 
+        // Integrity Trailer Sent/Expected After Every File Transfer
+        TransferIntegrity transfer_integrity = TransferIntegrity::IntegrityNone;
+
+        // Content-Addressed Store For Deduplicated Uploads
+        std::shared_ptr<ContentStore> content_store;
+
+        // Journal Of Finished File Transfers (nullptr -> Not Journaled)
+        std::shared_ptr<TransferJournal> transfer_journal;
+
+        // Watermarks And Overflow Policy Of Every New Client's Send Queue
+        SendQueueLimits send_queue_limits;
+
+        // Bytes Queued Across Every Client's Send Queue
+        std::shared_ptr<SendMemoryAccount> send_memory_account;
+
+        // Limits A New Connection Must Pass Before It Gets A Session And A Thread
+        AdmissionControl admission_control;
+
+        // Spans Of Sampled Requests (Off Until EnableTracing)
+        std::shared_ptr<Tracer> tracer;
+
+        // Recycled Buffers For Outgoing Frames (Text And JSON)
+        std::shared_ptr<BufferPool> output_buffers;
+
+        // Threads Doing The File Reads And Writes Of Transfers, Beside The Ones Serving Sockets
+        std::shared_ptr<DiskExecutor> disk_executor;
+
+        // Contents Of Hot Files, Shared By Every Download Of Them
+        std::shared_ptr<FileCache> file_cache;
+
+        // Same For The Base 64 Encoding Of Hot Files (Encoded Once, Not Per Download)
+        std::shared_ptr<FileCache> encoded_file_cache;
+
+        // JSON Request Mode: Every Frame Is A JSON Object Dispatched By Its "type"
+        bool json_mode = false;
+        JsonHandlerMap json_handlers;
+
+        // Perfect Hash Of The Registered Types, Built By Start (json_type_handlers[i] Handles Name i)
+        CommandTable json_type_table;
+        std::vector<JsonHandler> json_type_handlers;
+
+        // Gets Every Record Of The NDJSON Streams Sent After "NDJSON" (Empty -> Records Are Only Counted)
+        NdjsonRecordHandler ndjson_record_handler;
+
+        // Commands Registered By The Application, Built Into command_table By Start
+        std::vector<std::string> command_names;
+        std::vector<CommandHandler> command_handlers;
+        CommandTable command_table;
+
+        // Where The Files Named By UPLOAD/DOWNLOAD Requests Live
+        std::string files_directory = "files";
+
+        // Largest Upload Announced With Its Size That Is Accepted (0 -> Only Free Space Limits It)
+        std::uint64_t max_upload_bytes = 0;
+
+        // Striped Uploads Waiting For More Blocks
+        std::shared_ptr<StripedUploads> striped_uploads;
+
+        // Bytes Of An NDJSON Stream Gathered Before They Are Parsed As One Batch
+        std::size_t ndjson_batch_size = 1 << 20;
+
         //! PRIVATE METHODS SECTIONS
         //!========================================================
         //* Methods To Accept new Connection
         void AcceptConnections();
 
+        //* Text Followed By The end_signal, As One Shareable Buffer
+        SharedBuffer MakeFrame(const std::string_view &text) const;
+
+        //* Issue One Asynchronous Accept
+        void StartAccept();
+
         //* Method To Handle Accept
-        void HandleAccept(const boost::system::error_code &error, std::shared_ptr<boost::asio::ip::tcp::socket> client_socket);
+        void HandleAccept(const boost::system::error_code &error, boost::asio::ip::tcp::socket socket);
+
+        //* Same For The Unix Domain Socket
+        void StartLocalAccept();
+        void HandleLocalAccept(const boost::system::error_code &error, LocalSocket socket);
+
+        //* Register An Admitted Client And Give It Its Thread (Whatever The Transport)
+        void ServeClient(std::shared_ptr<ClientConnection> client_socket, boost::asio::ip::address peer_address);
+
+        //* Apply socket_options To An Accepted Socket
+        void ApplySocketOptions(boost::asio::ip::tcp::socket &socket) const;
+
+        //* Turn Away A Connection Over An Admission Limit, Without A Session Or A Thread
+        template <typename Socket>
+        void RejectConnection(Socket socket, AdmissionDecision decision);
 
         //* Method to Handle User Sending
-        void HandleClient(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket);
+        void HandleClient(std::shared_ptr<ClientConnection> client_socket);
+
+        //* Get One Text Request "<COMMAND> <arguments>" And Run Its Handler (Built-In Or Registered)
+        ClientConnectionStatus RouteRequest(std::shared_ptr<ClientConnection> client_socket);
+
+        //* Turn A File Name Sent By A Client Into A Path Under files_directory (False If It Tries To Leave It)
+        bool ResolveClientPath(std::string_view file_name, std::string &path) const;
+
+        //* Reserve A New File Name Under files_directory For An Upload That Gave None
+        bool GenerateClientPath(std::string &file_name, std::string &path) const;
+
+        //* STRIPE Requests: Open, Receive Blocks Of, Query Or Abort A Striped Upload
+        ClientConnectionStatus HandleStripeRequest(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments);
+        ClientConnectionStatus OpenStripedUpload(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments);
+        ClientConnectionStatus GetStripe(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments);
+
+        //* Drop A Striped Upload Once It Sat Idle Too Long (On The io_context, Driven By timing_wheel)
+        void WatchStripedUpload(const std::string &transfer_id);
+
+        //* Reply To STATS With The Server's Counters As JSON
+        void SendStats(std::shared_ptr<ClientConnection> client_socket);
+
+        //* After Every Request: Return Whether To Serve The Next One (False Once Draining)
+        bool FinishRequest(std::shared_ptr<ClientConnection> client_socket);
+
+        //* Remove A Client From The Server (And Finish A Drain When It Was The Last One)
+        void ForgetClient(std::shared_ptr<ClientConnection> client_socket);
+
+        //* Timeout Checks Of One Client (On The io_context, Driven By timing_wheel)
+        void WatchClient(std::weak_ptr<ClientConnection> client_socket, std::chrono::milliseconds delay);
+        void CheckClientTimeouts(std::weak_ptr<ClientConnection> client_socket);
+
+        //* Drain Steps (On The io_context)
+        void SayGoingAway(std::shared_ptr<ClientConnection> client_socket);
+        void FinishDrain();
+
+        //* What Stop() Runs Once
+        void ShutDown();
+
+        //* Wait For The Next Signal Of signals
+        void WaitForSignal(std::function<void(int)> handler);
+
+        //* Read One Frame Until The end_signal, Handing Every Payload Piece To on_chunk
+        // The end_signal Is Found Even When It Is Split Across Two Reads
+        // Bytes Past It Stay In pending_input For The Next Frame
+        ClientConnectionStatus ReceiveUntilEndSignal(
+            std::shared_ptr<ClientConnection> client_socket,
+            const std::function<void(std::string_view)> &on_chunk
+        );
+
+        //* Shared Memory Transport Of A Local Client (nullptr -> It Uses The Socket)
+        std::shared_ptr<SharedMemoryChannel> FindSharedMemory(ClientConnection *client_socket);
+
+        //* Answer "SHM <ring bytes>": Create The Rings And Pass Them To The Client
+        void SetUpSharedMemory(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments);
+
+        //* One Message Into The Client's Outbound Ring, Waiting For Room While The Client Is There
+        bool SendToSharedMemory(
+            std::shared_ptr<ClientConnection> client_socket,
+            std::shared_ptr<SharedMemoryChannel> channel,
+            std::string_view message
+        );
+
+        //* One Message From The Client's Inbound Ring, Waiting Until It Comes Or The Client Goes
+        ClientConnectionStatus ReceiveFromSharedMemory(
+            std::shared_ptr<ClientConnection> client_socket,
+            std::shared_ptr<SharedMemoryChannel> channel,
+            const std::function<void(std::string_view)> &on_chunk
+        );
+
+        //* Send A File (Or length Bytes Of It From offset) Followed By The end_signal (And The Integrity Trailer)
+        // Return Whether Every Byte Was Sent, total_sent Is Set To The Bytes Sent
+        // With encode_base64 The File Is Encoded Block By Block As It Is Read (No Temp File)
+        bool SendFileFrame(
+            std::shared_ptr<ClientConnection> client_socket,
+            const std::string &file_to_send,
+            std::uint64_t &total_sent,
+            bool encode_base64 = false,
+            std::uint64_t offset = 0,
+            std::uint64_t length = UINT64_MAX
+        );
+
+        //* Send length Bytes From offset Of An Open File, Nothing Else (True Only If All Of Them Went Out)
+        bool SendFileBytes(
+            std::shared_ptr<ClientConnection> client_socket,
+            int file_descriptor,
+            TransferChecksum &checksum,
+            std::uint64_t &total_sent,
+            bool encode_base64,
+            std::uint64_t offset,
+            std::uint64_t length
+        );
+
+        //* Queue One Transfer For The Journal (Does Nothing If It Is Disabled)
+        void JournalTransfer(
+            std::shared_ptr<ClientConnection> client_socket,
+            const char *operation,
+            const std::string &file,
+            std::uint64_t bytes,
+            const char *status
+        );
+
+        //* Get The Client's Integrity Trailer, Compare It And Reply "OK" Or "MISMATCH"
+        // Return Whether The Transfer Is Intact (Always True If No Trailer Is Expected)
+        bool VerifyIntegrityTrailer(
+            std::shared_ptr<ClientConnection> client_socket,
+            TransferChecksum &checksum,
+            ClientConnectionStatus &client_connection_status
+        );
     public:
         Server(std::string_view server_ipv4_address = "127.0.0.1", std::uint16_t port = 5000);
         ~Server();
@@ -69,6 +372,18 @@ namespace SN_Server
 
         bool IsRunning();
 
+        // Stop Accepting, Let In-Flight Requests Finish, Then Close Everything Left At The Deadline
+        // Returns At Once: IsRunning() Turns False When The Drain Is Over (Then Call Stop())
+        void BeginDrain(std::chrono::milliseconds deadline = std::chrono::seconds(30));
+        bool IsDraining() const;
+
+        // Run handler On The io_context When One Of The Signals Arrives (Not In The Signal Context)
+        void OnSignals(const std::vector<int> &signal_numbers, std::function<void(int)> handler);
+
+        // Serve Every New Connection Over TLS (Call Before Start)
+        bool EnableTls(const std::string &certificate_file = "key/server.crt", const std::string &private_key_file = "key/server.key");
+        bool IsTlsEnabled() const;
+
         // Found If there is an end_signal in the Text
         bool HasEndSignal(const std::string_view& text, std::size_t* index_to_del);
         std::string RemoveEndSignal(std::string& text, std::size_t end_signal_index);
@@ -81,29 +396,167 @@ namespace SN_Server
         void SetEndSignal(const std::string_view& end_signal);
         std::string_view GetEndSignal() const;
 
+        // Set-Get The Integrity Trailer Of File Transfers
+        void SetTransferIntegrity(TransferIntegrity transfer_integrity);
+        TransferIntegrity GetTransferIntegrity() const;
+
+        // Set-Get The Directory Of The Content-Addressed Store
+        void SetContentStoreDirectory(const std::string_view& directory);
+        std::string_view GetContentStoreDirectory() const;
+
+        // Set-Get The Send Queue Watermarks And Overflow Policy Of New Clients
+        void SetSendQueueLimits(const SendQueueLimits &send_queue_limits);
+        SendQueueLimits GetSendQueueLimits() const;
+
+        // Set-Get The Limit Of Bytes Queued Across All Clients
+        void SetSendMemoryLimit(std::size_t limit_bytes);
+        std::size_t GetSendMemoryLimit() const;
+        std::size_t GetQueuedSendBytes() const;
+
+        // Set-Get The Path Of The Unix Domain Socket Also Listened On (Empty -> Off, Call Before Start)
+        void SetLocalSocketPath(const std::string &local_socket_path);
+        std::string GetLocalSocketPath() const;
+
+        // Set-Get Whether Local Clients May Move Their Messages Onto Shared Memory Rings
+        void SetSharedMemoryOptions(const SharedMemoryOptions &shared_memory_options);
+        SharedMemoryOptions GetSharedMemoryOptions() const;
+
+        // Set-Get How Many Threads Run The io_context (Call Before Start)
+        void SetIoThreads(std::size_t io_thread_count);
+        std::size_t GetIoThreads() const;
+
+        // Set-Get How Many Threads Read And Write Transferred Files (Call Before Start)
+        void SetDiskThreads(std::size_t disk_thread_count);
+        std::size_t GetDiskThreads() const;
+
+        // Set-Get The Size From Which Uploads Are Written With O_DIRECT (Bypassing The Page Cache)
+        void SetDirectIoOptions(const DirectIoOptions &direct_io);
+        DirectIoOptions GetDirectIoOptions() const;
+
+        // Set-Get The Socket Options (Call Before Start)
+        void SetSocketOptions(const SocketOptions &socket_options);
+        SocketOptions GetSocketOptions() const;
+
+        // Set-Get The Idle/Read/Write Timeouts And The Heartbeat Of Clients (Call Before Start)
+        void SetSessionTimeouts(const SessionTimeouts &session_timeouts);
+        SessionTimeouts GetSessionTimeouts() const;
+
+        // Set-Get The Limits On Connections, Accept Rate And Buffered Memory
+        void SetAdmissionLimits(const AdmissionLimits &admission_limits);
+        AdmissionLimits GetAdmissionLimits() const;
+        const AdmissionControl &GetAdmissionControl() const;
+
+        // Trace One Request Out Of sample_every (0 Turns Tracing Off)
+        void EnableTracing(std::uint32_t sample_every = 1);
+        std::shared_ptr<Tracer> GetTracer() const;
+
+        // Write The Spans Recorded So Far As A Chrome/Perfetto Trace File
+        bool WriteTrace(const std::string &trace_file) const;
+
+        // Record Every File Transfer In An SQLite Journal (Call Before Start)
+        bool EnableTransferJournal(const std::string &database_file = "transfers.db");
+        std::shared_ptr<TransferJournal> GetTransferJournal() const;
+
+        // Set-Get Whether Clients Talk In JSON Messages (See GetJsonMessage)
+        void SetJsonMode(bool json_mode);
+        bool IsJsonMode() const;
+
+        // Register The Handler Of One Message "type" (Call Before Start)
+        void OnJsonMessage(const std::string &type, JsonHandler handler);
+
+        // Register The Handler Of NDJSON Stream Records (Call Before Start)
+        void OnNdjsonRecord(NdjsonRecordHandler handler);
+
+        // Register The Handler Of One Text Command (Call Before Start)
+        // Returns False For The Built-In Commands: ECHO, UPLOAD, STORE, DOWNLOAD, STATS, STRIPE, SHM And NDJSON
+        bool OnCommand(const std::string &command, CommandHandler handler);
+
+        // Set-Get The Directory Of The Files Clients Upload And Download By Name
+        void SetFilesDirectory(const std::string_view& directory);
+        std::string_view GetFilesDirectory() const;
+
+        // Set-Get The Quota Of One Upload Announced With Its Size (0 -> None)
+        void SetMaxUploadBytes(std::uint64_t max_upload_bytes);
+        std::uint64_t GetMaxUploadBytes() const;
+
+        // Set-Get The Memory Kept For Hot Files Sent Whole (0 -> Always Read From Disk)
+        void SetFileCacheBytes(std::size_t file_cache_bytes);
+        std::size_t GetFileCacheBytes() const;
+
+        // Set-Get The Memory Kept For The Base 64 Encodings Of Hot Files (0 -> Always Encode)
+        void SetEncodedCacheBytes(std::size_t encoded_cache_bytes);
+        std::size_t GetEncodedCacheBytes() const;
+
+        // Set-Get The Batch Size Of NDJSON Streams (See GetNdjsonStream)
+        void SetNdjsonBatchSize(std::size_t ndjson_batch_size);
+        std::size_t GetNdjsonBatchSize() const;
+
         //========================================================================================================================
         //! IMPORTANT: Send End Signal
-        void SendEndSignal(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket);
+        void SendEndSignal(std::shared_ptr<ClientConnection> client_socket);
         
         // Simple I/O Send Protocol
-        void SendText(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string_view& text);
+        void SendText(std::shared_ptr<ClientConnection> client_socket, const std::string_view& text);
+
+        // Queue The Same Text To Every Connected Client (Waits Only On A Full Queue Under OverflowBlock)
+        // Returns How Many Clients It Was Queued To
+        std::size_t Broadcast(const std::string_view& text);
+        std::size_t Broadcast(SharedBuffer frame);
+
+        // Write A JSON Reply Straight Into A Pooled Frame, Then Send It
+        SharedBuffer MakeJsonFrame(const std::function<void(JsonWriter &)> &write_json);
+        void SendJson(std::shared_ptr<ClientConnection> client_socket, const std::function<void(JsonWriter &)> &write_json);
 
         // For Sending Text-Based Formats Files
-        void SendTextBasedFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string& file_to_send);
+        void SendTextBasedFile(std::shared_ptr<ClientConnection> client_socket, const std::string& file_to_send);
 
         // For Sending Binary Formats Files
-        void SendBinaryFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string& file_to_send);
+        void SendBinaryFile(std::shared_ptr<ClientConnection> client_socket, const std::string& file_to_send);
+
+        // For Sending Part Of A File: To Fetch It Over Several Connections, Resume It, Or Follow Its Tail
+        // INFO: "DOWNLOAD <file> range=<first>-<last>" (Or "<first>-", Or "-<bytes>") Is Replied "RANGE <offset> <length> <file size>"
+        // INFO: Then Exactly <length> Raw Bytes Follow (Not Base 64), Then The end_signal
+        // INFO: If The File Shrinks And Fewer Bytes Can Be Sent, The Connection Is Closed Instead
+        bool SendFileRange(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_send, std::string_view range);
 
         //========================================================================================================================
         // Simple I/O Get Protocol
+        // INFO: In Text Mode Every Request Is "<COMMAND> <arguments>|end":
+        //       "ECHO <text>", "UPLOAD <file>" (Then The Base 64 Frame), "STORE <file>" (Then As GetBinaryFileToStore),
+        //       "DOWNLOAD <file>", "STATS", "STRIPE ..." (See HandleStripeRequest), "SHM <ring bytes>",
+        //       "NDJSON" (Then The Stream As One Frame, See GetNdjsonStream), Or A Command Registered With OnCommand
+        // INFO: "UPLOAD" Or "STORE" Without A File Name Is Answered "NAME <file>" With A New Name First
+        // INFO: "UPLOAD <file> size=<bytes>" Announces The Decoded Size (See GetSizedBinaryFile)
+        // INFO: Uploads Land In A Hidden File Of Their Own And Are Renamed Over <file> Once Complete
+        // INFO: "STRIPE OPEN <file> size=<bytes>" Starts An Upload Several Connections Send Numbered Blocks Of At Once
         // INFO: To End the Sending remember to add |end
-        ClientConnectionStatus GetText(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, std::string &received_text);
+        // INFO: A Local Client May Send "SHM <ring bytes>" First: It Gets "SHM <capacity>" With Two Rings Attached
+        //       (memfd + 2 eventfds Each, Client -> Server Then Server -> Client), Then Every Message Goes Through Them
+        ClientConnectionStatus GetText(std::shared_ptr<ClientConnection> client_socket, std::string &received_text);
 
         // For Receiving Text-Based Formats Files
-        ClientConnectionStatus GetTextBasedFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string &file_to_store);
+        ClientConnectionStatus GetTextBasedFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store);
 
         // For Receiving Binary Formats Files
-        ClientConnectionStatus GetBinaryFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string &file_to_store);
+        ClientConnectionStatus GetBinaryFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store);
+
+        // For Receiving Binary Formats Files Whose Size Is Announced First
+        // INFO: Over The Quota Or The Free Space The Client Is Told "ERROR ..." At Once, Otherwise "SEND"
+        // INFO: Then The Base 64 Frame Is Decoded Into The Preallocated File, Replied With "UPLOADED <bytes>" Or "ERROR ..."
+        ClientConnectionStatus GetSizedBinaryFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store, std::uint64_t file_size);
+
+        // For Receiving Binary Formats Files Through The Content-Addressed Store
+        // INFO: The Client Announces "sha256:<hex digest>" First, Then Sends The File Only If Told "SEND"
+        // INFO: A Local Client May Announce "sha256:<hex digest> fd" And Pass The Open File Instead (SCM_RIGHTS)
+        ClientConnectionStatus GetBinaryFileToStore(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store);
+
+        // For Receiving One JSON Message And Running The Handler Of Its "type"
+        // INFO: The Frame Is {"type": "...", ...}, Unknown Types And Bad JSON Are Answered With "ERROR ..."
+        ClientConnectionStatus GetJsonMessage(std::shared_ptr<ClientConnection> client_socket, JsonSession &json_session);
+
+        // For Receiving A Stream Of Newline-Delimited JSON Records As One Frame
+        // INFO: Records Are Parsed Batch By Batch While The Rest Still Arrives, Replied With "OK <records>" Or "ERROR ..."
+        ClientConnectionStatus GetNdjsonStream(std::shared_ptr<ClientConnection> client_socket, JsonSession &json_session, const JsonRecordHandler &on_record);
     };
 }
 
@@ -0,0 +1,85 @@
+#ifndef SERVER_CONFIG_H
+#define SERVER_CONFIG_H
+
+#include "./config/export_libs.h"
+#include "Server.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace SN_Server
+{
+    //* Everything A Deployment Can Tune Without Recompiling
+    // Filled From Defaults, Then A Tuning Profile, Then A JSON File, Then Command Line Overrides
+    struct ServerConfig
+    {
+        //* Listening
+        std::string bind_address = "0.0.0.0";
+        std::uint16_t port = 6969;
+
+        // Unix Domain Socket For Same-Host Clients (Empty -> Off)
+        std::string local_socket;
+
+        //* Threads Running The io_context
+        std::size_t io_threads = 1;
+
+        //* Threads Reading And Writing The Files Of Transfers
+        std::size_t disk_threads = 2;
+        DirectIoOptions direct_io;
+
+        //* Framing: "text" (Frames Ended By end_signal) Or "json" (JSON Messages Dispatched By "type")
+        std::string framing = "text";
+        std::string end_signal = "|end";
+        std::size_t chunk_size = 255;
+        std::size_t ndjson_batch_size = 1 << 20;
+
+        //* Storage And Transfers
+        std::string content_store = "store";
+        std::string files_directory = "files"; // UPLOAD/DOWNLOAD Names Are Relative To It
+        std::uint64_t max_upload_bytes = 0;    // Quota Of An Upload Announced With Its Size (0 -> None)
+        std::size_t file_cache_bytes = 64 * 1024 * 1024; // Hot Files Sent From Memory (0 -> Off)
+        std::size_t encoded_cache_bytes = 64 * 1024 * 1024; // Their Base 64 Encodings (0 -> Off)
+        TransferIntegrity integrity = TransferIntegrity::IntegrityNone;
+        std::string transfer_journal; // Empty -> Off
+
+        //* TLS (Both Files Set -> On)
+        std::string tls_certificate;
+        std::string tls_private_key;
+
+        //* Limits
+        SendQueueLimits send_queue;
+        std::size_t send_memory_limit = 256 * 1024 * 1024;
+        AdmissionLimits admission;
+        SessionTimeouts timeouts;
+        std::chrono::milliseconds drain_deadline = std::chrono::seconds(30);
+
+        //* Sockets
+        SocketOptions socket;
+
+        //* Shared Memory Rings For Local Clients
+        SharedMemoryOptions shared_memory;
+
+        //* Tracing (0 -> Off), Written To trace_file On Shutdown When Set
+        std::uint32_t trace_sample_every = 0;
+        std::string trace_file;
+    };
+
+    //* Tuning Profiles: "default", "latency" Or "throughput"
+    // A Profile Only Sets Starting Values, Keys Given After It Still Win
+    bool ApplyTuningProfile(std::string_view profile, ServerConfig &config, std::string &error);
+
+    //* Set One Key (Dotted, e.g. "admission.max_connections") From Its Text Value
+    bool SetServerConfigValue(std::string_view key, std::string_view value, ServerConfig &config, std::string &error);
+
+    //* Read A JSON Config File (Nested Objects Map To Dotted Keys, "profile" Is Applied First)
+    bool LoadServerConfigFile(const std::string &config_file, ServerConfig &config, std::string &error);
+
+    //* Defaults, Then --profile/--config, Then Every Other --key=value (Or --key value) Of The Command Line
+    bool LoadServerConfig(int argc, char const *argv[], ServerConfig &config, std::string &error);
+
+    //* Hand The Configuration To A Server Built On config.bind_address/config.port (Before Start)
+    bool ApplyServerConfig(const ServerConfig &config, Server &server);
+}
+
+#endif // SERVER_CONFIG_H
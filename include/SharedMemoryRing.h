@@ -0,0 +1,164 @@
+#ifndef SHARED_MEMORY_RING_H
+#define SHARED_MEMORY_RING_H
+
+#include "./config/export_libs.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SN_Server
+{
+    // What A Ring Read Or Write Did
+    enum RingStatus
+    {
+        RingOk = 0b1,
+        // Nothing To Read (Yet)
+        RingEmpty = 0b10,
+        // No Room To Write (Yet)
+        RingFull = 0b100,
+        // The Other Side Closed The Ring (Or Hung Up Its Connection)
+        RingClosed = 0b1000,
+        // The Message Could Never Fit (Over MaxMessageSize)
+        RingTooLarge = 0b10000
+    };
+
+    //* Shared Memory Transport Of A Local Client (Off Unless enabled)
+    struct SharedMemoryOptions
+    {
+        bool enabled = false;
+
+        // Largest Ring A Client May Ask For, Each Direction Has Its Own
+        std::size_t max_ring_bytes = 64 * 1024 * 1024;
+
+        // Times A Waiting Side Checks The Ring Before Sleeping On Its Doorbell (0 -> Sleep At Once)
+        // Spinning Saves The Wake-Up Latency At The Cost Of A Busy Core
+        std::size_t busy_poll_spins = 0;
+    };
+
+    //* Single-Producer Single-Consumer Ring Of Messages In A memfd, Shared By Two Processes
+    // Messages Are Length-Prefixed Records Written In Place, No Syscall Per Message
+    // Each Side Rings The Other's eventfd Doorbell Only When It Announced It Is Going To Sleep
+    // The memfd Is Sealed Against Resizing, And Everything The Other Side Writes Is Bounded Before Use
+    class SharedMemoryRing
+    {
+    private:
+        //* Lives At The Start Of The Shared Memory, The Records Follow It
+        struct Header
+        {
+            std::uint64_t magic;
+            std::uint64_t capacity;
+
+            // Positions Only Grow, Each Written By One Side (Own Cache Line, No False Sharing)
+            alignas(64) std::atomic<std::uint64_t> write_position;
+            alignas(64) std::atomic<std::uint64_t> read_position;
+
+            alignas(64) std::atomic<std::uint32_t> is_reader_sleeping;
+            std::atomic<std::uint32_t> is_writer_sleeping;
+            std::atomic<std::uint32_t> is_closed;
+        };
+
+        int memory_descriptor = -1;
+
+        // Doorbells: Rung By The Writer When Data Arrives, By The Reader When Room Is Made
+        int data_ready_descriptor = -1;
+        int space_ready_descriptor = -1;
+
+        Header *header = nullptr;
+        char *records = nullptr;
+        std::size_t mapped_bytes = 0;
+
+        //* Never Read Back From The Shared Header: The Other Process Can Write Anything There
+        // Capacity As Validated Against The (Sealed) Size Of The Mapping
+        std::uint64_t capacity = 0;
+
+        // This Side's Own Positions, Published To The Header But Never Taken From It Again
+        std::uint64_t own_write_position = 0;
+        std::uint64_t own_read_position = 0;
+
+        std::size_t busy_poll_spins = 0;
+
+        bool Map(std::size_t mapped_bytes);
+
+        // Sleep On doorbell Until is_ready, The Ring Closes, hangup_descriptor Hangs Up Or timeout Passes
+        RingStatus WaitFor(
+            int doorbell,
+            std::atomic<std::uint32_t> &is_sleeping,
+            bool (SharedMemoryRing::*is_ready)() const,
+            std::chrono::milliseconds timeout,
+            int hangup_descriptor
+        );
+        bool HasMessage() const;
+        bool HasRoom() const;
+
+    public:
+        // New Ring Of capacity Bytes (Rounded Up To A Power Of Two, At Least 4 KiB)
+        explicit SharedMemoryRing(std::size_t capacity);
+
+        // Map A Ring The Other Process Created (Takes Ownership Of The Descriptors)
+        SharedMemoryRing(int memory_descriptor, int data_ready_descriptor, int space_ready_descriptor);
+
+        ~SharedMemoryRing();
+
+        SharedMemoryRing(const SharedMemoryRing &) = delete;
+        SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+
+        bool IsOpen() const;
+        std::size_t Capacity() const;
+        std::size_t MaxMessageSize() const;
+
+        void SetBusyPollSpins(std::size_t busy_poll_spins);
+
+        //* Producer Side
+        RingStatus TryWrite(std::string_view message);
+
+        // Wait Up To timeout For Room (RingFull If There Still Is None)
+        RingStatus Write(std::string_view message, std::chrono::milliseconds timeout, int hangup_descriptor = -1);
+
+        //* Consumer Side
+        RingStatus TryRead(std::string &message);
+
+        // Wait Up To timeout For A Message (RingEmpty If There Still Is None)
+        RingStatus Read(std::string &message, std::chrono::milliseconds timeout, int hangup_descriptor = -1);
+
+        // Mark The Ring Closed For Both Sides And Wake Them Up
+        void Close();
+        bool IsClosed() const;
+
+        // Memory, Data Doorbell, Space Doorbell: What The Other Process Needs To Map It
+        std::array<int, 3> Descriptors() const;
+    };
+
+    //* Both Rings Of One Client: inbound (Client -> Server) And outbound (Server -> Client)
+    // Many Server Threads May Send, So Writes Of outbound Are Serialized Here (The Client Stays A Single Reader)
+    class SharedMemoryChannel
+    {
+    private:
+        SharedMemoryRing inbound;
+        SharedMemoryRing outbound;
+        std::mutex outbound_mutex;
+
+    public:
+        SharedMemoryChannel(std::size_t ring_bytes, std::size_t busy_poll_spins);
+
+        SharedMemoryChannel(const SharedMemoryChannel &) = delete;
+        SharedMemoryChannel &operator=(const SharedMemoryChannel &) = delete;
+
+        bool IsOpen() const;
+        std::size_t Capacity() const;
+
+        RingStatus Send(std::string_view message, std::chrono::milliseconds timeout, int hangup_descriptor = -1);
+        RingStatus Receive(std::string &message, std::chrono::milliseconds timeout, int hangup_descriptor = -1);
+
+        void Close();
+
+        // The Inbound Ring's Three Descriptors, Then The Outbound Ring's
+        std::vector<int> Descriptors() const;
+    };
+}
+
+#endif // SHARED_MEMORY_RING_H
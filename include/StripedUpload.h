@@ -0,0 +1,100 @@
+#ifndef STRIPED_UPLOAD_H
+#define STRIPED_UPLOAD_H
+
+#include "./config/export_libs.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SN_Server
+{
+    //* One File Uploaded In Numbered Blocks Over Several Connections At Once
+    // The Whole Size Is Reserved Up Front, Every Connection Writes Its Blocks At Their Own Offset
+    // The Blocks Received Are Tracked Here, So Missing Ranges Can Be Asked For And Sent Again
+    class StripedTransfer
+    {
+    private:
+        std::string transfer_file;
+        std::string destination;
+        std::uint64_t file_size;
+        std::size_t block_size;
+        std::size_t block_count;
+
+        mutable std::mutex blocks_mutex;
+        std::vector<bool> received_blocks;
+        std::size_t received_count = 0;
+
+        // Stripes Being Received Right Now, And When The Last One Started Or Ended
+        std::size_t active_stripes = 0;
+        std::chrono::steady_clock::time_point last_activity;
+
+    public:
+        // block_size Must Not Be 0, The Last Block May Be Short
+        StripedTransfer(const std::string &transfer_file, const std::string &destination, std::uint64_t file_size, std::size_t block_size);
+
+        StripedTransfer(const StripedTransfer &) = delete;
+        StripedTransfer &operator=(const StripedTransfer &) = delete;
+
+        // Reserve file_size Bytes For transfer_file (False If The Disk Has No Room For Them)
+        bool Reserve();
+
+        // The Bytes Of block_count Blocks From first_block (False If They Are Not All In The File)
+        bool GetRange(std::uint64_t first_block, std::uint64_t block_count, std::uint64_t &offset, std::uint64_t &bytes) const;
+
+        // Record Blocks As Written, True For The One Call That Completed The File
+        bool MarkReceived(std::uint64_t first_block, std::uint64_t block_count);
+
+        // The Blocks Still Missing As "first-last,first-last..." (At Most max_ranges, Then ",...")
+        std::string MissingRanges(std::size_t max_ranges = 64) const;
+
+        // Around Every Stripe, So A Transfer Is Never Expired While Data For It Arrives
+        void BeginStripe();
+        void EndStripe();
+
+        // Whether Nothing Was Received For idle_timeout
+        bool IsIdleFor(std::chrono::steady_clock::duration idle_timeout) const;
+
+        const std::string &TransferFile() const;
+        const std::string &Destination() const;
+        std::uint64_t FileSize() const;
+        std::size_t BlockSize() const;
+        std::size_t BlockCount() const;
+        std::size_t ReceivedCount() const;
+    };
+
+    //* Striped Transfers In Progress, By The Random ID Their Connections Share
+    class StripedUploads
+    {
+    private:
+        std::mutex transfers_mutex;
+        std::unordered_map<std::string, std::shared_ptr<StripedTransfer>> transfers;
+
+    public:
+        StripedUploads() = default;
+
+        StripedUploads(const StripedUploads &) = delete;
+        StripedUploads &operator=(const StripedUploads &) = delete;
+
+        // Register A Transfer Under A New Unguessable ID (From getrandom), Returned
+        // An Empty ID If The Kernel Could Not Supply Random Bytes (Nothing Is Registered Then)
+        std::string Add(std::shared_ptr<StripedTransfer> transfer);
+
+        // nullptr If There Is No Such Transfer (Or It Is Finished)
+        std::shared_ptr<StripedTransfer> Find(const std::string &transfer_id);
+
+        // Forget A Transfer (Its File Is Left Alone)
+        std::shared_ptr<StripedTransfer> Remove(const std::string &transfer_id);
+
+        // Forget A Transfer And Delete Its Unfinished File
+        bool Abort(const std::string &transfer_id);
+        void AbortAll();
+
+        std::size_t Size();
+    };
+}
+
+#endif // STRIPED_UPLOAD_H
@@ -0,0 +1,80 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <utility> // Include this line before Boost.Asio headers
+#include <boost/asio.hpp>
+#include "./config/export_libs.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace SN_Server
+{
+    // Identifies A Scheduled Timer, 0 Is Never Used
+    using TimerId = std::uint64_t;
+
+    //* Hashed Timing Wheel: Many Coarse Timers Driven By One steady_timer
+    // A Timer Goes Into The Slot Its Deadline Hashes To, With The Number Of Full
+    // Turns Left. Scheduling And Cancelling Are O(1), And Each Tick Only Looks At
+    // One Slot, However Many Timers Are Scheduled
+    // Handlers Run On The io_context, Outside The Wheel's Lock (They May Schedule Again)
+    class TimingWheel : public std::enable_shared_from_this<TimingWheel>
+    {
+    private:
+        struct Entry
+        {
+            TimerId id;
+            std::uint64_t rounds;
+            std::function<void()> handler;
+        };
+
+        // Ticks Run On Their Own Strand, Whichever Thread Runs The io_context
+        boost::asio::strand<boost::asio::io_context::executor_type> wheel_strand;
+        boost::asio::steady_timer tick_timer;
+
+        std::chrono::milliseconds tick;
+        std::chrono::steady_clock::time_point next_tick;
+
+        std::mutex wheel_mutex;
+        std::vector<std::list<Entry>> slots;
+        std::size_t current_slot = 0;
+
+        // Where Every Scheduled Timer Is, For O(1) Cancel
+        std::unordered_map<TimerId, std::pair<std::size_t, std::list<Entry>::iterator>> scheduled;
+        TimerId last_id = 0;
+
+        bool is_running = false; // Only Touched On wheel_strand
+
+        void WaitForTick();
+        void Advance();
+
+    public:
+        // Create It With std::make_shared (Ticks Hold A weak_ptr To The Wheel)
+        TimingWheel(boost::asio::io_context &io_context,
+                    std::chrono::milliseconds tick = std::chrono::milliseconds(100),
+                    std::size_t slot_count = 1024);
+
+        TimingWheel(const TimingWheel &) = delete;
+        TimingWheel &operator=(const TimingWheel &) = delete;
+
+        // Start/Stop Ticking (Thread-Safe, Done On The io_context)
+        void Start();
+        void Stop();
+
+        // Run handler Once delay Has Passed (Rounded Up To Whole Ticks), From Any Thread
+        TimerId Schedule(std::chrono::milliseconds delay, std::function<void()> handler);
+
+        // False If The Timer Already Ran (Or Was Cancelled)
+        bool Cancel(TimerId id);
+
+        std::size_t ScheduledCount();
+        std::chrono::milliseconds Tick() const;
+    };
+}
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,141 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include "./config/export_libs.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SN_Server
+{
+    //* One Finished Span (Names Are String Literals, Only The Pointer Is Kept)
+    struct TraceEvent
+    {
+        const char *name = nullptr;
+        std::uint64_t trace_id = 0;
+        std::int64_t start_us = 0;
+        std::int64_t duration_us = 0;
+    };
+
+    //* The Spans Of One Thread: A Ring, So A Long-Lived Thread Keeps Its Latest Spans
+    // Only Its Thread Records Into It, The Lock Is Only Contended While A Trace Is Written
+    class TraceBuffer
+    {
+    private:
+        friend class Tracer;
+
+        std::mutex events_mutex;
+        std::vector<TraceEvent> events;
+        std::size_t next_event = 0;
+        bool is_full = false;
+
+        // "tid" In The Trace File
+        std::uint32_t thread_index;
+
+        // Its Thread Has Exited, It Only Waits To Be Written Out
+        std::atomic<bool> is_retired{false};
+
+    public:
+        TraceBuffer(std::size_t capacity, std::uint32_t thread_index);
+
+        void Push(const TraceEvent &event);
+
+        // Its Thread Is Done: Nothing Is Pushed Anymore, The Unused Part Of The Ring Is Freed
+        void Retire();
+    };
+
+    //* Collects Spans Of Sampled Requests And Writes Them As A Chrome/Perfetto Trace
+    // A Request Is Sampled When A TraceScope Starts, Every Span Inside It On The Same
+    // Thread Is Recorded Into That Thread's Own TraceBuffer. Spans Outside A Sampled
+    // Request Cost One Thread-Local Check
+    class Tracer
+    {
+    private:
+        // Tells Tracers Apart In The Thread-Local Context (Addresses Can Be Reused)
+        std::uint64_t tracer_id;
+
+        // Sample One Request Out Of This Many (0 -> Tracing Off)
+        std::atomic<std::uint32_t> sample_every;
+        std::atomic<std::uint64_t> requests_seen{0};
+        std::atomic<std::uint64_t> last_trace_id{0};
+
+        std::size_t events_per_thread;
+        std::size_t max_retired_buffers;
+
+        // Microseconds In The Trace Count From Here
+        std::chrono::steady_clock::time_point origin;
+
+        std::mutex buffers_mutex;
+        std::vector<std::shared_ptr<TraceBuffer>> buffers;
+        std::uint32_t next_thread_index = 1;
+
+    public:
+        // Defaults Hold 4096 Spans (128 KiB) Per Thread, And Keep At Most 256 Exited Threads' Spans (32 MiB At Worst)
+        Tracer(std::uint32_t sample_every = 0, std::size_t events_per_thread = 4096, std::size_t max_retired_buffers = 256);
+
+        Tracer(const Tracer &) = delete;
+        Tracer &operator=(const Tracer &) = delete;
+
+        void SetSampleEvery(std::uint32_t sample_every);
+        std::uint32_t GetSampleEvery() const;
+
+        // A New Trace Id If This Request Is Sampled, Else 0
+        std::uint64_t StartTrace();
+
+        // The Calling Thread's Buffer (Registered On First Use)
+        std::shared_ptr<TraceBuffer> RegisterThread();
+
+        std::uint64_t GetId() const;
+        std::int64_t MicrosecondsSinceOrigin(std::chrono::steady_clock::time_point time) const;
+
+        // Write Every Buffered Span As A Chrome Trace Event File (Open In ui.perfetto.dev Or chrome://tracing)
+        bool WriteChromeTrace(const std::string &trace_file);
+
+        // Forget Every Span Recorded So Far
+        void Clear();
+    };
+
+    //* Samples One Request On This Thread And Records It As The Root Span
+    // Spans Created While It Lives On The Same Thread Belong To It
+    // Inside An Already Sampled Request It Is Just Another Span Of That Request
+    class TraceScope
+    {
+    private:
+        const char *name;
+        std::chrono::steady_clock::time_point start;
+
+        // The Context Before This Scope (Scopes Nest)
+        Tracer *previous_tracer;
+        std::uint64_t previous_trace_id;
+
+    public:
+        // tracer May Be nullptr (Nothing Is Traced)
+        TraceScope(Tracer *tracer, const char *name);
+        ~TraceScope();
+
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+    };
+
+    //* One Timed Stage Of The Current Request (Nothing Happens If It Is Not Sampled)
+    class TraceSpan
+    {
+    private:
+        const char *name;
+        bool is_recording;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit TraceSpan(const char *name);
+        ~TraceSpan();
+
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+    };
+}
+
+#endif // TRACING_H
@@ -0,0 +1,84 @@
+#ifndef TRANSFER_JOURNAL_H
+#define TRANSFER_JOURNAL_H
+
+#include "./config/export_libs.h"
+#include <sqlite3.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SN_Server
+{
+    //* One Finished File Transfer
+    struct TransferRecord
+    {
+        // Milliseconds Since The Unix Epoch, Filled In By Record() If Left 0
+        std::int64_t time_ms = 0;
+
+        // "address:port" Of The Client
+        std::string peer;
+
+        // Which Protocol Ran (e.g. "GetBinaryFile", "SendTextBasedFile")
+        std::string operation;
+
+        std::string file;
+        std::uint64_t bytes = 0;
+
+        // "ok", "mismatch", "incomplete", "error"
+        std::string status;
+    };
+
+    //* Journal Of Every File Transfer, Kept In SQLite (WAL Mode)
+    // Record() Only Queues The Record: A Background Thread Writes The Queue In
+    // Batched Transactions Through One Prepared Statement, So The Network
+    // Threads Never Wait For The Disk
+    class TransferJournal
+    {
+    private:
+        sqlite3 *database = nullptr;
+        sqlite3_stmt *insert_statement = nullptr;
+
+        // Records Waiting For The Writer Thread
+        std::mutex pending_mutex;
+        std::condition_variable pending_ready;
+        std::condition_variable pending_written;
+        std::vector<TransferRecord> pending_records;
+        bool writer_busy = false;
+        bool stopping = false;
+
+        // Past This Many Waiting Records New Ones Are Dropped (And Counted)
+        std::size_t max_pending_records;
+
+        std::atomic<std::uint64_t> written_records{0};
+        std::atomic<std::uint64_t> dropped_records{0};
+
+        std::thread writer_thread;
+
+        void WriterLoop();
+        void WriteBatch(const std::vector<TransferRecord> &batch);
+
+    public:
+        TransferJournal(const std::string &database_file = "transfers.db", std::size_t max_pending_records = 1 << 20);
+        ~TransferJournal();
+
+        TransferJournal(const TransferJournal &) = delete;
+        TransferJournal &operator=(const TransferJournal &) = delete;
+
+        bool IsOpen() const;
+
+        // Queue A Record, Never Waits For The Disk
+        void Record(TransferRecord record);
+
+        // Wait Until Every Record Queued So Far Is Written
+        void Flush();
+
+        std::uint64_t WrittenRecords() const;
+        std::uint64_t DroppedRecords() const;
+    };
+}
+
+#endif // TRANSFER_JOURNAL_H
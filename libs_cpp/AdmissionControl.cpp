@@ -0,0 +1,153 @@
+#include "../include/AdmissionControl.h"
+#include <algorithm>
+#include <bit>
+
+namespace SN_Server
+{
+    namespace
+    {
+        std::size_t RejectedIndex(AdmissionDecision reason)
+        {
+            return static_cast<std::size_t>(std::countr_zero(static_cast<unsigned int>(reason)));
+        }
+    }
+
+    /**
+     * @brief Construct a new Admission Control object, its accept bucket starts full
+     *
+     * @param limits the limits to enforce
+     */
+    AdmissionControl::AdmissionControl(const AdmissionLimits &limits)
+        : limits(limits),
+          accept_tokens(static_cast<double>(limits.accept_burst)),
+          last_refill(std::chrono::steady_clock::now())
+    {
+    }
+
+    void AdmissionControl::SetLimits(const AdmissionLimits &limits)
+    {
+        std::lock_guard<std::mutex> lock(this->admission_mutex);
+        this->limits = limits;
+        this->accept_tokens = std::min(this->accept_tokens, static_cast<double>(limits.accept_burst));
+    }
+
+    AdmissionLimits AdmissionControl::GetLimits() const
+    {
+        std::lock_guard<std::mutex> lock(this->admission_mutex);
+        return this->limits;
+    }
+
+    void AdmissionControl::RefillAcceptTokens(std::chrono::steady_clock::time_point now)
+    {
+        std::chrono::duration<double> elapsed = now - this->last_refill;
+        this->last_refill = now;
+        this->accept_tokens = std::min(
+            this->accept_tokens + elapsed.count() * this->limits.accepts_per_second,
+            static_cast<double>(this->limits.accept_burst)
+        );
+    }
+
+    /**
+     * @brief Check the limits in order of cost to the server: memory, connections, per address, then rate \n
+     * Only an admitted connection takes an accept token, so a flood of rejected ones cannot starve the bucket
+     *
+     * @param address the IP address of the new connection
+     * @param buffered_bytes the bytes waiting in all send queues right now
+     * @return AdmissionDecision Admitted, or the first limit the connection is over
+     */
+    AdmissionDecision AdmissionControl::Admit(const boost::asio::ip::address &address, std::size_t buffered_bytes)
+    {
+        AdmissionDecision decision = AdmissionDecision::Admitted;
+        {
+            std::lock_guard<std::mutex> lock(this->admission_mutex);
+
+            std::size_t *from_address = nullptr;
+            auto found = this->connections_per_address.find(address);
+            if (found != this->connections_per_address.end())
+            {
+                from_address = &found->second;
+            }
+
+            if (this->limits.accepts_per_second > 0)
+            {
+                this->RefillAcceptTokens(std::chrono::steady_clock::now());
+            }
+
+            if (this->limits.max_buffered_bytes != 0 && buffered_bytes >= this->limits.max_buffered_bytes)
+            {
+                decision = AdmissionDecision::RejectedBufferedMemory;
+            }
+            else if (this->limits.max_connections != 0 && this->open_connections >= this->limits.max_connections)
+            {
+                decision = AdmissionDecision::RejectedTooManyConnections;
+            }
+            else if (this->limits.max_connections_per_address != 0 && from_address != nullptr &&
+                     *from_address >= this->limits.max_connections_per_address)
+            {
+                decision = AdmissionDecision::RejectedTooManyFromAddress;
+            }
+            else if (this->limits.accepts_per_second > 0 && this->accept_tokens < 1.0)
+            {
+                decision = AdmissionDecision::RejectedAcceptRate;
+            }
+            else
+            {
+                if (this->limits.accepts_per_second > 0)
+                {
+                    this->accept_tokens -= 1.0;
+                }
+                this->open_connections++;
+                this->connections_per_address[address]++;
+            }
+        }
+
+        if (decision != AdmissionDecision::Admitted)
+        {
+            this->rejected[RejectedIndex(decision)]++;
+        }
+        return decision;
+    }
+
+    void AdmissionControl::Release(const boost::asio::ip::address &address)
+    {
+        std::lock_guard<std::mutex> lock(this->admission_mutex);
+
+        auto found = this->connections_per_address.find(address);
+        if (found == this->connections_per_address.end())
+        {
+            return;
+        }
+
+        // Forget Addresses With Nothing Open, So The Map Only Holds Live Clients
+        if (--found->second == 0)
+        {
+            this->connections_per_address.erase(found);
+        }
+        this->open_connections--;
+    }
+
+    std::size_t AdmissionControl::OpenConnections() const
+    {
+        std::lock_guard<std::mutex> lock(this->admission_mutex);
+        return this->open_connections;
+    }
+
+    std::uint64_t AdmissionControl::RejectedCount(AdmissionDecision reason) const
+    {
+        if (reason == AdmissionDecision::Admitted)
+        {
+            return 0;
+        }
+        return this->rejected[RejectedIndex(reason)];
+    }
+
+    std::uint64_t AdmissionControl::RejectedCount() const
+    {
+        std::uint64_t total = 0;
+        for (const std::atomic<std::uint64_t> &count : this->rejected)
+        {
+            total += count;
+        }
+        return total;
+    }
+}
@@ -0,0 +1,72 @@
+#include "../include/BufferPool.h"
+
+namespace SN_Server
+{
+    /**
+     * @brief Construct a new Buffer Pool object
+     *
+     * @param max_pooled_buffers how many idle buffers are kept for reuse
+     * @param max_pooled_capacity buffers larger than this are freed, so one huge message does not pin its memory
+     */
+    BufferPool::BufferPool(std::size_t max_pooled_buffers, std::size_t max_pooled_capacity)
+        : max_pooled_buffers(max_pooled_buffers), max_pooled_capacity(max_pooled_capacity)
+    {
+    }
+
+    std::unique_ptr<std::string> BufferPool::Acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->free_buffers_mutex);
+            if (!this->free_buffers.empty())
+            {
+                std::unique_ptr<std::string> buffer = std::move(this->free_buffers.back());
+                this->free_buffers.pop_back();
+                return buffer;
+            }
+        }
+
+        return std::make_unique<std::string>();
+    }
+
+    void BufferPool::Release(std::unique_ptr<std::string> buffer)
+    {
+        if (!buffer || buffer->capacity() > this->max_pooled_capacity)
+        {
+            return;
+        }
+
+        // Keep The Capacity, Drop The Content
+        buffer->clear();
+
+        std::lock_guard<std::mutex> lock(this->free_buffers_mutex);
+        if (this->free_buffers.size() < this->max_pooled_buffers)
+        {
+            this->free_buffers.push_back(std::move(buffer));
+        }
+    }
+
+    /**
+     * @brief Hand a filled buffer to the send path without copying it \n
+     * The buffer goes back to the pool once every send queue holding it is done (Or is freed if the pool is gone)
+     *
+     * @param buffer the message
+     * @return SharedBuffer the same bytes, immutable from now on
+     */
+    SharedBuffer BufferPool::Share(std::unique_ptr<std::string> buffer)
+    {
+        std::weak_ptr<BufferPool> pool = this->weak_from_this();
+        return SharedBuffer(buffer.release(), [pool](const std::string *released) {
+            std::unique_ptr<std::string> returned(const_cast<std::string *>(released));
+            if (std::shared_ptr<BufferPool> alive_pool = pool.lock())
+            {
+                alive_pool->Release(std::move(returned));
+            }
+        });
+    }
+
+    std::size_t BufferPool::PooledBuffers()
+    {
+        std::lock_guard<std::mutex> lock(this->free_buffers_mutex);
+        return this->free_buffers.size();
+    }
+}
@@ -0,0 +1,331 @@
+#include "../include/Checksum.h"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CHECKSUM_HAS_SSE42_PATH 1
+#endif
+
+namespace SN_Server
+{
+    namespace
+    {
+        // CRC32C Polynomial In Reflected Form
+        constexpr std::uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+        // Slice-By-8 Tables For The Software Path
+        constexpr std::array<std::array<std::uint32_t, 256>, 8> MakeCrc32cTables()
+        {
+            std::array<std::array<std::uint32_t, 256>, 8> tables{};
+            for (std::uint32_t byte = 0; byte < 256; byte++)
+            {
+                std::uint32_t crc = byte;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+                }
+                tables[0][byte] = crc;
+            }
+
+            for (std::uint32_t byte = 0; byte < 256; byte++)
+            {
+                for (int slice = 1; slice < 8; slice++)
+                {
+                    std::uint32_t previous = tables[slice - 1][byte];
+                    tables[slice][byte] = (previous >> 8) ^ tables[0][previous & 0xff];
+                }
+            }
+
+            return tables;
+        }
+
+        constexpr std::array<std::array<std::uint32_t, 256>, 8> CRC32C_TABLES = MakeCrc32cTables();
+
+        std::uint32_t Crc32cSoftware(std::uint32_t crc, const unsigned char *data, std::size_t size)
+        {
+            while (size >= 8)
+            {
+                std::uint32_t low;
+                std::uint32_t high;
+                std::memcpy(&low, data, 4);
+                std::memcpy(&high, data + 4, 4);
+                low ^= crc;
+
+                crc = CRC32C_TABLES[7][low & 0xff] ^ CRC32C_TABLES[6][(low >> 8) & 0xff] ^
+                      CRC32C_TABLES[5][(low >> 16) & 0xff] ^ CRC32C_TABLES[4][low >> 24] ^
+                      CRC32C_TABLES[3][high & 0xff] ^ CRC32C_TABLES[2][(high >> 8) & 0xff] ^
+                      CRC32C_TABLES[1][(high >> 16) & 0xff] ^ CRC32C_TABLES[0][high >> 24];
+
+                data += 8;
+                size -= 8;
+            }
+
+            while (size-- > 0)
+            {
+                crc = CRC32C_TABLES[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+            }
+
+            return crc;
+        }
+
+#ifdef CHECKSUM_HAS_SSE42_PATH
+        // Bytes Per Lane When Three Independent crc32 Chains Run Side By Side
+        constexpr std::size_t CRC32C_LANE_SIZE = 1024;
+
+        // a * b Modulo The CRC32C Polynomial (Reflected Bit Order)
+        std::uint32_t MultiplyModPolynomial(std::uint32_t a, std::uint32_t b)
+        {
+            std::uint32_t mask = 1u << 31;
+            std::uint32_t product = 0;
+            while (mask != 0)
+            {
+                if (a & mask)
+                {
+                    product ^= b;
+                }
+                mask >>= 1;
+                b = (b & 1) ? (b >> 1) ^ CRC32C_POLYNOMIAL : b >> 1;
+            }
+            return product;
+        }
+
+        // x^(8 * byte_count) Modulo The Polynomial: Multiplying A CRC Register By It
+        // Is The Same As Running byte_count Zero Bytes Through The Register
+        std::uint32_t ZeroBytesOperator(std::size_t byte_count)
+        {
+            std::uint32_t power = 1u << 31; // x^0
+            for (std::size_t bit = 0; bit < byte_count * 8; bit++)
+            {
+                power = (power & 1) ? (power >> 1) ^ CRC32C_POLYNOMIAL : power >> 1;
+            }
+            return power;
+        }
+
+        __attribute__((target("sse4.2")))
+        std::uint32_t Crc32cHardware(std::uint32_t crc, const unsigned char *data, std::size_t size)
+        {
+            static const std::uint32_t shift_one_lane = ZeroBytesOperator(CRC32C_LANE_SIZE);
+            static const std::uint32_t shift_two_lanes = ZeroBytesOperator(2 * CRC32C_LANE_SIZE);
+
+            // Walk Up To 8-Byte Alignment
+            while (size > 0 && (reinterpret_cast<std::uintptr_t>(data) & 7) != 0)
+            {
+                crc = _mm_crc32_u8(crc, *data++);
+                size--;
+            }
+
+            // The crc32 Instruction Has A 3-Cycle Latency But 1-Cycle Throughput,
+            // So Three Independent Chains Keep It Busy. They Are Merged By Shifting
+            // The Earlier Lanes Over The Bytes Of The Later Ones
+            while (size >= 3 * CRC32C_LANE_SIZE)
+            {
+                std::uint64_t crc0 = crc;
+                std::uint64_t crc1 = 0;
+                std::uint64_t crc2 = 0;
+                for (std::size_t offset = 0; offset < CRC32C_LANE_SIZE; offset += 8)
+                {
+                    std::uint64_t word0;
+                    std::uint64_t word1;
+                    std::uint64_t word2;
+                    std::memcpy(&word0, data + offset, 8);
+                    std::memcpy(&word1, data + CRC32C_LANE_SIZE + offset, 8);
+                    std::memcpy(&word2, data + 2 * CRC32C_LANE_SIZE + offset, 8);
+                    crc0 = _mm_crc32_u64(crc0, word0);
+                    crc1 = _mm_crc32_u64(crc1, word1);
+                    crc2 = _mm_crc32_u64(crc2, word2);
+                }
+
+                crc = MultiplyModPolynomial(shift_two_lanes, static_cast<std::uint32_t>(crc0)) ^
+                      MultiplyModPolynomial(shift_one_lane, static_cast<std::uint32_t>(crc1)) ^
+                      static_cast<std::uint32_t>(crc2);
+
+                data += 3 * CRC32C_LANE_SIZE;
+                size -= 3 * CRC32C_LANE_SIZE;
+            }
+
+            std::uint64_t crc64 = crc;
+            while (size >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, data, 8);
+                crc64 = _mm_crc32_u64(crc64, word);
+                data += 8;
+                size -= 8;
+            }
+            crc = static_cast<std::uint32_t>(crc64);
+
+            while (size-- > 0)
+            {
+                crc = _mm_crc32_u8(crc, *data++);
+            }
+
+            return crc;
+        }
+#endif
+    }
+
+    //* INFO: Crc32c
+    void Crc32c::Update(const void *data, std::size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+#ifdef CHECKSUM_HAS_SSE42_PATH
+        if (HasHardwareSupport())
+        {
+            this->state = Crc32cHardware(this->state, bytes, size);
+            return;
+        }
+#endif
+
+        this->state = Crc32cSoftware(this->state, bytes, size);
+    }
+
+    std::uint32_t Crc32c::Value() const
+    {
+        return ~this->state;
+    }
+
+    bool Crc32c::HasHardwareSupport()
+    {
+#ifdef CHECKSUM_HAS_SSE42_PATH
+        static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+        return has_sse42;
+#else
+        return false;
+#endif
+    }
+
+    //* INFO: Sha256Digest
+    Sha256Digest::Sha256Digest()
+    {
+        this->context = EVP_MD_CTX_new();
+        if (this->context == nullptr || EVP_DigestInit_ex(this->context, EVP_sha256(), nullptr) != 1)
+        {
+            EVP_MD_CTX_free(this->context);
+            throw std::runtime_error("Unable to initialize SHA-256 digest");
+        }
+    }
+
+    Sha256Digest::~Sha256Digest()
+    {
+        EVP_MD_CTX_free(this->context);
+    }
+
+    void Sha256Digest::Update(const void *data, std::size_t size)
+    {
+        if (size > 0)
+        {
+            EVP_DigestUpdate(this->context, data, size);
+        }
+    }
+
+    std::string Sha256Digest::FinalHex()
+    {
+        unsigned char raw_digest[EVP_MAX_MD_SIZE];
+        unsigned int raw_size = 0;
+        EVP_DigestFinal_ex(this->context, raw_digest, &raw_size);
+
+        static const char hex_chars[] = "0123456789abcdef";
+        std::string hex_digest;
+        hex_digest.reserve(raw_size * 2);
+        for (unsigned int index = 0; index < raw_size; index++)
+        {
+            hex_digest += hex_chars[raw_digest[index] >> 4];
+            hex_digest += hex_chars[raw_digest[index] & 0x0f];
+        }
+
+        return hex_digest;
+    }
+
+    //* INFO: TransferChecksum
+    TransferChecksum::TransferChecksum(TransferIntegrity integrity)
+        : integrity(integrity)
+    {
+        if ((this->integrity & IntegrityCrc32cSha256) == IntegrityCrc32cSha256)
+        {
+            this->sha256.emplace();
+        }
+    }
+
+    void TransferChecksum::Update(std::string_view chunk)
+    {
+        if (this->integrity & IntegrityCrc32c)
+        {
+            this->crc32c.Update(chunk.data(), chunk.size());
+        }
+
+        if (this->sha256)
+        {
+            this->sha256->Update(chunk.data(), chunk.size());
+        }
+    }
+
+    std::string TransferChecksum::FinalTrailer()
+    {
+        std::string trailer;
+        if (this->integrity & IntegrityCrc32c)
+        {
+            char crc_hex[9];
+            std::snprintf(crc_hex, sizeof(crc_hex), "%08x", this->crc32c.Value());
+            trailer = std::string("crc32c:") + crc_hex;
+        }
+
+        if (this->sha256)
+        {
+            trailer += " sha256:" + this->sha256->FinalHex();
+        }
+
+        return trailer;
+    }
+
+    /**
+     * @brief Compare the trailer sent by the client with the one computed while receiving \n
+     * Fields are "name:value" separated by spaces, so "crc32c:..." alone is accepted even if sha256 was computed too
+     *
+     * @param received_trailer the trailer frame from the client
+     * @param computed_trailer the result of FinalTrailer()
+     * @return true if at least one field is present and every present field matches
+     */
+    bool TransferChecksum::TrailerMatches(std::string_view received_trailer, std::string_view computed_trailer)
+    {
+        std::size_t matched_fields = 0;
+        std::size_t position = 0;
+        while (position < received_trailer.size())
+        {
+            std::size_t field_end = received_trailer.find(' ', position);
+            if (field_end == std::string_view::npos)
+            {
+                field_end = received_trailer.size();
+            }
+
+            std::string_view field = received_trailer.substr(position, field_end - position);
+            position = field_end + 1;
+            if (field.empty())
+            {
+                continue;
+            }
+
+            std::size_t colon = field.find(':');
+            if (colon == std::string_view::npos)
+            {
+                return false;
+            }
+
+            // The Same Field Must Appear In The Computed Trailer As A Whole Word
+            std::size_t found = computed_trailer.find(field);
+            bool whole_word = found != std::string_view::npos &&
+                              (found == 0 || computed_trailer[found - 1] == ' ') &&
+                              (found + field.size() == computed_trailer.size() || computed_trailer[found + field.size()] == ' ');
+            if (!whole_word)
+            {
+                return false;
+            }
+
+            matched_fields++;
+        }
+
+        return matched_fields > 0;
+    }
+}
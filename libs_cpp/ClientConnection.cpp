@@ -0,0 +1,1180 @@
+#include "../include/ClientConnection.h"
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
+
+namespace SN_Server
+{
+    namespace
+    {
+        // Bytes Read Per Step When A File Cannot Be Sent With sendfile
+        constexpr std::size_t FILE_BLOCK_SIZE = 64 * 1024;
+
+        // File Descriptors Accepted In One Message, And Kept Untaken Per Client (Extras Are Closed)
+        constexpr std::size_t MAX_DESCRIPTORS_PER_MESSAGE = 8;
+        constexpr std::size_t MAX_PENDING_DESCRIPTORS = 16;
+
+        std::string MakeRemoteAddress(const boost::asio::ip::tcp::socket &socket)
+        {
+            boost::system::error_code error;
+            boost::asio::ip::tcp::endpoint endpoint = socket.remote_endpoint(error);
+            if (error)
+            {
+                return "unknown";
+            }
+            return endpoint.address().to_string() + ":" + std::to_string(endpoint.port());
+        }
+
+        std::string MakeRemoteAddress(LocalSocket &socket)
+        {
+#ifdef __linux__
+            // Unix Domain Clients Rarely Bind A Path -> Name Them By Their Process
+            boost::asio::local::stream_protocol::socket::native_handle_type handle = socket.native_handle();
+            struct ucred credentials;
+            socklen_t credentials_size = sizeof(credentials);
+            if (::getsockopt(handle, SOL_SOCKET, SO_PEERCRED, &credentials, &credentials_size) == 0)
+            {
+                return "unix:pid=" + std::to_string(credentials.pid);
+            }
+#endif
+            boost::system::error_code error;
+            return "unix:" + socket.remote_endpoint(error).path();
+        }
+
+        // The File Descriptors Of Every SCM_RIGHTS Message In message's Control Data
+        std::vector<int> DescriptorsInMessage(msghdr &message)
+        {
+            std::vector<int> descriptors;
+            for (cmsghdr *control = CMSG_FIRSTHDR(&message); control != nullptr; control = CMSG_NXTHDR(&message, control))
+            {
+                if (control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_RIGHTS)
+                {
+                    continue;
+                }
+
+                std::size_t count = (control->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                const unsigned char *data = CMSG_DATA(control);
+                for (std::size_t index = 0; index < count; index++)
+                {
+                    int descriptor;
+                    std::memcpy(&descriptor, data + index * sizeof(int), sizeof(int));
+                    descriptors.push_back(descriptor);
+                }
+            }
+            return descriptors;
+        }
+
+        std::int64_t NowTicks()
+        {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+
+        std::chrono::steady_clock::time_point FromTicks(std::int64_t ticks)
+        {
+            return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+        }
+
+        template <typename Socket>
+        boost::asio::io_context *FindIoContext(Socket &socket)
+        {
+            const boost::asio::io_context::executor_type *executor =
+                socket.get_executor().template target<boost::asio::io_context::executor_type>();
+            return executor != nullptr ? &executor->context() : nullptr;
+        }
+    }
+
+    //* INFO: SendMemoryAccount
+    SendMemoryAccount::SendMemoryAccount(std::size_t limit_bytes)
+        : limit_bytes(limit_bytes)
+    {
+    }
+
+    void SendMemoryAccount::Add(std::size_t bytes)
+    {
+        this->total_bytes += bytes;
+    }
+
+    void SendMemoryAccount::Remove(std::size_t bytes)
+    {
+        this->total_bytes -= bytes;
+    }
+
+    std::size_t SendMemoryAccount::TotalBytes() const
+    {
+        return this->total_bytes;
+    }
+
+    std::size_t SendMemoryAccount::LimitBytes() const
+    {
+        return this->limit_bytes;
+    }
+
+    void SendMemoryAccount::SetLimitBytes(std::size_t limit_bytes)
+    {
+        this->limit_bytes = limit_bytes;
+    }
+
+    bool SendMemoryAccount::IsOverLimit() const
+    {
+        return this->total_bytes > this->limit_bytes;
+    }
+
+    //* INFO: ClientConnection
+    /**
+     * @brief Construct a plain TCP client connection
+     *
+     * @param socket the accepted socket
+     */
+    ClientConnection::ClientConnection(boost::asio::ip::tcp::socket socket)
+        : stream(std::in_place_type<boost::asio::ip::tcp::socket>, std::move(socket)),
+          strand(boost::asio::make_strand(std::get<boost::asio::ip::tcp::socket>(this->stream).get_executor())),
+          ready_to_write(true)
+    {
+        this->remote_address = MakeRemoteAddress(std::get<boost::asio::ip::tcp::socket>(this->stream));
+        this->native_handle = std::get<boost::asio::ip::tcp::socket>(this->stream).native_handle();
+        this->owner_io_context = FindIoContext(std::get<boost::asio::ip::tcp::socket>(this->stream));
+        this->last_write_time = NowTicks();
+    }
+
+    /**
+     * @brief Construct a TLS client connection, call Handshake() before any read/write
+     *
+     * @param socket the accepted socket
+     * @param tls_context the server's TLS context (Certificate, session cache, tickets)
+     */
+    ClientConnection::ClientConnection(boost::asio::ip::tcp::socket socket, boost::asio::ssl::context &tls_context)
+        : stream(std::in_place_type<TlsStream>, std::move(socket), tls_context),
+          strand(boost::asio::make_strand(std::get<TlsStream>(this->stream).get_executor())),
+          ready_to_write(false)
+    {
+        TlsStream &tls_stream = std::get<TlsStream>(this->stream);
+        this->remote_address = MakeRemoteAddress(tls_stream.next_layer());
+        this->native_handle = tls_stream.next_layer().native_handle();
+        this->owner_io_context = FindIoContext(tls_stream.next_layer());
+        this->last_write_time = NowTicks();
+    }
+
+    /**
+     * @brief Construct a client connection over a Unix domain socket \n
+     * Reads go through recvmsg, so the client can pass open files along with its bytes
+     *
+     * @param socket the accepted local socket
+     */
+    ClientConnection::ClientConnection(LocalSocket socket)
+        : stream(std::in_place_type<LocalSocket>, std::move(socket)),
+          strand(boost::asio::make_strand(std::get<LocalSocket>(this->stream).get_executor())),
+          ready_to_write(true)
+    {
+        this->remote_address = MakeRemoteAddress(std::get<LocalSocket>(this->stream));
+        this->native_handle = std::get<LocalSocket>(this->stream).native_handle();
+        this->owner_io_context = FindIoContext(std::get<LocalSocket>(this->stream));
+        this->last_write_time = NowTicks();
+    }
+
+    ClientConnection::~ClientConnection()
+    {
+        // Messages Still Queued When The io_context Went Away
+        if (this->memory_account)
+        {
+            this->memory_account->Remove(this->queued_bytes);
+        }
+
+        // Passed Files Nobody Took
+        for (int descriptor : this->received_descriptors)
+        {
+            ::close(descriptor);
+        }
+    }
+
+    template <typename Function>
+    decltype(auto) ClientConnection::VisitLowestLayer(Function &&function)
+    {
+        return std::visit([&](auto &transport) -> decltype(auto) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(transport)>, TlsStream>)
+            {
+                return function(transport.next_layer());
+            }
+            else
+            {
+                return function(transport);
+            }
+        }, this->stream);
+    }
+
+    bool ClientConnection::IsTls() const
+    {
+        return std::holds_alternative<TlsStream>(this->stream);
+    }
+
+    bool ClientConnection::IsLocal() const
+    {
+        return std::holds_alternative<LocalSocket>(this->stream);
+    }
+
+    bool ClientConnection::IsOpen() const
+    {
+        // Close() Only Shuts The Socket Down, The Descriptor Itself Stays Open Until The Connection Is Destroyed
+        if (this->is_closed)
+        {
+            return false;
+        }
+        if (this->IsTls())
+        {
+            return std::get<TlsStream>(this->stream).next_layer().is_open();
+        }
+        if (this->IsLocal())
+        {
+            return std::get<LocalSocket>(this->stream).is_open();
+        }
+        return std::get<boost::asio::ip::tcp::socket>(this->stream).is_open();
+    }
+
+    /**
+     * @brief Post start onto the strand and block the calling thread until the operation calls its handler
+     *
+     * @param start begins the asynchronous operation, with the handler to call on completion
+     * @param error the error of the operation (operation_aborted if the io_context went away first)
+     * @return std::size_t bytes transferred by the operation
+     */
+    std::size_t ClientConnection::RunAndWait(const std::function<void(SendHandler)> &start, boost::system::error_code &error)
+    {
+        std::shared_ptr<std::promise<std::pair<boost::system::error_code, std::size_t>>> result =
+            std::make_shared<std::promise<std::pair<boost::system::error_code, std::size_t>>>();
+        std::future<std::pair<boost::system::error_code, std::size_t>> completion = result->get_future();
+
+        boost::asio::post(this->strand, [start, result]() {
+            start([result](const boost::system::error_code &operation_error, std::size_t bytes_transferred) {
+                result->set_value({operation_error, bytes_transferred});
+            });
+        });
+
+        try
+        {
+            std::pair<boost::system::error_code, std::size_t> outcome = completion.get();
+            error = outcome.first;
+            return outcome.second;
+        }
+        catch (const std::future_error &)
+        {
+            // The Handler Was Destroyed Without Running (io_context Gone)
+            error = boost::asio::error::operation_aborted;
+            return 0;
+        }
+    }
+
+    void ClientConnection::Handshake(boost::system::error_code &error)
+    {
+        if (!this->IsTls())
+        {
+            return;
+        }
+
+        // A Client That Never Finishes The Handshake Times Out Like An Idle One
+        this->read_waiting_since = NowTicks();
+        this->RunAndWait([this](SendHandler done) {
+            std::get<TlsStream>(this->stream).async_handshake(
+                boost::asio::ssl::stream_base::server,
+                boost::asio::bind_executor(this->strand, [this, done](const boost::system::error_code &handshake_error) {
+                    // Flush Whatever Was Queued (e.g. Broadcasts) While Handshaking
+                    // After A Failed Handshake The Writes Just Fail And Report It
+                    this->ready_to_write = true;
+                    if (!this->write_in_progress)
+                    {
+                        this->StartNextWrite();
+                    }
+                    done(handshake_error, 0);
+                })
+            );
+        }, error);
+        this->read_waiting_since = 0;
+    }
+
+    bool ClientConnection::IsSessionReused()
+    {
+        if (this->IsTls())
+        {
+            return SSL_session_reused(std::get<TlsStream>(this->stream).native_handle()) == 1;
+        }
+        return false;
+    }
+
+    std::size_t ClientConnection::ReadSome(boost::asio::mutable_buffer buffer, boost::system::error_code &error)
+    {
+        this->read_waiting_since = NowTicks();
+#ifdef __linux__
+        if (std::holds_alternative<boost::asio::ip::tcp::socket>(this->stream))
+        {
+            std::size_t bytes_read = this->ReceiveDirect(buffer, error);
+            this->read_waiting_since = 0;
+            return bytes_read;
+        }
+#endif
+
+        std::size_t bytes_read = this->RunAndWait([this, buffer](SendHandler done) {
+            if (this->IsLocal())
+            {
+                this->ReceiveWithDescriptors(buffer, std::move(done));
+                return;
+            }
+
+            std::visit([&](auto &transport) {
+                transport.async_read_some(buffer, boost::asio::bind_executor(this->strand, done));
+            }, this->stream);
+        }, error);
+        this->read_waiting_since = 0;
+        return bytes_read;
+    }
+
+#ifdef __linux__
+    /**
+     * @brief Read a plain TCP client straight from its socket, on the calling thread \n
+     * Nothing of the read is shared with the strand's writes (Unlike TLS), so it needs no hop onto it \n
+     * The socket may be non-blocking (sendfile sets it), then poll() waits for the bytes instead \n
+     * Close() shuts the socket down, which ends both recv() and poll() with end of file
+     *
+     * @param buffer where the bytes go
+     * @param error eof once the client closed, or the error of recv()
+     * @return std::size_t bytes read
+     */
+    std::size_t ClientConnection::ReceiveDirect(boost::asio::mutable_buffer buffer, boost::system::error_code &error)
+    {
+        error = boost::system::error_code();
+        if (buffer.size() == 0)
+        {
+            return 0;
+        }
+
+        while (!this->is_closed)
+        {
+            ssize_t bytes_read = ::recv(this->native_handle, buffer.data(), buffer.size(), 0);
+            if (bytes_read > 0)
+            {
+                return static_cast<std::size_t>(bytes_read);
+            }
+            if (bytes_read == 0)
+            {
+                error = boost::asio::error::eof;
+                return 0;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct pollfd readable = {this->native_handle, POLLIN, 0};
+                if (::poll(&readable, 1, -1) < 0 && errno != EINTR)
+                {
+                    error = boost::system::error_code(errno, boost::system::system_category());
+                    return 0;
+                }
+                continue;
+            }
+            if (errno != EINTR)
+            {
+                error = boost::system::error_code(errno, boost::system::system_category());
+                return 0;
+            }
+        }
+
+        error = boost::asio::error::operation_aborted;
+        return 0;
+    }
+#endif
+
+    /**
+     * @brief Read whatever is available with recvmsg, so SCM_RIGHTS control data is not lost \n
+     * The descriptors are kept (Close-on-exec) until TakeReceivedDescriptor, past MAX_PENDING_DESCRIPTORS they are closed
+     *
+     * @param buffer where the bytes go
+     * @param done called with the bytes read, or eof once the client closed
+     */
+    void ClientConnection::ReceiveWithDescriptors(boost::asio::mutable_buffer buffer, SendHandler done)
+    {
+        LocalSocket &socket = std::get<LocalSocket>(this->stream);
+
+        // recvmsg Must Not Block The io_context Thread
+        boost::system::error_code error;
+        socket.native_non_blocking(true, error);
+        if (error)
+        {
+            done(error, 0);
+            return;
+        }
+
+        iovec io_vector;
+        io_vector.iov_base = buffer.data();
+        io_vector.iov_len = buffer.size();
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MAX_DESCRIPTORS_PER_MESSAGE)];
+        msghdr message{};
+        message.msg_iov = &io_vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t bytes_read;
+        do
+        {
+            bytes_read = ::recvmsg(this->native_handle, &message, MSG_CMSG_CLOEXEC);
+        } while (bytes_read < 0 && errno == EINTR);
+
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // Nothing Yet -> Try Again Once It Is Readable
+            socket.async_wait(
+                LocalSocket::wait_read,
+                boost::asio::bind_executor(this->strand, [self = this->shared_from_this(), buffer, done](const boost::system::error_code &wait_error) {
+                    if (wait_error)
+                    {
+                        done(wait_error, 0);
+                        return;
+                    }
+                    self->ReceiveWithDescriptors(buffer, done);
+                })
+            );
+            return;
+        }
+
+        if (bytes_read < 0)
+        {
+            done(boost::system::error_code(errno, boost::system::system_category()), 0);
+            return;
+        }
+
+        if (message.msg_flags & MSG_CTRUNC)
+        {
+            std::cerr << this->remote_address << " passed more than " << MAX_DESCRIPTORS_PER_MESSAGE
+                      << " file descriptors at once, the rest were dropped." << std::endl;
+        }
+
+        std::vector<int> descriptors = DescriptorsInMessage(message);
+        if (!descriptors.empty())
+        {
+            std::lock_guard<std::mutex> lock(this->descriptors_mutex);
+            for (int descriptor : descriptors)
+            {
+                if (this->received_descriptors.size() >= MAX_PENDING_DESCRIPTORS)
+                {
+                    std::cerr << this->remote_address << " has too many untaken file descriptors, closing one." << std::endl;
+                    ::close(descriptor);
+                    continue;
+                }
+                this->received_descriptors.push_back(descriptor);
+            }
+        }
+
+        if (bytes_read == 0 && buffer.size() > 0)
+        {
+            done(boost::asio::error::eof, 0);
+            return;
+        }
+        done(boost::system::error_code(), static_cast<std::size_t>(bytes_read));
+    }
+
+    int ClientConnection::TakeReceivedDescriptor()
+    {
+        std::lock_guard<std::mutex> lock(this->descriptors_mutex);
+        if (this->received_descriptors.empty())
+        {
+            return -1;
+        }
+
+        int descriptor = this->received_descriptors.front();
+        this->received_descriptors.pop_front();
+        return descriptor;
+    }
+
+    //* INFO: Send Queue
+    /**
+     * @brief Queue a message without waiting for it to be written \n
+     * When the queue is over its high watermark (Or the shared memory account is over its limit) the overflow policy applies: \n
+     * OverflowBlock waits for the low watermark first, OverflowDropOldest drops the oldest messages not being written yet, \n
+     * OverflowDisconnect closes the client \n
+     * A message given while a request is busy is held until EndRequest(): a reply of several sends is never split by it
+     *
+     * @param message the frame to send (Shared, never copied)
+     * @param on_sent called on the strand once written, or with error::no_buffer_space if dropped/rejected
+     * @return SendOutcome whether the message was queued and whether the producer should slow down
+     */
+    SendOutcome ClientConnection::AsyncSend(SharedBuffer message, SendHandler on_sent)
+    {
+        // Reject Without Queueing: on_sent Still Runs (On The Strand) With The Reason
+        auto reject = [this, &on_sent](const boost::system::error_code &error) {
+            if (on_sent)
+            {
+                boost::asio::post(this->strand, [on_sent = std::move(on_sent), error]() {
+                    on_sent(error, 0);
+                });
+            }
+            return SendOutcome::SendRejected;
+        };
+
+        if (this->is_closed)
+        {
+            return reject(boost::asio::error::not_connected);
+        }
+
+        if (this->IsOverflowing())
+        {
+            if (this->send_limits.overflow_policy == OverflowPolicy::OverflowDisconnect)
+            {
+                std::cerr << "Send queue of " << this->remote_address << " overflowed (" << this->queued_bytes
+                          << " bytes queued), disconnecting." << std::endl;
+                this->Close();
+                return reject(boost::asio::error::no_buffer_space);
+            }
+
+            // Blocking An io_context Thread Would Stop The Very Writes It Waits For
+            if (this->send_limits.overflow_policy == OverflowPolicy::OverflowBlock && !this->IsOnIoThread())
+            {
+                this->WaitUntilWritable();
+                if (this->is_closed)
+                {
+                    return reject(boost::asio::error::not_connected);
+                }
+            }
+        }
+
+        // Once Closed Nothing Would Release A Held Message, So It Goes To The Queue (And Fails There)
+        std::size_t message_size = message->size();
+        std::unique_lock<std::mutex> lock(this->request_mutex);
+        auto is_held = [this]() {
+            return this->request_state == RequestBusy && !this->is_closed;
+        };
+
+        //* Held Messages Over The High Watermark: The Same Policy, Applied To What Is Held
+        while (is_held() && !this->held_messages.empty() && this->held_bytes + message_size > this->send_limits.high_watermark)
+        {
+            if (this->send_limits.overflow_policy == OverflowPolicy::OverflowDisconnect)
+            {
+                lock.unlock();
+                std::cerr << "Held messages of " << this->remote_address << " overflowed (" << this->held_bytes
+                          << " bytes held), disconnecting." << std::endl;
+                this->Close();
+                return reject(boost::asio::error::no_buffer_space);
+            }
+
+            if (this->send_limits.overflow_policy == OverflowPolicy::OverflowBlock)
+            {
+                // A Handler Sending To Its Own Client Would Wait For Its Own Request: Hold Past The Bound Instead
+                if (this->IsOnIoThread() || std::this_thread::get_id() == this->request_thread)
+                {
+                    break;
+                }
+                this->held_condition.wait(lock);
+                continue;
+            }
+
+            OutboundMessage dropped = std::move(this->held_messages.front());
+            this->held_messages.pop_front();
+            this->held_bytes -= dropped.accounted_bytes;
+            if (dropped.on_sent)
+            {
+                boost::asio::post(this->strand, [on_sent = std::move(dropped.on_sent)]() {
+                    on_sent(boost::asio::error::no_buffer_space, 0);
+                });
+            }
+        }
+
+        OutboundMessage outbound;
+        outbound.count = message_size;
+        outbound.accounted_bytes = message_size;
+        outbound.data = std::move(message);
+        outbound.on_sent = std::move(on_sent);
+        outbound.is_droppable = true;
+        if (is_held())
+        {
+            this->held_bytes += message_size;
+            this->held_messages.push_back(std::move(outbound));
+            return this->held_bytes > this->send_limits.high_watermark ? SendOutcome::SendQueuedAboveHighWatermark : SendOutcome::SendQueued;
+        }
+
+        this->ReserveQueuedBytes(message_size);
+        this->PostAsyncMessage(std::move(outbound));
+        lock.unlock();
+
+        return this->IsAboveHighWatermark() ? SendOutcome::SendQueuedAboveHighWatermark : SendOutcome::SendQueued;
+    }
+
+    void ClientConnection::PostAsyncMessage(OutboundMessage message)
+    {
+        boost::asio::post(this->strand, [self = this->shared_from_this(), message = std::move(message)]() mutable {
+            self->Enqueue(std::move(message));
+
+            if (self->send_limits.overflow_policy == OverflowPolicy::OverflowDropOldest)
+            {
+                self->DropOldestOverHighWatermark();
+            }
+        });
+    }
+
+    std::size_t ClientConnection::Send(SharedBuffer message, boost::system::error_code &error)
+    {
+        // The Caller Waits For Its Own Message Anyway, Which Is Backpressure Enough
+        this->ReserveQueuedBytes(message->size());
+        return this->RunAndWait([this, message](SendHandler done) {
+            OutboundMessage outbound;
+            outbound.data = message;
+            outbound.count = message->size();
+            outbound.accounted_bytes = message->size();
+            outbound.on_sent = std::move(done);
+            this->Enqueue(std::move(outbound));
+        }, error);
+    }
+
+    std::size_t ClientConnection::Write(boost::asio::const_buffer buffer, boost::system::error_code &error)
+    {
+        SharedBuffer message = std::make_shared<const std::string>(static_cast<const char *>(buffer.data()), buffer.size());
+        return this->Send(std::move(message), error);
+    }
+
+    /**
+     * @brief Send part of an open file to the client, after everything queued before it \n
+     * Plain TCP and local clients get the pages straight from the page cache (sendfile), TLS must encrypt in user space
+     *
+     * @param file_descriptor the file to send (Must stay open until this returns)
+     * @param offset where to start in the file
+     * @param count how many bytes to send
+     * @param error set on socket or file errors
+     * @return std::size_t bytes sent
+     */
+    std::size_t ClientConnection::SendFile(int file_descriptor, std::uint64_t offset, std::uint64_t count, boost::system::error_code &error)
+    {
+        return this->RunAndWait([this, file_descriptor, offset, count](SendHandler done) {
+            OutboundMessage outbound;
+            outbound.file_descriptor = file_descriptor;
+            outbound.offset = offset;
+            outbound.count = count;
+            outbound.on_sent = std::move(done);
+            this->Enqueue(std::move(outbound));
+        }, error);
+    }
+
+    /**
+     * @brief Send a message with open files attached to its first byte, after everything queued before it \n
+     * Only a Unix domain socket can carry descriptors: others fail with operation_not_supported
+     *
+     * @param message the frame to send
+     * @param descriptors the files to pass (The client receives duplicates, these stay the caller's)
+     * @param error set on socket errors
+     * @return std::size_t bytes sent
+     */
+    std::size_t ClientConnection::SendDescriptors(SharedBuffer message, const std::vector<int> &descriptors, boost::system::error_code &error)
+    {
+        if (!this->IsLocal())
+        {
+            error = boost::asio::error::operation_not_supported;
+            return 0;
+        }
+
+        this->ReserveQueuedBytes(message->size());
+        return this->RunAndWait([this, message, descriptors](SendHandler done) {
+            OutboundMessage outbound;
+            outbound.data = message;
+            outbound.count = message->size();
+            outbound.accounted_bytes = message->size();
+            outbound.descriptors = descriptors;
+            outbound.on_sent = std::move(done);
+            this->Enqueue(std::move(outbound));
+        }, error);
+    }
+
+    void ClientConnection::Enqueue(OutboundMessage message)
+    {
+        this->send_queue.push_back(std::move(message));
+        if (this->ready_to_write && !this->write_in_progress)
+        {
+            this->StartNextWrite();
+        }
+    }
+
+    void ClientConnection::StartNextWrite()
+    {
+        if (this->send_queue.empty())
+        {
+            this->write_in_progress = false;
+            this->write_waiting_since = 0;
+            return;
+        }
+
+        this->write_in_progress = true;
+        this->write_waiting_since = NowTicks();
+        OutboundMessage &front = this->send_queue.front();
+        if (front.file_descriptor >= 0)
+        {
+            this->ContinueFileSend();
+            return;
+        }
+        if (!front.descriptors.empty())
+        {
+            this->ContinueDescriptorSend();
+            return;
+        }
+
+        std::visit([&](auto &transport) {
+            boost::asio::async_write(
+                transport,
+                boost::asio::buffer(*front.data),
+                boost::asio::bind_executor(
+                    this->strand,
+                    [self = this->shared_from_this()](const boost::system::error_code &error, std::size_t bytes_sent) {
+                        self->send_queue.front().sent = bytes_sent;
+                        if (bytes_sent > 0)
+                        {
+                            self->last_write_time = NowTicks();
+                        }
+                        self->FinishFrontMessage(error);
+                    }
+                )
+            );
+        }, this->stream);
+    }
+
+    void ClientConnection::ContinueFileSend()
+    {
+        OutboundMessage &front = this->send_queue.front();
+
+#ifdef __linux__
+        if (!this->IsTls())
+        {
+            // sendfile Must Not Block The io_context Thread
+            boost::system::error_code error;
+            this->VisitLowestLayer([&](auto &socket) {
+                socket.native_non_blocking(true, error);
+            });
+
+            while (!error && front.sent < front.count)
+            {
+                off_t file_offset = static_cast<off_t>(front.offset + front.sent);
+                ssize_t bytes_sent = ::sendfile(this->native_handle, front.file_descriptor, &file_offset, front.count - front.sent);
+                if (bytes_sent > 0)
+                {
+                    front.sent += bytes_sent;
+                    this->last_write_time = NowTicks();
+                    this->write_waiting_since = this->last_write_time.load();
+                }
+                else if (bytes_sent == 0)
+                {
+                    // File Shrank Meanwhile
+                    break;
+                }
+                else if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    // Socket Buffer Full -> Continue When It Drains
+                    this->VisitLowestLayer([&](auto &socket) {
+                        socket.async_wait(
+                            boost::asio::socket_base::wait_write,
+                            boost::asio::bind_executor(this->strand, [self = this->shared_from_this()](const boost::system::error_code &wait_error) {
+                                if (wait_error)
+                                {
+                                    self->FinishFrontMessage(wait_error);
+                                    return;
+                                }
+                                self->ContinueFileSend();
+                            })
+                        );
+                    });
+                    return;
+                }
+                else if (errno != EINTR)
+                {
+                    error = boost::system::error_code(errno, boost::system::system_category());
+                }
+            }
+
+            this->FinishFrontMessage(error);
+            return;
+        }
+#endif
+
+        // Read The Next Block And Write It Through The Transport
+        std::size_t to_read = static_cast<std::size_t>(std::min<std::uint64_t>(FILE_BLOCK_SIZE, front.count - front.sent));
+        if (to_read == 0)
+        {
+            this->FinishFrontMessage(boost::system::error_code());
+            return;
+        }
+
+        std::shared_ptr<std::string> block = std::make_shared<std::string>(to_read, '\0');
+        ssize_t bytes_read;
+        do
+        {
+            bytes_read = ::pread(front.file_descriptor, &(*block)[0], to_read, static_cast<off_t>(front.offset + front.sent));
+        } while (bytes_read < 0 && errno == EINTR);
+
+        if (bytes_read <= 0)
+        {
+            // Read Error, Or The File Shrank Meanwhile
+            this->FinishFrontMessage(bytes_read < 0
+                ? boost::system::error_code(errno, boost::system::system_category())
+                : boost::system::error_code());
+            return;
+        }
+        block->resize(bytes_read);
+
+        std::visit([&](auto &transport) {
+            boost::asio::async_write(
+                transport,
+                boost::asio::buffer(*block),
+                boost::asio::bind_executor(
+                    this->strand,
+                    [self = this->shared_from_this(), block](const boost::system::error_code &error, std::size_t bytes_sent) {
+                        self->send_queue.front().sent += bytes_sent;
+                        self->last_write_time = NowTicks();
+                        self->write_waiting_since = self->last_write_time.load();
+                        if (error)
+                        {
+                            self->FinishFrontMessage(error);
+                            return;
+                        }
+                        self->ContinueFileSend();
+                    }
+                )
+            );
+        }, this->stream);
+    }
+
+    void ClientConnection::ContinueDescriptorSend()
+    {
+        OutboundMessage &front = this->send_queue.front();
+
+        // sendmsg Must Not Block The io_context Thread
+        boost::system::error_code error;
+        std::get<LocalSocket>(this->stream).native_non_blocking(true, error);
+
+        while (!error && front.sent < front.count)
+        {
+            iovec io_vector;
+            io_vector.iov_base = const_cast<char *>(front.data->data() + front.sent);
+            io_vector.iov_len = front.count - front.sent;
+
+            msghdr message{};
+            message.msg_iov = &io_vector;
+            message.msg_iovlen = 1;
+
+            // The Descriptors Ride On The First Byte Sent, Once
+            std::vector<char> control;
+            if (!front.descriptors.empty())
+            {
+                control.resize(CMSG_SPACE(sizeof(int) * front.descriptors.size()));
+                message.msg_control = control.data();
+                message.msg_controllen = control.size();
+
+                cmsghdr *rights = CMSG_FIRSTHDR(&message);
+                rights->cmsg_level = SOL_SOCKET;
+                rights->cmsg_type = SCM_RIGHTS;
+                rights->cmsg_len = CMSG_LEN(sizeof(int) * front.descriptors.size());
+                std::memcpy(CMSG_DATA(rights), front.descriptors.data(), sizeof(int) * front.descriptors.size());
+            }
+
+            ssize_t bytes_sent = ::sendmsg(this->native_handle, &message, MSG_NOSIGNAL);
+            if (bytes_sent > 0)
+            {
+                front.sent += bytes_sent;
+                front.descriptors.clear();
+                this->last_write_time = NowTicks();
+                this->write_waiting_since = this->last_write_time.load();
+            }
+            else if (bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                std::get<LocalSocket>(this->stream).async_wait(
+                    LocalSocket::wait_write,
+                    boost::asio::bind_executor(this->strand, [self = this->shared_from_this()](const boost::system::error_code &wait_error) {
+                        if (wait_error)
+                        {
+                            self->FinishFrontMessage(wait_error);
+                            return;
+                        }
+                        self->ContinueDescriptorSend();
+                    })
+                );
+                return;
+            }
+            else if (bytes_sent < 0 && errno != EINTR)
+            {
+                error = boost::system::error_code(errno, boost::system::system_category());
+            }
+        }
+
+        this->FinishFrontMessage(error);
+    }
+
+    void ClientConnection::FinishFrontMessage(const boost::system::error_code &error)
+    {
+        OutboundMessage finished = std::move(this->send_queue.front());
+        this->send_queue.pop_front();
+        this->ReleaseQueuedBytes(finished.accounted_bytes);
+
+        if (finished.on_sent)
+        {
+            finished.on_sent(error, static_cast<std::size_t>(finished.sent));
+        }
+
+        this->StartNextWrite();
+    }
+
+    /**
+     * @brief Drop queued messages that are not being written yet, oldest first, until the queue is under its high watermark \n
+     * Only messages of AsyncSend are dropped: parts of a reply and messages a producer waits on are always kept, as is the newest message
+     */
+    void ClientConnection::DropOldestOverHighWatermark()
+    {
+        std::size_t index = this->write_in_progress ? 1 : 0;
+        std::size_t dropped_messages = 0;
+        while (this->IsOverflowing() && index + 1 < this->send_queue.size())
+        {
+            if (!this->send_queue[index].is_droppable)
+            {
+                index++;
+                continue;
+            }
+
+            OutboundMessage dropped = std::move(this->send_queue[index]);
+            this->send_queue.erase(this->send_queue.begin() + index);
+            this->ReleaseQueuedBytes(dropped.accounted_bytes);
+            dropped_messages++;
+
+            if (dropped.on_sent)
+            {
+                dropped.on_sent(boost::asio::error::no_buffer_space, 0);
+            }
+        }
+
+        if (dropped_messages > 0)
+        {
+            std::cerr << "Send queue of " << this->remote_address << " overflowed, dropped "
+                      << dropped_messages << " oldest messages." << std::endl;
+        }
+    }
+
+    void ClientConnection::Close()
+    {
+        // Set Right Away, So Sends Racing The Close Are Rejected Instead Of Queued
+        this->is_closed = true;
+
+        // Only Shut Down: The Client Thread May Still Be In recv() Or poll() On native_handle, And A Closed
+        // Descriptor Number Could Be Reused By Another Client Meanwhile. The Socket Closes With The Connection
+        boost::asio::dispatch(this->strand, [self = this->shared_from_this()]() {
+            self->VisitLowestLayer([](auto &socket) {
+                boost::system::error_code error;
+                socket.shutdown(boost::asio::socket_base::shutdown_both, error);
+            });
+
+            // Messages Held For A Request That Never Ended Will Not Be Sent Either
+            std::deque<OutboundMessage> held_messages;
+            {
+                std::lock_guard<std::mutex> lock(self->request_mutex);
+                held_messages.swap(self->held_messages);
+                self->held_bytes = 0;
+                self->held_condition.notify_all();
+            }
+            for (OutboundMessage &held_message : held_messages)
+            {
+                if (held_message.on_sent)
+                {
+                    held_message.on_sent(boost::asio::error::not_connected, 0);
+                }
+            }
+
+            // Nobody Will Drain The Queue Anymore -> Wake Up Waiting Producers
+            self->NotifyWritable();
+        });
+    }
+
+    //* INFO: Send Queue Backpressure
+    void ClientConnection::ReserveQueuedBytes(std::size_t bytes)
+    {
+        this->queued_bytes += bytes;
+        if (this->memory_account)
+        {
+            this->memory_account->Add(bytes);
+        }
+    }
+
+    void ClientConnection::ReleaseQueuedBytes(std::size_t bytes)
+    {
+        if (bytes == 0)
+        {
+            return;
+        }
+
+        std::size_t remaining = this->queued_bytes -= bytes;
+        if (this->memory_account)
+        {
+            this->memory_account->Remove(bytes);
+        }
+
+        if (remaining <= this->send_limits.low_watermark)
+        {
+            this->NotifyWritable();
+        }
+    }
+
+    bool ClientConnection::IsOverflowing() const
+    {
+        std::size_t queued = this->queued_bytes;
+        if (queued >= this->send_limits.high_watermark)
+        {
+            return true;
+        }
+
+        // Server-Wide Memory Is Short -> Every Queue Still Over Its Low Watermark Must Give Way
+        return this->memory_account && this->memory_account->IsOverLimit() && queued > this->send_limits.low_watermark;
+    }
+
+    void ClientConnection::NotifyWritable()
+    {
+        {
+            // Pairs With The Predicate Check In WaitUntilWritable (No Lost Wake-Up)
+            std::lock_guard<std::mutex> lock(this->writable_mutex);
+        }
+        this->writable_condition.notify_all();
+
+        std::vector<std::function<void()>> waiters;
+        waiters.swap(this->writable_waiters);
+        for (std::function<void()> &waiter : waiters)
+        {
+            waiter();
+        }
+    }
+
+    bool ClientConnection::IsOnIoThread() const
+    {
+        return this->owner_io_context != nullptr && this->owner_io_context->get_executor().running_in_this_thread();
+    }
+
+    /**
+     * @brief Set the watermarks and overflow policy of the send queue \n
+     * Call before the first send, so every queued byte is counted in the same account
+     *
+     * @param send_limits the watermarks and the overflow policy
+     * @param memory_account the server-wide account this queue adds to (nullptr -> Only this queue's limits)
+     */
+    void ClientConnection::SetSendLimits(const SendQueueLimits &send_limits, std::shared_ptr<SendMemoryAccount> memory_account)
+    {
+        this->send_limits = send_limits;
+        this->memory_account = std::move(memory_account);
+    }
+
+    const SendQueueLimits &ClientConnection::GetSendLimits() const
+    {
+        return this->send_limits;
+    }
+
+    std::size_t ClientConnection::QueuedBytes() const
+    {
+        return this->queued_bytes;
+    }
+
+    bool ClientConnection::IsAboveHighWatermark() const
+    {
+        return this->queued_bytes >= this->send_limits.high_watermark;
+    }
+
+    bool ClientConnection::WaitUntilWritable(std::chrono::milliseconds timeout)
+    {
+        auto is_writable = [this]() {
+            return this->is_closed || this->queued_bytes <= this->send_limits.low_watermark;
+        };
+
+        std::unique_lock<std::mutex> lock(this->writable_mutex);
+        if (timeout == std::chrono::milliseconds::max())
+        {
+            this->writable_condition.wait(lock, is_writable);
+            return !this->is_closed;
+        }
+
+        return this->writable_condition.wait_for(lock, timeout, is_writable) && !this->is_closed;
+    }
+
+    void ClientConnection::AsyncWaitWritable(std::function<void()> handler)
+    {
+        boost::asio::post(this->strand, [self = this->shared_from_this(), handler = std::move(handler)]() mutable {
+            if (self->is_closed || self->queued_bytes <= self->send_limits.low_watermark)
+            {
+                handler();
+                return;
+            }
+            self->writable_waiters.push_back(std::move(handler));
+        });
+    }
+
+    bool ClientConnection::BeginRequest()
+    {
+        // Every Read Of A Request Lands Here, Only The First One Takes The Lock
+        if (this->request_state == RequestBusy)
+        {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(this->request_mutex);
+        int expected = RequestIdle;
+        if (this->request_state.compare_exchange_strong(expected, RequestBusy))
+        {
+            this->request_thread = std::this_thread::get_id();
+            return true;
+        }
+        return expected == RequestBusy;
+    }
+
+    void ClientConnection::EndRequest()
+    {
+        std::lock_guard<std::mutex> lock(this->request_mutex);
+        int expected = RequestBusy;
+        if (!this->request_state.compare_exchange_strong(expected, RequestIdle))
+        {
+            return;
+        }
+
+        // The Reply Is Fully Queued: What Was Held Goes Behind It, Before Any Next Request Can Start
+        for (OutboundMessage &held_message : this->held_messages)
+        {
+            this->ReserveQueuedBytes(held_message.accounted_bytes);
+            this->PostAsyncMessage(std::move(held_message));
+        }
+        this->held_messages.clear();
+        this->held_bytes = 0;
+        this->held_condition.notify_all();
+    }
+
+    bool ClientConnection::MarkClosing()
+    {
+        int expected = RequestIdle;
+        return this->request_state.compare_exchange_strong(expected, RequestClosing);
+    }
+
+    int ClientConnection::NativeHandle() const
+    {
+        return this->native_handle;
+    }
+
+    RequestState ClientConnection::GetRequestState() const
+    {
+        return static_cast<RequestState>(this->request_state.load());
+    }
+
+    const std::string &ClientConnection::RemoteAddress() const
+    {
+        return this->remote_address;
+    }
+
+    std::chrono::steady_clock::time_point ClientConnection::ReadWaitingSince() const
+    {
+        return FromTicks(this->read_waiting_since);
+    }
+
+    std::chrono::steady_clock::time_point ClientConnection::WriteWaitingSince() const
+    {
+        return FromTicks(this->write_waiting_since);
+    }
+
+    std::chrono::steady_clock::time_point ClientConnection::LastWriteTime() const
+    {
+        return FromTicks(this->last_write_time);
+    }
+}
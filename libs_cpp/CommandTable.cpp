@@ -0,0 +1,70 @@
+#include "../include/CommandTable.h"
+#include <algorithm>
+
+namespace SN_Server
+{
+    /**
+     * @brief Find a seed that puts every name in its own slot \n
+     * Tries a few thousand seeds per table size, then doubles the slots (Rarely needed at twice the names)
+     *
+     * @param names the names to look up, index i of Find() is names[i]
+     */
+    void CommandTable::Build(const std::vector<std::string> &names)
+    {
+        this->names = names;
+
+        std::size_t slot_count = CommandSlotCount(names.size());
+        while (true)
+        {
+            this->slots.assign(slot_count, 0);
+            this->slot_mask = slot_count - 1;
+
+            for (this->seed = 0; this->seed < 4096; this->seed++)
+            {
+                std::fill(this->slots.begin(), this->slots.end(), 0);
+
+                bool is_perfect = true;
+                for (std::size_t index = 0; index < this->names.size() && is_perfect; index++)
+                {
+                    std::size_t &slot = this->slots[CommandHash(this->names[index], this->seed) & this->slot_mask];
+                    if (slot == 0)
+                    {
+                        slot = index + 1;
+                    }
+                    else if (this->names[slot - 1] != this->names[index])
+                    {
+                        is_perfect = false;
+                    }
+                    // Same Name Again: The First One Keeps The Slot
+                }
+
+                if (is_perfect)
+                {
+                    return;
+                }
+            }
+
+            slot_count <<= 1;
+        }
+    }
+
+    std::size_t CommandTable::Find(std::string_view name) const
+    {
+        if (this->names.empty())
+        {
+            return NOT_FOUND;
+        }
+
+        std::size_t slot = this->slots[CommandHash(name, this->seed) & this->slot_mask];
+        if (slot != 0 && this->names[slot - 1] == name)
+        {
+            return slot - 1;
+        }
+        return NOT_FOUND;
+    }
+
+    std::size_t CommandTable::Size() const
+    {
+        return this->names.size();
+    }
+}
@@ -0,0 +1,257 @@
+#include "../include/ContentStore.h"
+#include <boost/filesystem.hpp>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+namespace SN_Server
+{
+    namespace
+    {
+        // Bytes Read Per Step When Copying A Passed File
+        constexpr std::size_t COPY_BLOCK_SIZE = 256 * 1024;
+    }
+
+    //* INFO: ContentStore::Writer
+    ContentStore::Writer::Writer(ContentStore *store, std::string staging_file)
+        : store(store), staging_file(std::move(staging_file))
+    {
+        this->staging_stream.open(this->staging_file, std::ios::binary | std::ios::trunc);
+    }
+
+    ContentStore::Writer::~Writer()
+    {
+        if (!this->finished)
+        {
+            this->Abort();
+        }
+    }
+
+    bool ContentStore::Writer::IsOpen() const
+    {
+        return this->staging_stream.is_open();
+    }
+
+    void ContentStore::Writer::Write(const void *data, std::size_t size)
+    {
+        this->digest.Update(data, size);
+        this->staging_stream.write(static_cast<const char *>(data), size);
+        this->total_written += size;
+    }
+
+    /**
+     * @brief Store a file the client already has open (e.g. passed over a Unix domain socket) \n
+     * It is read with pread, so the client's own file offset is left alone
+     *
+     * @param file_descriptor the file to copy (Not closed here)
+     * @return true if it was read to its end
+     */
+    bool ContentStore::Writer::WriteFromDescriptor(int file_descriptor)
+    {
+        std::vector<char> block(COPY_BLOCK_SIZE);
+        off_t offset = 0;
+        while (true)
+        {
+            ssize_t bytes_read = ::pread(file_descriptor, block.data(), block.size(), offset);
+            if (bytes_read < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (bytes_read < 0)
+            {
+                std::cerr << "Error: Unable to read passed file: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            if (bytes_read == 0)
+            {
+                return true;
+            }
+
+            this->Write(block.data(), static_cast<std::size_t>(bytes_read));
+            offset += bytes_read;
+        }
+    }
+
+    std::uint64_t ContentStore::Writer::TotalWritten() const
+    {
+        return this->total_written;
+    }
+
+    /**
+     * @brief Finish the upload and move it under its digest \n
+     * If the store already has the same content, the staging copy is removed (Deduplicated)
+     *
+     * @return std::string the digest of the content, empty if it could not be stored
+     */
+    std::string ContentStore::Writer::Commit()
+    {
+        this->finished = true;
+        this->staging_stream.close();
+
+        if (this->staging_stream.fail())
+        {
+            std::cerr << "Error: Unable to write staging file " << this->staging_file << std::endl;
+            std::remove(this->staging_file.c_str());
+            return "";
+        }
+
+        std::string final_digest = this->digest.FinalHex();
+        boost::filesystem::path object_path = this->store->ObjectPath(final_digest);
+
+        boost::system::error_code error;
+        if (boost::filesystem::exists(object_path, error))
+        {
+            // Already Stored -> Drop The Duplicate
+            std::cout << "Content " << final_digest << " already stored, dropping duplicate." << std::endl;
+            std::remove(this->staging_file.c_str());
+            return final_digest;
+        }
+
+        boost::filesystem::create_directories(object_path.parent_path(), error);
+        boost::filesystem::rename(this->staging_file, object_path, error);
+        if (error)
+        {
+            std::cerr << "Error: Unable to store object " << final_digest << ": " << error.message() << std::endl;
+            std::remove(this->staging_file.c_str());
+            return "";
+        }
+
+        // Objects Are Shared Through Hard Links -> Never Modify Them In Place
+        boost::filesystem::permissions(
+            object_path,
+            boost::filesystem::owner_read | boost::filesystem::group_read | boost::filesystem::others_read,
+            error
+        );
+
+        return final_digest;
+    }
+
+    void ContentStore::Writer::Abort()
+    {
+        this->finished = true;
+        if (this->staging_stream.is_open())
+        {
+            this->staging_stream.close();
+        }
+        std::remove(this->staging_file.c_str());
+    }
+
+    //* INFO: ContentStore
+    /**
+     * @brief Construct a new Content Store object
+     *
+     * @param root_directory the directory that keeps the objects and staging files
+     */
+    ContentStore::ContentStore(std::string_view root_directory)
+        : root_directory(root_directory), staging_counter(0)
+    {
+        boost::system::error_code error;
+        boost::filesystem::create_directories(boost::filesystem::path(this->root_directory) / "objects", error);
+        boost::filesystem::create_directories(boost::filesystem::path(this->root_directory) / "staging", error);
+        if (error)
+        {
+            std::cerr << "Error: Unable to create content store " << this->root_directory << ": " << error.message() << std::endl;
+        }
+    }
+
+    bool ContentStore::IsValidDigest(std::string_view digest)
+    {
+        if (digest.size() != 64)
+        {
+            return false;
+        }
+
+        for (char character : digest)
+        {
+            bool is_hex = (character >= '0' && character <= '9') || (character >= 'a' && character <= 'f');
+            if (!is_hex)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::string_view ContentStore::GetRootDirectory() const
+    {
+        return this->root_directory;
+    }
+
+    std::string ContentStore::ObjectPath(std::string_view digest) const
+    {
+        boost::filesystem::path object_path = boost::filesystem::path(this->root_directory) / "objects" /
+                                              std::string(digest.substr(0, 2)) / std::string(digest);
+        return object_path.string();
+    }
+
+    bool ContentStore::Contains(std::string_view digest) const
+    {
+        if (!IsValidDigest(digest))
+        {
+            return false;
+        }
+
+        boost::system::error_code error;
+        return boost::filesystem::exists(this->ObjectPath(digest), error);
+    }
+
+    ContentStore::Writer ContentStore::BeginWrite()
+    {
+        boost::filesystem::path staging_file = boost::filesystem::path(this->root_directory) / "staging" /
+                                               (std::to_string(getpid()) + "-" + std::to_string(this->staging_counter++));
+        return Writer(this, staging_file.string());
+    }
+
+    /**
+     * @brief Put the stored object at destination without rewriting its bytes \n
+     * The link is made beside the destination and renamed over it, so readers never see a half file
+     *
+     * @param digest the digest of the stored object
+     * @param destination where the file should appear
+     * @return true if the destination now has the content
+     */
+    bool ContentStore::LinkInto(std::string_view digest, const std::string &destination) const
+    {
+        if (!this->Contains(digest))
+        {
+            return false;
+        }
+
+        boost::filesystem::path object_path = this->ObjectPath(digest);
+        boost::filesystem::path link_path = destination + ".link-" + std::string(digest.substr(0, 8));
+
+        // Already Linked There (rename() Would Do Nothing For The Same File)
+        boost::system::error_code error;
+        if (boost::filesystem::exists(destination, error) && boost::filesystem::equivalent(object_path, destination, error))
+        {
+            return true;
+        }
+
+        boost::filesystem::remove(link_path, error);
+        boost::filesystem::create_hard_link(object_path, link_path, error);
+        if (error)
+        {
+            // Different Filesystem Or No Hard-Link Support -> Copy Instead
+            error.clear();
+            boost::filesystem::copy_file(object_path, link_path, boost::filesystem::copy_option::overwrite_if_exists, error);
+            if (error)
+            {
+                std::cerr << "Error: Unable to place " << digest << " at " << destination << ": " << error.message() << std::endl;
+                return false;
+            }
+        }
+
+        boost::filesystem::rename(link_path, destination, error);
+        if (error)
+        {
+            std::cerr << "Error: Unable to place " << digest << " at " << destination << ": " << error.message() << std::endl;
+            boost::filesystem::remove(link_path, error);
+            return false;
+        }
+
+        return true;
+    }
+}
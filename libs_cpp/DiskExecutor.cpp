@@ -0,0 +1,735 @@
+#include "../include/DiskExecutor.h"
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SN_Server
+{
+    //* INFO: Aligned Blocks
+    //*========================================================
+    AlignedBlock::AlignedBlock(std::size_t capacity)
+        : capacity((std::max<std::size_t>(capacity, 1) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT)
+    {
+        this->data = static_cast<char *>(std::aligned_alloc(ALIGNMENT, this->capacity));
+        if (this->data == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+    }
+
+    AlignedBlock::~AlignedBlock()
+    {
+        std::free(this->data);
+    }
+
+    AlignedBufferPool::AlignedBufferPool(std::size_t max_pooled_blocks)
+        : max_pooled_blocks(max_pooled_blocks)
+    {
+    }
+
+    std::unique_ptr<AlignedBlock> AlignedBufferPool::Acquire(std::size_t capacity)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->free_blocks_mutex);
+            for (std::size_t index = this->free_blocks.size(); index > 0; index--)
+            {
+                if (this->free_blocks[index - 1]->capacity >= capacity)
+                {
+                    std::unique_ptr<AlignedBlock> block = std::move(this->free_blocks[index - 1]);
+                    this->free_blocks.erase(this->free_blocks.begin() + (index - 1));
+                    return block;
+                }
+            }
+        }
+
+        return std::make_unique<AlignedBlock>(capacity);
+    }
+
+    void AlignedBufferPool::Release(std::unique_ptr<AlignedBlock> block)
+    {
+        if (!block)
+        {
+            return;
+        }
+
+        block->size = 0;
+
+        std::lock_guard<std::mutex> lock(this->free_blocks_mutex);
+        if (this->free_blocks.size() < this->max_pooled_blocks)
+        {
+            this->free_blocks.push_back(std::move(block));
+        }
+    }
+
+    //* INFO: Disk Worker
+    //*========================================================
+    class DiskWorker
+    {
+    private:
+        std::mutex ready_mutex;
+        std::condition_variable wake;
+        std::deque<std::shared_ptr<DiskStream>> ready_streams;
+        bool is_stopping = false;
+        std::thread thread;
+
+        void Run()
+        {
+            while (true)
+            {
+                std::shared_ptr<DiskStream> stream;
+                {
+                    std::unique_lock<std::mutex> lock(this->ready_mutex);
+                    this->wake.wait(lock, [this]() {
+                        return !this->ready_streams.empty() || this->is_stopping;
+                    });
+
+                    // Streams Already Handed Over Are Still Served Before Stopping
+                    if (this->ready_streams.empty())
+                    {
+                        return;
+                    }
+
+                    stream = std::move(this->ready_streams.front());
+                    this->ready_streams.pop_front();
+                }
+
+                stream->RunScheduled();
+            }
+        }
+
+    public:
+        DiskWorker()
+        {
+            this->thread = std::thread([this]() {
+                this->Run();
+            });
+        }
+
+        void Post(std::shared_ptr<DiskStream> stream)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->ready_mutex);
+                if (!this->is_stopping)
+                {
+                    this->ready_streams.push_back(std::move(stream));
+                    this->wake.notify_one();
+                    return;
+                }
+            }
+
+            // The Thread Is Gone: Do The Work Here
+            stream->RunScheduled();
+        }
+
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->ready_mutex);
+                this->is_stopping = true;
+            }
+            this->wake.notify_one();
+
+            if (this->thread.joinable())
+            {
+                this->thread.join();
+            }
+        }
+    };
+
+    //* INFO: Disk Stream
+    //*========================================================
+    DiskStream::DiskStream(std::shared_ptr<DiskWorker> worker, int descriptor)
+        : worker(std::move(worker)), descriptor(descriptor)
+    {
+    }
+
+    DiskStream::~DiskStream()
+    {
+        if (this->descriptor >= 0)
+        {
+            ::close(this->descriptor);
+        }
+    }
+
+    void DiskStream::Schedule()
+    {
+        if (!this->is_scheduled.exchange(true))
+        {
+            this->worker->Post(this->shared_from_this());
+        }
+    }
+
+    /**
+     * @brief Run the stream's disk work on its disk thread \n
+     * Work handed over while it ran (Schedule() saw it scheduled and left it) is picked up before letting go
+     */
+    void DiskStream::RunScheduled()
+    {
+        do
+        {
+            this->RunOnDisk();
+            this->is_scheduled.store(false);
+        } while (this->HasDiskWork() && !this->is_scheduled.exchange(true));
+    }
+
+    void DiskStream::NotifyProgress()
+    {
+        // Taking The Lock Orders The Change Before A Waiter's Check Of It
+        {
+            std::lock_guard<std::mutex> lock(this->progress_mutex);
+        }
+        this->progress.notify_all();
+    }
+
+    bool DiskStream::HasFailed() const
+    {
+        return this->error_number.load() != 0;
+    }
+
+    //* INFO: Disk Writer
+    //*========================================================
+    DiskWriter::DiskWriter(
+        std::shared_ptr<DiskWorker> worker,
+        int descriptor,
+        const std::string &path,
+        std::shared_ptr<AlignedBufferPool> aligned_blocks,
+        std::size_t queue_depth,
+        std::size_t block_size,
+        std::uint64_t preallocated_bytes,
+        const DirectIoOptions &direct_io,
+        std::uint64_t start_offset
+    )
+        : DiskStream(std::move(worker), descriptor),
+          path(path),
+          block_size(block_size),
+          aligned_blocks(std::move(aligned_blocks)),
+          blocks(queue_depth),
+          preallocated_bytes(preallocated_bytes),
+          start_offset(start_offset),
+          direct_io(direct_io)
+    {
+    }
+
+    DiskWriter::~DiskWriter()
+    {
+        // Nothing Can Still Be Running: The Disk Thread Holds A Reference While It Works
+        if (this->current_block)
+        {
+            this->aligned_blocks->Release(std::move(this->current_block));
+        }
+
+        if (this->direct_descriptor >= 0)
+        {
+            ::close(this->direct_descriptor);
+        }
+    }
+
+    /**
+     * @brief Copy data into the current block, handing every full block to the disk thread
+     *
+     * @param data the bytes to append to the file
+     * @return true unless a write already failed (The data is then dropped)
+     */
+    bool DiskWriter::Write(std::string_view data)
+    {
+        if (this->HasFailed())
+        {
+            return false;
+        }
+
+        while (!data.empty())
+        {
+            if (!this->current_block)
+            {
+                this->current_block = this->aligned_blocks->Acquire(this->block_size);
+            }
+
+            std::size_t room = this->block_size - this->current_block->size;
+            std::size_t taken = std::min(room, data.size());
+            std::memcpy(this->current_block->data + this->current_block->size, data.data(), taken);
+            this->current_block->size += taken;
+            data.remove_prefix(taken);
+
+            if (this->current_block->size >= this->block_size)
+            {
+                this->PushBlock();
+            }
+        }
+
+        return true;
+    }
+
+    void DiskWriter::PushBlock()
+    {
+        // Counted First, So The Disk Thread Never Counts Below Zero
+        this->queued_blocks++;
+
+        while (!this->blocks.TryPush(this->current_block))
+        {
+            // The Disk Is Behind: Wait For A Free Slot (This Is What Holds The Sender Back)
+            std::unique_lock<std::mutex> lock(this->progress_mutex);
+            this->progress.wait(lock, [this]() {
+                return !this->blocks.IsFull();
+            });
+        }
+
+        this->Schedule();
+    }
+
+    /**
+     * @brief Hand over the last block and wait until the disk thread has written everything
+     *
+     * @return true if every byte reached the file and it closed cleanly
+     */
+    bool DiskWriter::Finish()
+    {
+        if (this->current_block && this->current_block->size > 0)
+        {
+            this->PushBlock();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(this->progress_mutex);
+            this->progress.wait(lock, [this]() {
+                return this->queued_blocks.load() == 0;
+            });
+        }
+
+        if (this->descriptor >= 0)
+        {
+            // Give Back The Reserved Blocks Past The End (Sent Short, Or A Write Failed)
+            if (this->written_bytes < this->preallocated_bytes && ::ftruncate(this->descriptor, static_cast<off_t>(this->written_bytes)) != 0 && this->error_number.load() == 0)
+            {
+                this->error_number.store(errno);
+            }
+
+            if (::close(this->descriptor) != 0 && this->error_number.load() == 0)
+            {
+                this->error_number.store(errno);
+            }
+            this->descriptor = -1;
+        }
+
+        if (this->direct_descriptor >= 0)
+        {
+            ::close(this->direct_descriptor);
+            this->direct_descriptor = -1;
+        }
+
+        return !this->HasFailed();
+    }
+
+    std::uint64_t DiskWriter::BytesWritten() const
+    {
+        return this->written_bytes;
+    }
+
+    std::uint64_t DiskWriter::DirectBytesWritten() const
+    {
+        return this->direct_bytes.load();
+    }
+
+    /**
+     * @brief Decide whether a block goes through O_DIRECT (On the disk thread) \n
+     * Only full blocks at aligned offsets can, so the tail of the file always goes through the page cache \n
+     * The O_DIRECT descriptor is opened the first time; a filesystem refusing it keeps the writer buffered
+     *
+     * @param block the next block
+     * @param offset where it is written
+     * @return true to write it with direct_descriptor
+     */
+    bool DiskWriter::UseDirectIo(const AlignedBlock &block, std::uint64_t offset)
+    {
+        if (this->is_direct_unavailable || this->direct_io.threshold_bytes == 0)
+        {
+            return false;
+        }
+
+        if (block.size % AlignedBlock::ALIGNMENT != 0 || offset % AlignedBlock::ALIGNMENT != 0)
+        {
+            return false;
+        }
+
+        if (this->direct_descriptor < 0)
+        {
+            bool is_large = this->preallocated_bytes >= this->direct_io.threshold_bytes || offset >= this->direct_io.threshold_bytes;
+            if (!is_large)
+            {
+                return false;
+            }
+
+            this->direct_descriptor = ::open(this->path.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+            if (this->direct_descriptor < 0)
+            {
+                std::cerr << "Error: No direct I/O for " << this->path << " (" << std::strerror(errno) << "), writing through the page cache" << std::endl;
+                this->is_direct_unavailable = true;
+                return false;
+            }
+
+            // Written Through The Page Cache So Far -> Flush Those Pages And Let Them Go Too (A Length Of 0 Would Mean "To The End")
+            if (offset > this->start_offset)
+            {
+                off_t written_length = static_cast<off_t>(offset - this->start_offset);
+                ::sync_file_range(this->descriptor, static_cast<off_t>(this->start_offset), written_length, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+                ::posix_fadvise(this->descriptor, static_cast<off_t>(this->start_offset), written_length, POSIX_FADV_DONTNEED);
+            }
+        }
+
+        return true;
+    }
+
+    bool DiskWriter::HasDiskWork() const
+    {
+        return !this->blocks.IsEmpty();
+    }
+
+    void DiskWriter::RunOnDisk()
+    {
+        std::unique_ptr<AlignedBlock> block;
+        while (this->blocks.TryPop(block))
+        {
+            // After A Failure The Blocks Are Only Dropped (Write() Already Reports It)
+            bool is_direct = !this->HasFailed() && this->UseDirectIo(*block, this->start_offset + this->written_bytes);
+
+            std::size_t offset = 0;
+            while (!this->HasFailed() && offset < block->size)
+            {
+                int target = is_direct ? this->direct_descriptor : this->descriptor;
+                ssize_t bytes_written = ::pwrite(target, block->data + offset, block->size - offset, static_cast<off_t>(this->start_offset + this->written_bytes));
+                if (bytes_written > 0 && is_direct && static_cast<std::size_t>(bytes_written) % AlignedBlock::ALIGNMENT != 0)
+                {
+                    // A Short Direct Write Leaves An Unaligned Rest: Finish The Block Through The Page Cache
+                    is_direct = false;
+                }
+                if (bytes_written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (is_direct && errno == EINVAL)
+                    {
+                        // The Device Wants Another Alignment -> Stay Buffered From Now On
+                        std::cerr << "Error: Direct write refused for " << this->path << ", writing through the page cache" << std::endl;
+                        this->is_direct_unavailable = true;
+                        is_direct = false;
+                        continue;
+                    }
+                    this->error_number.store(errno);
+                    std::cerr << "Error: Disk write failed after " << this->written_bytes << " bytes: " << std::strerror(errno) << std::endl;
+                    break;
+                }
+                offset += static_cast<std::size_t>(bytes_written);
+                this->written_bytes += static_cast<std::uint64_t>(bytes_written);
+                if (target == this->direct_descriptor)
+                {
+                    this->direct_bytes += static_cast<std::uint64_t>(bytes_written);
+                }
+            }
+
+            this->aligned_blocks->Release(std::move(block));
+            this->queued_blocks--;
+            this->NotifyProgress();
+        }
+    }
+
+    //* INFO: Disk Reader
+    //*========================================================
+    DiskReader::DiskReader(
+        std::shared_ptr<DiskWorker> worker,
+        int descriptor,
+        std::shared_ptr<BufferPool> buffers,
+        std::size_t queue_depth,
+        std::size_t block_size,
+        std::uint64_t file_size,
+        std::uint64_t start_offset,
+        std::uint64_t end_offset
+    )
+        : DiskStream(std::move(worker), descriptor),
+          buffers(std::move(buffers)),
+          blocks(queue_depth),
+          block_size(block_size),
+          file_size(file_size),
+          read_offset(start_offset),
+          end_offset(std::min(end_offset, file_size))
+    {
+        if (this->read_offset >= this->end_offset)
+        {
+            this->is_at_end.store(true);
+        }
+    }
+
+    /**
+     * @brief Take the next block read ahead by the disk thread (Starting the read-ahead on the first call)
+     *
+     * @param block set to the next block of the file (Hand it back with Release)
+     * @return false at the end of the file or after a read error (See HasFailed)
+     */
+    bool DiskReader::Read(std::unique_ptr<std::string> &block)
+    {
+        while (true)
+        {
+            if (this->blocks.TryPop(block))
+            {
+                // Room Was Made -> Let The Disk Thread Read Further Ahead
+                if (!this->is_at_end.load())
+                {
+                    this->Schedule();
+                }
+                return true;
+            }
+
+            // Blocks Are Queued Before The End Is Marked, So Look Once More
+            if (this->is_at_end.load())
+            {
+                return this->blocks.TryPop(block);
+            }
+
+            this->Schedule();
+
+            std::unique_lock<std::mutex> lock(this->progress_mutex);
+            this->progress.wait(lock, [this]() {
+                return !this->blocks.IsEmpty() || this->is_at_end.load();
+            });
+        }
+    }
+
+    void DiskReader::Release(std::unique_ptr<std::string> block)
+    {
+        this->buffers->Release(std::move(block));
+    }
+
+    std::uint64_t DiskReader::FileSize() const
+    {
+        return this->file_size;
+    }
+
+    bool DiskReader::HasDiskWork() const
+    {
+        return !this->is_at_end.load() && !this->blocks.IsFull();
+    }
+
+    void DiskReader::RunOnDisk()
+    {
+        while (!this->is_at_end.load() && !this->blocks.IsFull())
+        {
+            std::unique_ptr<std::string> block = this->buffers->Acquire();
+            std::size_t wanted = static_cast<std::size_t>(std::min<std::uint64_t>(this->block_size, this->end_offset - this->read_offset));
+            block->resize(wanted);
+
+            // A Whole Block Unless The File Ends (Short Reads Are Continued)
+            std::size_t filled = 0;
+            while (filled < wanted)
+            {
+                ssize_t bytes_read = ::pread(this->descriptor, &(*block)[filled], wanted - filled, static_cast<off_t>(this->read_offset + filled));
+                if (bytes_read < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (bytes_read < 0)
+                {
+                    this->error_number.store(errno);
+                    std::cerr << "Error: Disk read failed at " << this->read_offset + filled << ": " << std::strerror(errno) << std::endl;
+                    break;
+                }
+                if (bytes_read == 0)
+                {
+                    // The File Shrank Since It Was Opened
+                    break;
+                }
+                filled += static_cast<std::size_t>(bytes_read);
+            }
+
+            block->resize(filled);
+            this->read_offset += filled;
+            if (filled > 0)
+            {
+                this->blocks.TryPush(block);
+            }
+            else
+            {
+                this->buffers->Release(std::move(block));
+            }
+
+            if (filled < wanted || this->read_offset >= this->end_offset)
+            {
+                this->is_at_end.store(true);
+            }
+            this->NotifyProgress();
+        }
+    }
+
+    //* INFO: Disk Executor
+    //*========================================================
+    /**
+     * @brief Start the disk threads
+     *
+     * @param thread_count how many disk threads (At least one)
+     * @param queue_depth blocks a stream may have in flight between its network thread and its disk thread
+     */
+    DiskExecutor::DiskExecutor(std::size_t thread_count, std::size_t queue_depth)
+        : queue_depth(std::max<std::size_t>(queue_depth, 2))
+    {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+
+        // Enough Idle Blocks For Every Queue Being Full Once
+        this->buffers = std::make_shared<BufferPool>(thread_count * this->queue_depth * 2, 4 * 1024 * 1024);
+        this->aligned_blocks = std::make_shared<AlignedBufferPool>(thread_count * this->queue_depth * 2);
+
+        for (std::size_t worker = 0; worker < thread_count; worker++)
+        {
+            this->workers.push_back(std::make_shared<DiskWorker>());
+        }
+    }
+
+    DiskExecutor::~DiskExecutor()
+    {
+        for (std::shared_ptr<DiskWorker> &worker : this->workers)
+        {
+            worker->Stop();
+        }
+    }
+
+    /**
+     * @brief Change when writers opened from now on switch to O_DIRECT \n
+     * Default: files of 1 GiB and more
+     *
+     * @param direct_io the size threshold (0 turns direct I/O off)
+     */
+    void DiskExecutor::SetDirectIoOptions(const DirectIoOptions &direct_io)
+    {
+        std::lock_guard<std::mutex> lock(this->direct_io_mutex);
+        this->direct_io = direct_io;
+    }
+
+    DirectIoOptions DiskExecutor::GetDirectIoOptions()
+    {
+        std::lock_guard<std::mutex> lock(this->direct_io_mutex);
+        return this->direct_io;
+    }
+
+    std::shared_ptr<DiskWorker> DiskExecutor::PickWorker()
+    {
+        return this->workers[this->next_worker++ % this->workers.size()];
+    }
+
+    /**
+     * @brief Open a file to be written by a disk thread
+     *
+     * @param path the file (Created or truncated)
+     * @param block_size bytes gathered before a block is handed to the disk thread
+     * @param preallocate_bytes the final size when known: its blocks are reserved in one extent before anything is written
+     * @return std::shared_ptr<DiskWriter> nullptr if the file cannot be opened or the disk has no room for it
+     */
+    std::shared_ptr<DiskWriter> DiskExecutor::OpenWriter(const std::string &path, std::size_t block_size, std::uint64_t preallocate_bytes)
+    {
+        int descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (descriptor < 0)
+        {
+            std::cerr << "Error: Unable to open " << path << " for writing: " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        if (preallocate_bytes > 0 && ::fallocate(descriptor, 0, 0, static_cast<off_t>(preallocate_bytes)) != 0)
+        {
+            // A Filesystem Without fallocate() Still Works, Just Without The Single Extent
+            if (errno != EOPNOTSUPP && errno != ENOSYS)
+            {
+                std::cerr << "Error: Unable to reserve " << preallocate_bytes << " bytes for " << path << ": " << std::strerror(errno) << std::endl;
+                ::close(descriptor);
+                return nullptr;
+            }
+            preallocate_bytes = 0;
+        }
+
+        return std::make_shared<DiskWriter>(
+            this->PickWorker(), descriptor, path, this->aligned_blocks, this->queue_depth,
+            (std::max<std::size_t>(block_size, 1) + AlignedBlock::ALIGNMENT - 1) / AlignedBlock::ALIGNMENT * AlignedBlock::ALIGNMENT,
+            preallocate_bytes, this->GetDirectIoOptions()
+        );
+    }
+
+    /**
+     * @brief Open a file that already has its size to write one range of it \n
+     * Nothing is created, truncated or reserved: that was done once for the whole file
+     *
+     * @param path the file
+     * @param offset where the first byte written goes
+     * @param block_size bytes gathered before a block is handed to the disk thread
+     * @return std::shared_ptr<DiskWriter> nullptr if the file cannot be opened
+     */
+    std::shared_ptr<DiskWriter> DiskExecutor::OpenRangeWriter(const std::string &path, std::uint64_t offset, std::size_t block_size)
+    {
+        int descriptor = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (descriptor < 0)
+        {
+            std::cerr << "Error: Unable to open " << path << " for writing: " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        return std::make_shared<DiskWriter>(
+            this->PickWorker(), descriptor, path, this->aligned_blocks, this->queue_depth,
+            (std::max<std::size_t>(block_size, 1) + AlignedBlock::ALIGNMENT - 1) / AlignedBlock::ALIGNMENT * AlignedBlock::ALIGNMENT,
+            0, this->GetDirectIoOptions(), offset
+        );
+    }
+
+    /**
+     * @brief Open a file to be read ahead by a disk thread
+     *
+     * @param path the file
+     * @param block_size bytes per block handed to the reader
+     * @param offset where reading starts
+     * @param length how many bytes to read at most (The rest of the file by default)
+     * @return std::shared_ptr<DiskReader> nullptr if the file cannot be opened
+     */
+    std::shared_ptr<DiskReader> DiskExecutor::OpenReader(const std::string &path, std::size_t block_size, std::uint64_t offset, std::uint64_t length)
+    {
+        int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0)
+        {
+            std::cerr << "Error: Unable to open " << path << " for reading: " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+        return this->AdoptReader(descriptor, block_size, offset, length);
+    }
+
+    std::shared_ptr<DiskReader> DiskExecutor::OpenReader(int descriptor, std::size_t block_size, std::uint64_t offset, std::uint64_t length)
+    {
+        int reader_descriptor = ::fcntl(descriptor, F_DUPFD_CLOEXEC, 0);
+        if (reader_descriptor < 0)
+        {
+            std::cerr << "Error: Unable to duplicate a descriptor for reading: " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+        return this->AdoptReader(reader_descriptor, block_size, offset, length);
+    }
+
+    std::shared_ptr<DiskReader> DiskExecutor::AdoptReader(int descriptor, std::size_t block_size, std::uint64_t offset, std::uint64_t length)
+    {
+        struct stat file_status;
+        if (::fstat(descriptor, &file_status) != 0)
+        {
+            std::cerr << "Error: Unable to read descriptor " << descriptor << ": " << std::strerror(errno) << std::endl;
+            ::close(descriptor);
+            return nullptr;
+        }
+
+        return std::make_shared<DiskReader>(
+            this->PickWorker(), descriptor, this->buffers, this->queue_depth,
+            std::max<std::size_t>(block_size, 1), static_cast<std::uint64_t>(file_status.st_size),
+            offset, length > UINT64_MAX - offset ? UINT64_MAX : offset + length
+        );
+    }
+
+    std::size_t DiskExecutor::ThreadCount() const
+    {
+        return this->workers.size();
+    }
+}
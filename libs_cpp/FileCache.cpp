@@ -0,0 +1,335 @@
+#include "../include/FileCache.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SN_Server
+{
+    namespace
+    {
+        // Share Of The Budget For Files Seen Once (S3-FIFO's Small Queue)
+        constexpr std::size_t SMALL_QUEUE_PERCENT = 10;
+
+        // Highest Frequency Counted, So A File Hot Long Ago Drains Out In A Few Passes
+        constexpr std::uint8_t MAX_FREQUENCY = 3;
+
+        bool StatIdentity(int descriptor, FileIdentity &identity)
+        {
+            struct stat file_status;
+            if (::fstat(descriptor, &file_status) != 0 || !S_ISREG(file_status.st_mode))
+            {
+                return false;
+            }
+
+            identity.device = static_cast<std::uint64_t>(file_status.st_dev);
+            identity.inode = static_cast<std::uint64_t>(file_status.st_ino);
+            identity.size = static_cast<std::uint64_t>(file_status.st_size);
+            identity.modified_ns = static_cast<std::int64_t>(file_status.st_mtim.tv_sec) * 1000000000 + file_status.st_mtim.tv_nsec;
+            identity.changed_ns = static_cast<std::int64_t>(file_status.st_ctim.tv_sec) * 1000000000 + file_status.st_ctim.tv_nsec;
+            return true;
+        }
+
+        // The Whole File, Or False If It Came Short (Read Error Or Truncated Meanwhile)
+        bool ReadWhole(int descriptor, std::string &contents)
+        {
+            std::size_t filled = 0;
+            while (filled < contents.size())
+            {
+                ssize_t bytes_read = ::pread(descriptor, &contents[filled], contents.size() - filled, static_cast<off_t>(filled));
+                if (bytes_read < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (bytes_read <= 0)
+                {
+                    return false;
+                }
+                filled += static_cast<std::size_t>(bytes_read);
+            }
+            return true;
+        }
+    }
+
+    FileCache::FileCache(std::size_t capacity_bytes, FileTransform transform)
+        : capacity_bytes(capacity_bytes), transform(std::move(transform))
+    {
+    }
+
+    /**
+     * @brief Get the contents of a file, from memory while the file is unchanged \n
+     * One stat per call decides whether the cached buffer is still the file (device, inode, size, mtime, ctime) \n
+     * A miss reads the file once; if it changed while being read nothing is cached \n
+     * Misses on the same version of a file while it is read wait for that read (Singleflight)
+     *
+     * @param path the file
+     * @return SharedBuffer its contents, or nullptr to send it from disk instead
+     */
+    SharedBuffer FileCache::Get(const std::string &path)
+    {
+        if (this->Capacity() == 0)
+        {
+            return nullptr;
+        }
+
+        int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        FileIdentity identity;
+        if (descriptor < 0 || !StatIdentity(descriptor, identity))
+        {
+            if (descriptor >= 0)
+            {
+                ::close(descriptor);
+            }
+            return nullptr;
+        }
+
+        std::promise<SharedBuffer> loaded;
+        std::shared_future<SharedBuffer> loaded_elsewhere;
+        std::uint64_t load_id = 0;
+        {
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+            auto entry = this->entries.find(path);
+            if (entry != this->entries.end())
+            {
+                if (entry->second.identity == identity)
+                {
+                    this->hit_count++;
+                    entry->second.frequency = std::min<std::uint8_t>(entry->second.frequency + 1, MAX_FREQUENCY);
+                    ::close(descriptor);
+                    return entry->second.contents;
+                }
+
+                // The File Changed (Or Was Replaced): The Old Contents Must Not Be Sent Again
+                this->Erase(entry);
+            }
+
+            if (identity.size > this->capacity_bytes / 8)
+            {
+                this->miss_count++;
+                ::close(descriptor);
+                return nullptr;
+            }
+
+            // Someone Is Reading This Very Version Already -> Wait For It Below
+            auto in_progress = this->loading.find(path);
+            if (in_progress != this->loading.end() && in_progress->second.identity == identity)
+            {
+                this->hit_count++;
+                loaded_elsewhere = in_progress->second.contents;
+            }
+            else
+            {
+                this->miss_count++;
+                load_id = ++this->last_load_id;
+                this->loading[path] = Loading{identity, load_id, loaded.get_future().share()};
+            }
+        }
+
+        if (loaded_elsewhere.valid())
+        {
+            ::close(descriptor);
+            return loaded_elsewhere.get();
+        }
+
+        SharedBuffer shared_contents = this->Load(descriptor, identity);
+        ::close(descriptor);
+        {
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+            if (shared_contents)
+            {
+                this->Insert(path, identity, shared_contents);
+            }
+
+            // A Newer Version May Be Loading By Now, Its Entry Stays
+            auto in_progress = this->loading.find(path);
+            if (in_progress != this->loading.end() && in_progress->second.load_id == load_id)
+            {
+                this->loading.erase(in_progress);
+            }
+        }
+
+        // nullptr Too: The Waiters Send From Disk Like This Caller
+        loaded.set_value(shared_contents);
+        return shared_contents;
+    }
+
+    SharedBuffer FileCache::Load(int descriptor, const FileIdentity &identity)
+    {
+        std::string contents(static_cast<std::size_t>(identity.size), '\0');
+        FileIdentity identity_after;
+        bool is_stable = ReadWhole(descriptor, contents) && StatIdentity(descriptor, identity_after) && identity_after == identity;
+        if (!is_stable)
+        {
+            // Written While It Was Read -> Send It From Disk This Time
+            return nullptr;
+        }
+
+        if (this->transform)
+        {
+            contents = this->transform(std::move(contents));
+        }
+        return std::make_shared<const std::string>(std::move(contents));
+    }
+
+    void FileCache::Insert(const std::string &path, const FileIdentity &identity, SharedBuffer contents)
+    {
+        // Another Thread Missed On The Same File Meanwhile: Keep Whichever Came Last
+        auto existing = this->entries.find(path);
+        if (existing != this->entries.end())
+        {
+            this->Erase(existing);
+        }
+
+        std::size_t size = contents->size();
+        if (size > this->capacity_bytes / 8)
+        {
+            return;
+        }
+
+        Entry entry;
+        entry.identity = identity;
+        entry.contents = std::move(contents);
+
+        // Dropped From The Small FIFO Not Long Ago -> It Is Coming Back, Straight To The Main FIFO
+        auto ghost = this->ghost_index.find(path);
+        if (ghost != this->ghost_index.end())
+        {
+            this->ghost_bytes -= ghost->second->second;
+            this->ghost_queue.erase(ghost->second);
+            this->ghost_index.erase(ghost);
+
+            entry.is_main = true;
+            entry.position = this->main_queue.insert(this->main_queue.end(), path);
+            this->main_bytes += size;
+        }
+        else
+        {
+            entry.position = this->small_queue.insert(this->small_queue.end(), path);
+            this->small_bytes += size;
+        }
+
+        this->entries.emplace(path, std::move(entry));
+        this->Evict();
+    }
+
+    void FileCache::Erase(std::unordered_map<std::string, Entry>::iterator entry)
+    {
+        std::size_t size = entry->second.contents->size();
+        if (entry->second.is_main)
+        {
+            this->main_queue.erase(entry->second.position);
+            this->main_bytes -= size;
+        }
+        else
+        {
+            this->small_queue.erase(entry->second.position);
+            this->small_bytes -= size;
+        }
+
+        // Downloads Still Sending The Buffer Keep It Alive Until They Finish
+        this->entries.erase(entry);
+    }
+
+    void FileCache::Evict()
+    {
+        std::size_t small_capacity = this->capacity_bytes * SMALL_QUEUE_PERCENT / 100;
+        while (this->small_bytes + this->main_bytes > this->capacity_bytes)
+        {
+            if (!this->small_queue.empty() && (this->small_bytes > small_capacity || this->main_queue.empty()))
+            {
+                this->EvictSmall();
+            }
+            else
+            {
+                this->EvictMain();
+            }
+        }
+    }
+
+    void FileCache::EvictSmall()
+    {
+        auto entry = this->entries.find(this->small_queue.front());
+        std::size_t size = entry->second.contents->size();
+
+        // Read Again While In The Small FIFO -> Worth Keeping
+        if (entry->second.frequency > 0)
+        {
+            this->small_queue.pop_front();
+            this->small_bytes -= size;
+
+            entry->second.frequency = 0;
+            entry->second.is_main = true;
+            entry->second.position = this->main_queue.insert(this->main_queue.end(), entry->first);
+            this->main_bytes += size;
+            return;
+        }
+
+        this->RememberGhost(entry->first, size);
+        this->Erase(entry);
+    }
+
+    void FileCache::EvictMain()
+    {
+        auto entry = this->entries.find(this->main_queue.front());
+
+        // Read Since Last Time -> Another Round At The Back, One Count Less
+        if (entry->second.frequency > 0)
+        {
+            entry->second.frequency--;
+            this->main_queue.splice(this->main_queue.end(), this->main_queue, entry->second.position);
+            return;
+        }
+
+        this->Erase(entry);
+    }
+
+    void FileCache::RememberGhost(const std::string &path, std::size_t size)
+    {
+        this->ghost_index[path] = this->ghost_queue.insert(this->ghost_queue.end(), {path, size});
+        this->ghost_bytes += size;
+
+        // As Many Bytes Of Names As The Main FIFO Could Hold
+        std::size_t ghost_capacity = this->capacity_bytes - this->capacity_bytes * SMALL_QUEUE_PERCENT / 100;
+        while (this->ghost_bytes > ghost_capacity && !this->ghost_queue.empty())
+        {
+            this->ghost_bytes -= this->ghost_queue.front().second;
+            this->ghost_index.erase(this->ghost_queue.front().first);
+            this->ghost_queue.pop_front();
+        }
+    }
+
+    void FileCache::SetCapacity(std::size_t capacity_bytes)
+    {
+        std::lock_guard<std::mutex> lock(this->cache_mutex);
+        this->capacity_bytes = capacity_bytes;
+        this->Evict();
+    }
+
+    std::size_t FileCache::Capacity()
+    {
+        std::lock_guard<std::mutex> lock(this->cache_mutex);
+        return this->capacity_bytes;
+    }
+
+    std::size_t FileCache::MaxEntryBytes()
+    {
+        return this->Capacity() / 8;
+    }
+
+    std::size_t FileCache::CachedBytes()
+    {
+        std::lock_guard<std::mutex> lock(this->cache_mutex);
+        return this->small_bytes + this->main_bytes;
+    }
+
+    std::uint64_t FileCache::HitCount() const
+    {
+        return this->hit_count.load();
+    }
+
+    std::uint64_t FileCache::MissCount() const
+    {
+        return this->miss_count.load();
+    }
+}
@@ -0,0 +1,361 @@
+#include "../include/JsonMessage.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace SN_Server
+{
+    void JsonSession::Clear()
+    {
+        // Keep The Capacity For The Next Frame
+        this->frame.clear();
+    }
+
+    void JsonSession::Append(std::string_view chunk)
+    {
+        std::size_t needed = this->frame.size() + chunk.size() + simdjson::SIMDJSON_PADDING;
+        if (this->frame.capacity() < needed)
+        {
+            // Grow Geometrically, So A Large Frame Arriving In Small Reads Is Not Copied Again And Again
+            this->frame.reserve(std::max(needed, this->frame.capacity() * 2));
+        }
+        this->frame.append(chunk);
+    }
+
+    std::string_view JsonSession::Frame() const
+    {
+        return this->frame;
+    }
+
+    /**
+     * @brief Parse the received frame without copying it \n
+     * The padding simdjson reads past the end is the spare capacity of the frame buffer
+     *
+     * @param document set to the on-demand document of the frame
+     * @return simdjson::error_code simdjson::SUCCESS or why the frame cannot be parsed
+     */
+    simdjson::error_code JsonSession::Parse(simdjson::ondemand::document &document)
+    {
+        if (this->frame.capacity() < this->frame.size() + simdjson::SIMDJSON_PADDING)
+        {
+            this->frame.reserve(this->frame.size() + simdjson::SIMDJSON_PADDING);
+        }
+
+        simdjson::padded_string_view padded_frame(this->frame.data(), this->frame.size(), this->frame.capacity());
+        return this->parser.iterate(padded_frame).get(document);
+    }
+
+    /**
+     * @brief Parse frame[0, length) as newline-delimited JSON records \n
+     * length must end on a record boundary, the bytes after it (A partial record) are left for the next call
+     *
+     * @param length how many bytes of the frame hold whole records
+     * @param on_record called with every record, in order
+     * @param record_count increased by the number of records handed to on_record
+     * @return simdjson::error_code simdjson::SUCCESS or the error of the first bad record
+     */
+    simdjson::error_code JsonSession::ParseRecords(
+        std::size_t length,
+        const JsonRecordHandler &on_record,
+        std::size_t &record_count
+    )
+    {
+        if (this->frame.capacity() < this->frame.size() + simdjson::SIMDJSON_PADDING)
+        {
+            this->frame.reserve(this->frame.size() + simdjson::SIMDJSON_PADDING);
+        }
+
+        // One Batch Covers The Whole Range, So No Record Is Ever Cut Between Batches
+        simdjson::ondemand::document_stream records;
+        simdjson::error_code error = this->parser.iterate_many(this->frame.data(), length, length).get(records);
+        if (error)
+        {
+            return error;
+        }
+
+        for (simdjson::simdjson_result<simdjson::ondemand::document_reference> record : records)
+        {
+            simdjson::ondemand::document_reference document;
+            error = std::move(record).get(document);
+            if (error)
+            {
+                return error;
+            }
+
+            on_record(document);
+            record_count++;
+        }
+
+        // Bytes That Never Formed A Whole Record
+        if (records.truncated_bytes() > 0)
+        {
+            return simdjson::INCOMPLETE_ARRAY_OR_OBJECT;
+        }
+
+        return simdjson::SUCCESS;
+    }
+
+    void JsonSession::Consume(std::size_t length)
+    {
+        // Only The Partial Record At The End Is Moved
+        this->frame.erase(0, length);
+    }
+
+    //* INFO: JsonWriter
+    namespace
+    {
+        constexpr int MAX_JSON_DEPTH = 64;
+
+        // Whether The Byte Must Be Escaped Inside A JSON String
+        inline bool NeedsEscape(unsigned char character)
+        {
+            return character < 0x20 || character == '"' || character == '\\';
+        }
+
+        void AppendEscapedCharacter(std::string &output, unsigned char character)
+        {
+            switch (character)
+            {
+            case '"':
+                output.append("\\\"", 2);
+                break;
+            case '\\':
+                output.append("\\\\", 2);
+                break;
+            case '\b':
+                output.append("\\b", 2);
+                break;
+            case '\f':
+                output.append("\\f", 2);
+                break;
+            case '\n':
+                output.append("\\n", 2);
+                break;
+            case '\r':
+                output.append("\\r", 2);
+                break;
+            case '\t':
+                output.append("\\t", 2);
+                break;
+            default:
+            {
+                static const char hex_chars[] = "0123456789abcdef";
+                const char escaped[6] = {'\\', 'u', '0', '0', hex_chars[character >> 4], hex_chars[character & 0x0f]};
+                output.append(escaped, sizeof(escaped));
+                break;
+            }
+            }
+        }
+    }
+
+    JsonWriter::JsonWriter(std::string &output)
+        : output(output)
+    {
+    }
+
+    void JsonWriter::BeforeValue()
+    {
+        if (this->after_key)
+        {
+            this->after_key = false;
+            return;
+        }
+
+        std::uint64_t level_bit = std::uint64_t(1) << this->depth;
+        if (this->has_value & level_bit)
+        {
+            this->output.push_back(',');
+        }
+        this->has_value |= level_bit;
+    }
+
+    void JsonWriter::Open(char bracket)
+    {
+        if (this->depth + 1 >= MAX_JSON_DEPTH)
+        {
+            throw std::length_error("JSON nested deeper than 64 levels");
+        }
+
+        this->BeforeValue();
+        this->output.push_back(bracket);
+        this->depth++;
+        this->has_value &= ~(std::uint64_t(1) << this->depth);
+    }
+
+    void JsonWriter::Close(char bracket)
+    {
+        if (this->depth == 0)
+        {
+            throw std::logic_error("JSON closed more than it was opened");
+        }
+
+        this->output.push_back(bracket);
+        this->depth--;
+    }
+
+    JsonWriter &JsonWriter::BeginObject()
+    {
+        this->Open('{');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::EndObject()
+    {
+        this->Close('}');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::BeginArray()
+    {
+        this->Open('[');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::EndArray()
+    {
+        this->Close(']');
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Key(std::string_view key)
+    {
+        this->BeforeValue();
+        this->WriteEscaped(key);
+        this->output.push_back(':');
+        this->after_key = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::String(std::string_view value)
+    {
+        this->BeforeValue();
+        this->WriteEscaped(value);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Int(std::int64_t value)
+    {
+        this->BeforeValue();
+        char digits[24];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        this->output.append(digits, result.ptr - digits);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::UInt(std::uint64_t value)
+    {
+        this->BeforeValue();
+        char digits[24];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        this->output.append(digits, result.ptr - digits);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Double(double value)
+    {
+        this->BeforeValue();
+        if (!std::isfinite(value))
+        {
+            // JSON Has No NaN Or Infinity
+            this->output.append("null", 4);
+            return *this;
+        }
+
+        // Shortest Text That Parses Back To The Same Double
+        char digits[32];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        this->output.append(digits, result.ptr - digits);
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Bool(bool value)
+    {
+        this->BeforeValue();
+        if (value)
+        {
+            this->output.append("true", 4);
+        }
+        else
+        {
+            this->output.append("false", 5);
+        }
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Null()
+    {
+        this->BeforeValue();
+        this->output.append("null", 4);
+        return *this;
+    }
+
+    bool JsonWriter::IsComplete() const
+    {
+        return this->depth == 0 && !this->after_key;
+    }
+
+    /**
+     * @brief Append text as a quoted JSON string \n
+     * Runs without special characters are copied in one append, found 16 bytes at a time with SSE2
+     *
+     * @param text UTF-8 text (Copied as is apart from the escapes JSON requires)
+     */
+    void JsonWriter::WriteEscaped(std::string_view text)
+    {
+        const unsigned char *characters = reinterpret_cast<const unsigned char *>(text.data());
+        std::size_t size = text.size();
+        std::size_t run_start = 0;
+        std::size_t index = 0;
+
+        this->output.reserve(this->output.size() + size + 2);
+        this->output.push_back('"');
+
+#ifdef __SSE2__
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i last_control = _mm_set1_epi8(0x1f);
+        while (index + 16 <= size)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(characters + index));
+
+            // max(byte, 0x1f) == 0x1f Exactly When byte <= 0x1f (Unsigned)
+            __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(block, last_control), last_control);
+            __m128i is_special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                is_control
+            );
+
+            int special_mask = _mm_movemask_epi8(is_special);
+            if (special_mask == 0)
+            {
+                index += 16;
+                continue;
+            }
+
+            index += __builtin_ctz(special_mask);
+            this->output.append(text.data() + run_start, index - run_start);
+            AppendEscapedCharacter(this->output, characters[index]);
+            index++;
+            run_start = index;
+        }
+#endif
+
+        for (; index < size; index++)
+        {
+            if (NeedsEscape(characters[index]))
+            {
+                this->output.append(text.data() + run_start, index - run_start);
+                AppendEscapedCharacter(this->output, characters[index]);
+                run_start = index + 1;
+            }
+        }
+
+        this->output.append(text.data() + run_start, size - run_start);
+        this->output.push_back('"');
+    }
+}
@@ -4,10 +4,212 @@
 #include <boost/filesystem.hpp>
 #include <iostream>
 #include <cstring>
+#include <charconv>
+#include <csignal>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
 
 using namespace JB_Encode_Decode_Base64;
 namespace SN_Server
 {
+    namespace
+    {
+        // How Often A Thread Waiting On A Ring Checks Whether Its Client Is Still There
+        constexpr std::chrono::milliseconds SHARED_MEMORY_POLL_INTERVAL = std::chrono::milliseconds(100);
+
+        //* Built-In Text Commands, Index i Of BUILTIN_COMMANDS Is Name i
+        enum BuiltinCommand : std::size_t
+        {
+            BuiltinEcho,
+            BuiltinUpload,
+            BuiltinStore,
+            BuiltinDownload,
+            BuiltinStats,
+            BuiltinStripe,
+            BuiltinShm,
+            BuiltinNdjson,
+            BuiltinCommandCount
+        };
+
+        constexpr StaticCommandTable<BuiltinCommandCount> BUILTIN_COMMANDS({
+            "ECHO", "UPLOAD", "STORE", "DOWNLOAD", "STATS", "STRIPE", "SHM", "NDJSON"
+        });
+
+        static_assert(BUILTIN_COMMANDS.Find("STATS") == BuiltinStats, "Built-In Command Names Out Of Order");
+        static_assert(BUILTIN_COMMANDS.Find("STRIPE") == BuiltinStripe, "Built-In Command Names Out Of Order");
+        static_assert(BUILTIN_COMMANDS.Find("SHM") == BuiltinShm, "Built-In Command Names Out Of Order");
+        static_assert(BUILTIN_COMMANDS.Find("NDJSON") == BuiltinNdjson, "Built-In Command Names Out Of Order");
+        static_assert(BUILTIN_COMMANDS.Find("stats") == BUILTIN_COMMANDS.NOT_FOUND, "Commands Are Case-Sensitive");
+
+        // Blocks Of A Striped Upload (A Multiple Of The Direct I/O Alignment), And How Long One May Sit Idle
+        constexpr std::size_t STRIPE_BLOCK_SIZE = 4 * 1024 * 1024;
+        constexpr std::chrono::minutes STRIPED_UPLOAD_IDLE_TIMEOUT = std::chrono::minutes(5);
+
+        // Longest File Name A Client May Send (And Longest Part Of It Between Slashes)
+        constexpr std::size_t MAX_CLIENT_PATH_LENGTH = 1024;
+        constexpr std::size_t MAX_CLIENT_NAME_LENGTH = 255;
+
+        //* Create An Empty File ".<file name>.XXXXXX" Beside path, Unique Even When Many Transfers Target path
+        // It Is Hidden, And ResolveClientPath Refuses Names Starting With '.', So No Client Can Name One
+        // Returns Its Path (Empty If It Could Not Be Created)
+        std::string CreateTransferFile(const std::string &path)
+        {
+            boost::filesystem::path target_path(path);
+            boost::filesystem::path pattern = target_path.parent_path() / ("." + target_path.filename().string() + ".XXXXXX");
+
+            std::string transfer_file = pattern.string();
+            int descriptor = ::mkstemp(transfer_file.data());
+            if (descriptor < 0)
+            {
+                std::cerr << "Error: Unable to create a transfer file beside " << path << ": " << std::strerror(errno) << std::endl;
+                return "";
+            }
+
+            // mkstemp() Makes It Owner-Only, The Finished File Gets The Usual Permissions
+            ::fchmod(descriptor, 0644);
+            ::close(descriptor);
+            return transfer_file;
+        }
+
+        //* Bytes An Unprivileged Writer May Still Put On The Filesystem Of path (Unknown -> No Limit)
+        std::uint64_t FreeDiskBytes(const std::string &path)
+        {
+            struct statvfs filesystem_status;
+            if (::statvfs(path.c_str(), &filesystem_status) != 0)
+            {
+                return UINT64_MAX;
+            }
+            return static_cast<std::uint64_t>(filesystem_status.f_bavail) * filesystem_status.f_frsize;
+        }
+
+        //* A Whole Unsigned Number (False For Anything Else)
+        bool ParseUnsigned(std::string_view text, std::uint64_t &number)
+        {
+            std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), number);
+            return !text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
+        }
+
+        //* Take A Trailing "<name><value>" Off The Arguments Of A Request (False If It Is Not There)
+        bool TakeOption(std::string_view &arguments, std::string_view name, std::string_view &value)
+        {
+            std::size_t option_index = arguments.rfind(name);
+            if (option_index == std::string_view::npos || (option_index > 0 && arguments[option_index - 1] != ' '))
+            {
+                return false;
+            }
+
+            value = arguments.substr(option_index + name.size());
+            arguments = arguments.substr(0, option_index == 0 ? 0 : option_index - 1);
+            return true;
+        }
+
+        //* Take A Trailing "size=<bytes>" Off The Arguments Of A Request (False If It Is There But Not A Number)
+        bool TakeSizeOption(std::string_view &arguments, bool &has_size, std::uint64_t &size)
+        {
+            std::string_view number;
+            has_size = TakeOption(arguments, "size=", number);
+            return !has_size || ParseUnsigned(number, size);
+        }
+
+        //* Turn "<first>-<last>", "<first>-" Or "-<bytes>" Into The Bytes Of A File Of file_size
+        // As In HTTP The Last Byte Is Included, Ranges Running Past The End Stop There, And A Range
+        // Starting Right At The End Is Empty (A Tail Of A Log With Nothing New)
+        bool ResolveByteRange(std::string_view range, std::uint64_t file_size, std::uint64_t &offset, std::uint64_t &length)
+        {
+            std::size_t dash_index = range.find('-');
+            if (dash_index == std::string_view::npos)
+            {
+                return false;
+            }
+            std::string_view first_text = range.substr(0, dash_index);
+            std::string_view last_text = range.substr(dash_index + 1);
+
+            // "-<bytes>": The End Of The File
+            if (first_text.empty())
+            {
+                std::uint64_t suffix_length = 0;
+                if (!ParseUnsigned(last_text, suffix_length))
+                {
+                    return false;
+                }
+                length = std::min(suffix_length, file_size);
+                offset = file_size - length;
+                return true;
+            }
+
+            std::uint64_t first = 0;
+            std::uint64_t last = UINT64_MAX;
+            if (!ParseUnsigned(first_text, first) || (!last_text.empty() && !ParseUnsigned(last_text, last)) || last < first || first > file_size)
+            {
+                return false;
+            }
+
+            offset = first;
+            length = std::min(last - first + (last == UINT64_MAX ? 0 : 1), file_size - first);
+            return true;
+        }
+
+        //* Take The Next Space-Separated Word Off The Arguments Of A Request
+        std::string_view TakeWord(std::string_view &arguments)
+        {
+            std::size_t space_index = arguments.find(' ');
+            std::string_view word = arguments.substr(0, space_index);
+            arguments = space_index == std::string_view::npos ? std::string_view() : arguments.substr(space_index + 1);
+            return word;
+        }
+
+        //* Decodes A Base 64 Frame Piece By Piece, However The Pieces Are Cut
+        class Base64FrameDecoder
+        {
+        private:
+            // Base64 Characters Not Yet Forming A Whole 4-Character Group
+            std::string pending_encoded;
+
+        public:
+            // The Bytes Of The Whole Groups Received So Far
+            std::vector<BYTE> Feed(std::string_view chunk)
+            {
+                this->pending_encoded.append(chunk);
+
+                std::size_t whole_groups = this->pending_encoded.size() - this->pending_encoded.size() % 4;
+                if (whole_groups == 0)
+                {
+                    return {};
+                }
+
+                std::vector<BYTE> decoded;
+                {
+                    TraceSpan span("decode");
+                    decoded = base64_decode(this->pending_encoded.substr(0, whole_groups));
+                }
+                this->pending_encoded.erase(0, whole_groups);
+                return decoded;
+            }
+
+            // The Bytes Of What Was Left At The End Of The Frame
+            std::vector<BYTE> Finish()
+            {
+                std::vector<BYTE> decoded = this->pending_encoded.empty() ? std::vector<BYTE>() : base64_decode(this->pending_encoded);
+                this->pending_encoded.clear();
+                return decoded;
+            }
+        };
+
+        //* Put A Finished Transfer File At path In One Step: Readers See The Old File Or The Whole New One
+        bool CommitTransferFile(const std::string &transfer_file, const std::string &path)
+        {
+            if (::rename(transfer_file.c_str(), path.c_str()) != 0)
+            {
+                std::cerr << "Error: Unable to move " << transfer_file << " to " << path << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            return true;
+        }
+    }
+
     /**
      * @brief Construct a new Server:: Server object
      *
@@ -15,6 +217,7 @@ namespace SN_Server
      * @param port the PORT that the Server to open
      */
     Server::Server(std::string_view server_ipv4_address_str, std::uint16_t port)
+        : server_strand(boost::asio::make_strand(this->io_context))
     {
         //* Convert the IP Address string to an IP Address Object
         this->server_ipv4_address = boost::asio::ip::address_v4(
@@ -25,6 +228,33 @@ namespace SN_Server
         this->server_endpoint = boost::asio::ip::tcp::endpoint(
             this->server_ipv4_address, port
         );
+
+        //* Open The Default Content Store
+        this->content_store = std::make_shared<ContentStore>("store");
+
+        //* Buffers Reused By Every Outgoing Frame
+        this->output_buffers = std::make_shared<BufferPool>();
+
+        //* File Reads And Writes Happen Off The Socket Threads
+        this->disk_executor = std::make_shared<DiskExecutor>();
+
+        //* Hot Files Are Sent From Memory, Binary Ones Already Encoded
+        this->file_cache = std::make_shared<FileCache>();
+        this->encoded_file_cache = std::make_shared<FileCache>(64 * 1024 * 1024, [](std::string file_contents) {
+            return base64_encode(reinterpret_cast<const BYTE *>(file_contents.data()), static_cast<unsigned int>(file_contents.size()));
+        });
+
+        //* Uploads Split Over Several Connections, By Transfer ID
+        this->striped_uploads = std::make_shared<StripedUploads>();
+
+        //* Shared Budget Of Every Send Queue
+        this->send_memory_account = std::make_shared<SendMemoryAccount>();
+
+        //* One Wheel For The Timeouts Of Every Client
+        this->timing_wheel = std::make_shared<TimingWheel>(this->io_context);
+
+        //* Spans Are Only Recorded Once Tracing Is Enabled
+        this->tracer = std::make_shared<Tracer>();
     }
 
     Server::~Server()
@@ -39,23 +269,81 @@ namespace SN_Server
     void Server::Start()
     {
         //* Listening for any new incomming connection
-        this->acceptor_server = std::make_shared<boost::asio::ip::tcp::acceptor>(
-            this->io_context,
-            this->server_endpoint
-        );
+        // The Acceptor Lives On server_strand, The Sockets It Accepts On The io_context
+        this->acceptor_server = std::make_shared<boost::asio::ip::tcp::acceptor>(this->server_strand);
+        this->acceptor_server->open(this->server_endpoint.protocol());
+        this->acceptor_server->set_option(boost::asio::socket_base::reuse_address(this->socket_options.reuse_address));
+        if (this->socket_options.receive_buffer_size > 0)
+        {
+            // Set Before listen(), So Accepted Sockets Start With It (And The Window Scale Matches)
+            this->acceptor_server->set_option(boost::asio::socket_base::receive_buffer_size(this->socket_options.receive_buffer_size));
+        }
+        this->acceptor_server->bind(this->server_endpoint);
+        this->acceptor_server->listen(this->socket_options.listen_backlog);
+
+        //* Listening On The Unix Domain Socket Too
+        if (!this->local_socket_path.empty())
+        {
+            // A Socket File Left By A Previous Run Would Make bind() Fail (Anything Else Is Left Alone)
+            struct stat socket_status;
+            if (::lstat(this->local_socket_path.c_str(), &socket_status) == 0 && S_ISSOCK(socket_status.st_mode))
+            {
+                ::unlink(this->local_socket_path.c_str());
+            }
+
+            boost::asio::local::stream_protocol::endpoint local_endpoint(this->local_socket_path);
+            this->local_acceptor = std::make_shared<boost::asio::local::stream_protocol::acceptor>(this->server_strand);
+            this->local_acceptor->open(local_endpoint.protocol());
+            this->local_acceptor->bind(local_endpoint);
+            this->local_acceptor->listen(this->socket_options.listen_backlog);
+        }
+
+        //* Perfect Hashes Of What Was Registered, Read By Every Client Thread From Now On
+        this->command_table.Build(this->command_names);
+
+        std::vector<std::string> json_types;
+        this->json_type_handlers.clear();
+        for (const auto &[type, handler] : this->json_handlers)
+        {
+            json_types.push_back(type);
+            this->json_type_handlers.push_back(handler);
+        }
+        this->json_type_table.Build(json_types);
+
+        // A Client Gone Mid-Send Must Fail That Send With EPIPE, Not Kill The Process (sendfile Has No MSG_NOSIGNAL)
+        std::signal(SIGPIPE, SIG_IGN);
 
         // Change the Atomic Variable To True
         this->is_running = true;
 
+        // Keep The io_context Running While There Is Nothing To Do
+        // (Client Threads Post Their Reads And Writes Onto It)
+        this->io_work_guard = std::make_shared<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+            this->io_context.get_executor()
+        );
+        this->timing_wheel->Start();
+
         // Make A Listening Thread
         this->listening_thread = std::make_shared<std::thread>([this]() { 
             this->AcceptConnections(); 
         });
 
+        // More Threads Share The Reads, Writes And Timers Of The Clients
+        for (std::size_t io_thread = 1; io_thread < this->io_thread_count; io_thread++)
+        {
+            this->io_threads.emplace_back([this]() {
+                this->io_context.run();
+            });
+        }
+
         // Show a Log of Opening The Listenning SERVER Phase
         std::cout << "Sever Configuration..." << std::endl;
         std::cout << "Server Address: " << this->server_endpoint.address() << std::endl;
         std::cout << "Server Port Opening: " << this->server_endpoint.port() << std::endl;
+        if (this->local_acceptor)
+        {
+            std::cout << "Server Local Socket: " << this->local_socket_path << std::endl;
+        }
     }
 
     /**
@@ -63,44 +351,98 @@ namespace SN_Server
      * Maybe combine with 
      * #include <csignal>
      * 
-     * To Make a signal to Stop
+     * To Make a signal to Stop \n
+     * Safe to call again (The destructor does): later calls wait for the first one to finish
      */
     void Server::Stop()
+    {
+        std::call_once(this->stop_flag, [this]() {
+            this->ShutDown();
+        });
+    }
+
+    void Server::ShutDown()
     {
         // Change The Atomic Variable To False
         // Set the flag to stop accepting new connections
         this->is_running = false;
 
         // Gracefully shutdown all the connections
-        for (std::shared_ptr<boost::asio::ip::tcp::socket> client_socket : this->clients_connections)
+        std::unique_lock<std::mutex> clients_lock(this->clients_mutex);
+        for (std::shared_ptr<ClientConnection> client_socket : this->clients_connections)
         {
-            if (client_socket->is_open())
+            if (client_socket->IsOpen())
             {
                 std::cout << "Shutting Connection with "
-                          << client_socket->remote_endpoint().address() << ":"
-                          << client_socket->remote_endpoint().port() << "\n";
+                          << client_socket->RemoteAddress() << "\n";
                 // Send a shutdown message and close the client socket
                 // sendData(client_socket, "CLOSE BY SERVER");
-                client_socket->close();
+                client_socket->Close();
             }
         }
 
-        // Clear The Set of Client_socket
+        // Their Threads Still Read And Write Through The io_context: It Must Keep Running Until They Return
+        // (ServeClient Takes No New Client Once is_running Is False, Each Thread Forgets Its Client Itself)
+        this->client_threads_done.wait(clients_lock, [this]() {
+            return this->client_thread_count == 0;
+        });
         this->clients_connections.clear();
+        clients_lock.unlock();
 
         // Stop accepting new connections
         std::cout << "Stopped accepting new connections." << std::endl;
-        this->acceptor_server->close(); // Close the Acceptor
+        if (this->acceptor_server)
+        {
+            // Close On server_strand, Where The Pending Accept Lives
+            boost::asio::post(this->server_strand, [acceptor_server = this->acceptor_server]() {
+                boost::system::error_code error;
+                acceptor_server->close(error); // Close the Acceptor
+            });
+        }
+        if (this->local_acceptor)
+        {
+            boost::asio::post(this->server_strand, [local_acceptor = this->local_acceptor]() {
+                boost::system::error_code error;
+                local_acceptor->close(error);
+            });
+            ::unlink(this->local_socket_path.c_str());
+            this->local_acceptor.reset();
+        }
+
+        // The Pending Signal, Drain And Timeout Waits Would Keep The Run Loop Alive
+        this->timing_wheel->Stop();
+        boost::asio::post(this->server_strand, [this]() {
+            boost::system::error_code error;
+            if (this->signals)
+            {
+                this->signals->cancel(error);
+            }
+            if (this->drain_timer)
+            {
+                this->drain_timer->cancel();
+            }
+        });
 
-        // Stop the io_context to exit the run loop
+        // Let the run loop exit once the closes above have been handled
         std::cout << "Server is shutting down. Goodbye!" << std::endl;
-        this->io_context.stop(); // Stop the I/O
+        this->io_work_guard.reset();
 
         // Join the Listenning Threads
-        if (this->listening_thread->joinable())
+        if (this->listening_thread && this->listening_thread->joinable())
         {
             this->listening_thread->join();
         }
+        for (std::thread &io_thread : this->io_threads)
+        {
+            if (io_thread.joinable())
+            {
+                io_thread.join();
+            }
+        }
+        this->io_threads.clear();
+
+        // No Connection Is Left To Finish A Striped Upload
+        this->striped_uploads->AbortAll();
 
         std::cout << "Stop Running!" << std::endl;
     }
@@ -110,6 +452,93 @@ namespace SN_Server
         return this->is_running;
     }
 
+    /**
+     * @brief Shut down without cutting transfers: \n
+     * 1. Stop accepting new connections \n
+     * 2. Idle clients get the going-away frame (After whatever was queued for them) and are closed \n
+     * 3. Busy clients finish their current request, then get the going-away frame instead of a next request \n
+     * 4. At the deadline every client still connected is closed \n
+     * Safe to call from any thread, it only posts to server_strand
+     *
+     * @param deadline how long in-flight requests may take to finish
+     */
+    void Server::BeginDrain(std::chrono::milliseconds deadline)
+    {
+        boost::asio::post(this->server_strand, [this, deadline]() {
+            if (this->is_draining.exchange(true))
+            {
+                return;
+            }
+
+            std::cout << "Draining: waiting up to " << deadline.count() << " ms for in-flight requests." << std::endl;
+
+            boost::system::error_code error;
+            if (this->acceptor_server)
+            {
+                this->acceptor_server->close(error);
+            }
+            if (this->local_acceptor)
+            {
+                this->local_acceptor->close(error);
+            }
+
+            // Let Idle Clients Go Now, Busy Ones Go From FinishRequest()
+            {
+                std::lock_guard<std::mutex> lock(this->clients_mutex);
+                for (const std::shared_ptr<ClientConnection> &client_socket : this->clients_connections)
+                {
+                    if (client_socket->MarkClosing())
+                    {
+                        this->SayGoingAway(client_socket);
+                    }
+                }
+            }
+
+            this->drain_timer = std::make_shared<boost::asio::steady_timer>(this->server_strand, deadline);
+            this->drain_timer->async_wait([this](const boost::system::error_code &wait_error) {
+                if (!wait_error)
+                {
+                    this->FinishDrain();
+                }
+            });
+
+            // Nobody Connected
+            std::lock_guard<std::mutex> lock(this->clients_mutex);
+            if (this->clients_connections.empty())
+            {
+                boost::asio::post(this->server_strand, [this]() { this->FinishDrain(); });
+            }
+        });
+    }
+
+    bool Server::IsDraining() const
+    {
+        return this->is_draining;
+    }
+
+    /**
+     * @brief Handle signals (e.g. SIGINT, SIGTERM) as ordinary handlers on the io_context \n
+     * The handler may lock, allocate and log, unlike a std::signal handler. Call before Start()
+     *
+     * @param signal_numbers the signals to catch
+     * @param handler called with the number of every signal caught
+     */
+    void Server::OnSignals(const std::vector<int> &signal_numbers, std::function<void(int)> handler)
+    {
+        this->signals = std::make_shared<boost::asio::signal_set>(this->server_strand);
+        for (int signal_number : signal_numbers)
+        {
+            boost::system::error_code error;
+            this->signals->add(signal_number, error);
+            if (error)
+            {
+                std::cerr << "Error: Unable to catch signal " << signal_number << ": " << error.message() << std::endl;
+            }
+        }
+
+        this->WaitForSignal(std::move(handler));
+    }
+
     /**
      * @brief Set a new CHUNK_SIZE 
      * 
@@ -159,673 +588,2954 @@ namespace SN_Server
     }
 
     /**
-     * @brief Check Whether there is an end_signal in the given text
-     * 
-     * @param text text to check
-     * @return true if there is an end_signal
-     * @return false if there is no end_signal
+     * @brief Serve every new connection over TLS \n
+     * Reconnecting clients skip the full handshake: TLS 1.3 session tickets and a server-side session cache for TLS 1.2 \n
+     * Call Before Start()
+     *
+     * @param certificate_file PEM certificate chain of the server
+     * @param private_key_file PEM private key of the certificate
+     * @return true if the certificate and key were loaded
      */
-    bool Server::HasEndSignal(const std::string_view& text, std::size_t* index_to_del)
+    bool Server::EnableTls(const std::string &certificate_file, const std::string &private_key_file)
     {
-        bool has_end_signal = false;
+        std::shared_ptr<boost::asio::ssl::context> new_tls_context =
+            std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tls_server);
 
-        std::size_t found_pos = text.find(this->end_signal, 0);
-        if (found_pos != std::string::npos)
+        try
         {
-            // Found an end_signal
-            std::cout << "Found: " << this->end_signal << " at index: " << found_pos << std::endl;
-            
-            // Return the index_to_del
-            *index_to_del = found_pos;
-
-            // Found an end_signal
-            has_end_signal = true;
+            new_tls_context->set_options(
+                boost::asio::ssl::context::default_workarounds |
+                boost::asio::ssl::context::no_sslv2 |
+                boost::asio::ssl::context::no_sslv3 |
+                boost::asio::ssl::context::no_tlsv1 |
+                boost::asio::ssl::context::no_tlsv1_1 |
+                boost::asio::ssl::context::single_dh_use
+            );
+            new_tls_context->use_certificate_chain_file(certificate_file);
+            new_tls_context->use_private_key_file(private_key_file, boost::asio::ssl::context::pem);
+        }
+        catch (const boost::system::system_error &error)
+        {
+            std::cerr << "Error: Unable to load TLS certificate " << certificate_file
+                      << " / key " << private_key_file << ": " << error.what() << std::endl;
+            return false;
         }
 
-        return has_end_signal;
+        //* Session Resumption
+        SSL_CTX *native_context = new_tls_context->native_handle();
+
+        // TLS 1.2: Sessions Cached On The Server, Looked Up By Session ID
+        const unsigned char session_id_context[] = "SN_Server";
+        SSL_CTX_set_session_id_context(native_context, session_id_context, sizeof(session_id_context) - 1);
+        SSL_CTX_set_session_cache_mode(native_context, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(native_context, 20480);
+        SSL_CTX_set_timeout(native_context, 2 * 60 * 60);
+
+        // TLS 1.3: Stateless Tickets (Keys Rotated By OpenSSL), Two Per Full Handshake
+        SSL_CTX_set_num_tickets(native_context, 2);
+
+        this->tls_context = new_tls_context;
+        std::cout << "TLS enabled with certificate " << certificate_file << std::endl;
+        return true;
     }
 
-    std::string Server::RemoveEndSignal(std::string& text, std::size_t end_signal_index)
+    bool Server::IsTlsEnabled() const
     {
-        return text.substr(0, end_signal_index);
+        return this->tls_context != nullptr;
     }
 
     /**
-     * @brief Send an end signal to the client_socket
-     * 
-     * @param client_socket the client_socket to send
+     * @brief Choose the integrity trailer of file transfers \n
+     * IntegrityCrc32c: "crc32c:<8 hex>" frame after the file \n
+     * IntegrityCrc32cSha256: "crc32c:<8 hex> sha256:<64 hex>" frame after the file \n
+     * Default: IntegrityNone (No trailer)
+     *
+     * @param transfer_integrity the checksums to send and to expect
      */
-    void Server::SendEndSignal(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket)
+    void Server::SetTransferIntegrity(TransferIntegrity transfer_integrity)
     {
-        // Error if Thrown
-        boost::system::error_code error;
+        this->transfer_integrity = transfer_integrity;
+    }
 
-        // Send an end signal of the Text
-        boost::asio::write(
-            *client_socket,
-            boost::asio::buffer(this->end_signal),
-            error
-        );
+    /**
+     * @brief Get the current integrity trailer of file transfers
+     *
+     * @return TransferIntegrity the checksums sent and expected
+     */
+    TransferIntegrity Server::GetTransferIntegrity() const
+    {
+        return this->transfer_integrity;
+    }
 
-        // Check error
-        if (error)
+    /**
+     * @brief Change the directory of the content-addressed store
+     * Default: store
+     *
+     * @param directory new directory, created if missing
+     */
+    void Server::SetContentStoreDirectory(const std::string_view& directory)
+    {
+        if (directory != "")
         {
-            std::cerr << "Error: " << error.message() << std::endl;
+            this->content_store = std::make_shared<ContentStore>(directory);
         }
     }
 
-    //* INFO: For Sending Protocol Method
     /**
-     * @brief For Sending Simple Text To a Specify client_socket
+     * @brief Get the current directory of the content-addressed store
      *
-     * @param client_socket The Socket Want to Send
-     * @param text The Text To Send
+     * @return std::string_view the store directory
      */
-    void Server::SendText(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string_view &text)
+    std::string_view Server::GetContentStoreDirectory() const
     {
-        // The Variable To check For The Bytes Have Send
-        std::size_t total_sent = 0;
-
-        // Error if Thrown
-        boost::system::error_code error;
-
-        // Send every CHUNK_SIZE character per send
-        for (size_t index = 0; index < text.size(); index += this->CHUNK_SIZE)
-        {
-            std::string_view chunk = text.substr(index, this->CHUNK_SIZE);
-
-            // Synchronous write
-            std::size_t bytes_sent = boost::asio::write(
-                *client_socket, 
-                boost::asio::buffer(chunk), 
-                error
-            );
-
-            // Check Whether Error Happen
-            if (!error)
-            {
-                total_sent += bytes_sent;
-                std::cout << "Message sent successfully to "
-                          << client_socket->remote_endpoint().address() << ":"
-                          << client_socket->remote_endpoint().port()
-                          << std::endl;
-            }
-            else
-            {
-                std::cerr << "Error: " << error.message() << std::endl;
-                break; // Break The Loop On Error
-            }
-        }
+        return this->content_store->GetRootDirectory();
+    }
 
-        // Check If All data has been sent
-        if (total_sent == text.size())
-        {
-            std::cout << " All data sent successfully!" << std::endl;
-        }
-        else
+    /**
+     * @brief Change the send queue limits of clients connecting from now on \n
+     * Default: high watermark 8 MiB, low watermark 2 MiB, OverflowBlock
+     *
+     * @param send_queue_limits the watermarks (In queued bytes) and what to do past the high one
+     */
+    void Server::SetSendQueueLimits(const SendQueueLimits &send_queue_limits)
+    {
+        this->send_queue_limits = send_queue_limits;
+        if (this->send_queue_limits.low_watermark > this->send_queue_limits.high_watermark)
         {
-            std::cerr << "Not all data sent. Total sent: " << total_sent << " bytes out of " << text.size() << " bytes." << std::endl;
+            this->send_queue_limits.low_watermark = this->send_queue_limits.high_watermark;
         }
+    }
 
-        //! Send an end signal
-        this->SendEndSignal(client_socket);
+    SendQueueLimits Server::GetSendQueueLimits() const
+    {
+        return this->send_queue_limits;
     }
 
     /**
-     * @brief Call This Function within server object to send a Text-Based Formats \n
-     * For Sending Files ends with: \n
-     * 1. Plain Text Files (.txt) \n
-     * 2. JSON Files (.json) \n
-     * 3. XML Files (.xml) \n
-     * 4. CSV Files (.csv) \n
-     * 5. TCV Files (.tsx) \n
-     * And Many More...
+     * @brief Change how many bytes may be queued across all clients before every queue over its low watermark overflows \n
+     * Default: 256 MiB
      *
-     * @param client_socket The client_socket to send the File
-     * @param file_to_send The file directory to send
+     * @param limit_bytes the server-wide limit
      */
-    void Server::SendTextBasedFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string &file_to_send)
+    void Server::SetSendMemoryLimit(std::size_t limit_bytes)
     {
-        // Open The File JSON and Load every 255 Character To Send
-        std::ifstream text_file(file_to_send, std::ios::binary);
+        this->send_memory_account->SetLimitBytes(limit_bytes);
+    }
 
-        // Check If the File Open Successfully
-        if (!text_file.is_open())
-        {
-            std::cerr << "Error: Unable to open TEXT file " << file_to_send << std::endl;
-            return;
+    std::size_t Server::GetSendMemoryLimit() const
+    {
+        return this->send_memory_account->LimitBytes();
+    }
+
+    std::size_t Server::GetQueuedSendBytes() const
+    {
+        return this->send_memory_account->TotalBytes();
+    }
+
+    /**
+     * @brief Also listen on a Unix domain socket: same sessions and framing as TCP, without the TCP/IP stack \n
+     * Local clients may pass open files (SCM_RIGHTS) instead of sending their bytes, see GetBinaryFileToStore
+     *
+     * @param local_socket_path the socket file (A stale socket file there is replaced on Start, empty turns it off)
+     */
+    void Server::SetLocalSocketPath(const std::string &local_socket_path)
+    {
+        this->local_socket_path = local_socket_path;
+    }
+
+    std::string Server::GetLocalSocketPath() const
+    {
+        return this->local_socket_path;
+    }
+
+    /**
+     * @brief Let local clients move their messages onto shared memory rings (See GetText) \n
+     * Rings are only offered over the Unix domain socket: it is what passes their descriptors
+     *
+     * @param shared_memory_options whether it is enabled, the largest ring and the busy-poll spins
+     */
+    void Server::SetSharedMemoryOptions(const SharedMemoryOptions &shared_memory_options)
+    {
+        this->shared_memory_options = shared_memory_options;
+    }
+
+    SharedMemoryOptions Server::GetSharedMemoryOptions() const
+    {
+        return this->shared_memory_options;
+    }
+
+    /**
+     * @brief Change how many threads run the io_context: the listening thread plus io_thread_count - 1 more \n
+     * Default: 1 (Client threads only wait on it, so more helps with many TLS clients or large broadcasts)
+     *
+     * @param io_thread_count the thread count, at least 1
+     */
+    void Server::SetIoThreads(std::size_t io_thread_count)
+    {
+        this->io_thread_count = std::max<std::size_t>(io_thread_count, 1);
+    }
+
+    std::size_t Server::GetIoThreads() const
+    {
+        return this->io_thread_count;
+    }
+
+    /**
+     * @brief Change how many threads read and write the files of transfers \n
+     * Socket threads only copy into and out of blocks, so a slow disk does not close the TCP windows \n
+     * Default: 2
+     *
+     * @param disk_thread_count the number of disk threads (At least one)
+     */
+    void Server::SetDiskThreads(std::size_t disk_thread_count)
+    {
+        DirectIoOptions direct_io = this->disk_executor->GetDirectIoOptions();
+        this->disk_executor = std::make_shared<DiskExecutor>(disk_thread_count);
+        this->disk_executor->SetDirectIoOptions(direct_io);
+    }
+
+    std::size_t Server::GetDiskThreads() const
+    {
+        return this->disk_executor->ThreadCount();
+    }
+
+    /**
+     * @brief Change the size from which uploads skip the page cache \n
+     * Full aligned blocks are then written with O_DIRECT, the tail through the page cache \n
+     * An upload announced with its size switches from the start, any other once it has written that much \n
+     * Default: 1 GiB (0 turns it off)
+     *
+     * @param direct_io the size threshold
+     */
+    void Server::SetDirectIoOptions(const DirectIoOptions &direct_io)
+    {
+        this->disk_executor->SetDirectIoOptions(direct_io);
+    }
+
+    DirectIoOptions Server::GetDirectIoOptions() const
+    {
+        return this->disk_executor->GetDirectIoOptions();
+    }
+
+    /**
+     * @brief Change the options of the listening socket and of every accepted socket
+     *
+     * @param socket_options the options, see SocketOptions
+     */
+    void Server::SetSocketOptions(const SocketOptions &socket_options)
+    {
+        this->socket_options = socket_options;
+    }
+
+    SocketOptions Server::GetSocketOptions() const
+    {
+        return this->socket_options;
+    }
+
+    /**
+     * @brief Change the timeouts of clients connecting from now on \n
+     * Default: idle 5 min, read 30 s, write 30 s, no heartbeat
+     *
+     * @param session_timeouts the timeouts, 0 turns one off
+     */
+    void Server::SetSessionTimeouts(const SessionTimeouts &session_timeouts)
+    {
+        this->session_timeouts = session_timeouts;
+    }
+
+    SessionTimeouts Server::GetSessionTimeouts() const
+    {
+        return this->session_timeouts;
+    }
+
+    /**
+     * @brief Change the limits checked when a client connects (Clients already in are not affected) \n
+     * Default: 1024 connections, 64 per IP address, 200 accepts/s (bursts of 100), 256 MiB buffered
+     *
+     * @param admission_limits the limits, 0 turns one off
+     */
+    void Server::SetAdmissionLimits(const AdmissionLimits &admission_limits)
+    {
+        this->admission_control.SetLimits(admission_limits);
+    }
+
+    AdmissionLimits Server::GetAdmissionLimits() const
+    {
+        return this->admission_control.GetLimits();
+    }
+
+    const AdmissionControl &Server::GetAdmissionControl() const
+    {
+        return this->admission_control;
+    }
+
+    /**
+     * @brief Start tracing requests: accept, read frame, socket read, decode, disk write and reply spans \n
+     * are kept per thread and written out by WriteTrace (Can be switched at any time)
+     *
+     * @param sample_every trace one request out of this many (1 traces every request, 0 stops tracing)
+     */
+    void Server::EnableTracing(std::uint32_t sample_every)
+    {
+        this->tracer->SetSampleEvery(sample_every);
+    }
+
+    std::shared_ptr<Tracer> Server::GetTracer() const
+    {
+        return this->tracer;
+    }
+
+    bool Server::WriteTrace(const std::string &trace_file) const
+    {
+        return this->tracer->WriteChromeTrace(trace_file);
+    }
+
+    /**
+     * @brief Record every file transfer (Who, what, when, how many bytes, outcome) in an SQLite journal \n
+     * The rows are written by the journal's own thread in batched transactions
+     *
+     * @param database_file the SQLite database file
+     * @return true if the journal could be opened
+     */
+    bool Server::EnableTransferJournal(const std::string &database_file)
+    {
+        std::shared_ptr<TransferJournal> new_transfer_journal = std::make_shared<TransferJournal>(database_file);
+        if (!new_transfer_journal->IsOpen())
+        {
+            return false;
+        }
+
+        this->transfer_journal = new_transfer_journal;
+        std::cout << "Journaling transfers into " << database_file << std::endl;
+        return true;
+    }
+
+    std::shared_ptr<TransferJournal> Server::GetTransferJournal() const
+    {
+        return this->transfer_journal;
+    }
+
+    /**
+     * @brief Make every client talk in JSON messages (Handled by GetJsonMessage) \n
+     * Default: false
+     *
+     * @param json_mode true to dispatch every frame as a JSON message
+     */
+    void Server::SetJsonMode(bool json_mode)
+    {
+        this->json_mode = json_mode;
+    }
+
+    bool Server::IsJsonMode() const
+    {
+        return this->json_mode;
+    }
+
+    /**
+     * @brief Register the handler of the JSON messages with this "type" \n
+     * The handlers are read by every client thread without locking, so register them before Start()
+     *
+     * @param type the value of the "type" field
+     * @param handler called with the client and the message
+     */
+    void Server::OnJsonMessage(const std::string &type, JsonHandler handler)
+    {
+        this->json_handlers[type] = std::move(handler);
+    }
+
+    /**
+     * @brief Register the handler of the records of the NDJSON streams clients send after an "NDJSON" request \n
+     * The handler is read by every client thread without locking, so register it before Start()
+     *
+     * @param handler called with the client and every record, in order
+     */
+    void Server::OnNdjsonRecord(NdjsonRecordHandler handler)
+    {
+        this->ndjson_record_handler = std::move(handler);
+    }
+
+    /**
+     * @brief Register the handler of one text command, run when a request starts with "<command> " \n
+     * Registering a command again replaces its handler
+     *
+     * @param command the first word of the request (Case-sensitive)
+     * @param handler gets the rest of the request after the space
+     * @return true if registered, false for a built-in command
+     */
+    bool Server::OnCommand(const std::string &command, CommandHandler handler)
+    {
+        if (BUILTIN_COMMANDS.Find(command) != BUILTIN_COMMANDS.NOT_FOUND)
+        {
+            std::cerr << "Error: " << command << " is a built-in command" << std::endl;
+            return false;
+        }
+
+        std::vector<std::string>::iterator registered = std::find(this->command_names.begin(), this->command_names.end(), command);
+        if (registered != this->command_names.end())
+        {
+            this->command_handlers[registered - this->command_names.begin()] = std::move(handler);
+            return true;
+        }
+
+        this->command_names.push_back(command);
+        this->command_handlers.push_back(std::move(handler));
+        return true;
+    }
+
+    /**
+     * @brief Change the directory clients' UPLOAD and DOWNLOAD file names are relative to \n
+     * Default: files
+     *
+     * @param directory the new directory (Empty is ignored)
+     */
+    void Server::SetFilesDirectory(const std::string_view& directory)
+    {
+        if (directory != "")
+        {
+            this->files_directory = directory;
+        }
+    }
+
+    /**
+     * @brief Get the directory of the files clients upload and download by name
+     *
+     * @return std::string_view the files directory
+     */
+    std::string_view Server::GetFilesDirectory() const
+    {
+        return this->files_directory;
+    }
+
+    /**
+     * @brief Change the largest upload accepted when its size is announced \n
+     * Default: 0 (No quota, only the free space of the disk)
+     *
+     * @param max_upload_bytes the quota of one upload in decoded bytes
+     */
+    void Server::SetMaxUploadBytes(std::uint64_t max_upload_bytes)
+    {
+        this->max_upload_bytes = max_upload_bytes;
+    }
+
+    std::uint64_t Server::GetMaxUploadBytes() const
+    {
+        return this->max_upload_bytes;
+    }
+
+    /**
+     * @brief Change how much memory holds hot files, sent from it instead of the disk \n
+     * Only files sent whole as they are (Not ranges) of at most an eighth of it are kept \n
+     * Default: 64 MiB
+     *
+     * @param file_cache_bytes the budget of the cache (0 turns it off)
+     */
+    void Server::SetFileCacheBytes(std::size_t file_cache_bytes)
+    {
+        this->file_cache->SetCapacity(file_cache_bytes);
+    }
+
+    std::size_t Server::GetFileCacheBytes() const
+    {
+        return this->file_cache->Capacity();
+    }
+
+    /**
+     * @brief Change how much memory holds the base 64 encodings SendBinaryFile sends \n
+     * A hot file is encoded once, then every download of it (Even one started while it is encoded) shares the result \n
+     * Default: 64 MiB
+     *
+     * @param encoded_cache_bytes the budget of the cache (0 turns it off)
+     */
+    void Server::SetEncodedCacheBytes(std::size_t encoded_cache_bytes)
+    {
+        this->encoded_file_cache->SetCapacity(encoded_cache_bytes);
+    }
+
+    std::size_t Server::GetEncodedCacheBytes() const
+    {
+        return this->encoded_file_cache->Capacity();
+    }
+
+    /**
+     * @brief Change how many bytes of an NDJSON stream are gathered before they are parsed \n
+     * The memory of a stream stays around one batch plus the longest record \n
+     * Default: 1 MiB
+     *
+     * @param ndjson_batch_size bytes per batch
+     */
+    void Server::SetNdjsonBatchSize(std::size_t ndjson_batch_size)
+    {
+        this->ndjson_batch_size = std::max<std::size_t>(ndjson_batch_size, 1);
+    }
+
+    std::size_t Server::GetNdjsonBatchSize() const
+    {
+        return this->ndjson_batch_size;
+    }
+
+    /**
+     * @brief Check Whether there is an end_signal in the given text
+     * 
+     * @param text text to check
+     * @return true if there is an end_signal
+     * @return false if there is no end_signal
+     */
+    bool Server::HasEndSignal(const std::string_view& text, std::size_t* index_to_del)
+    {
+        bool has_end_signal = false;
+
+        std::size_t found_pos = text.find(this->end_signal, 0);
+        if (found_pos != std::string::npos)
+        {
+            // Found an end_signal
+            std::cout << "Found: " << this->end_signal << " at index: " << found_pos << std::endl;
+            
+            // Return the index_to_del
+            *index_to_del = found_pos;
+
+            // Found an end_signal
+            has_end_signal = true;
+        }
+
+        return has_end_signal;
+    }
+
+    std::string Server::RemoveEndSignal(std::string& text, std::size_t end_signal_index)
+    {
+        return text.substr(0, end_signal_index);
+    }
+
+    /**
+     * @brief Build one immutable frame in a recycled buffer: text followed by the end_signal
+     *
+     * @param text the payload of the frame
+     * @return SharedBuffer the frame, shareable by many send queues
+     */
+    SharedBuffer Server::MakeFrame(const std::string_view &text) const
+    {
+        std::unique_ptr<std::string> frame = this->output_buffers->Acquire();
+        frame->reserve(text.size() + this->end_signal.size());
+        frame->append(text);
+        frame->append(this->end_signal);
+        return this->output_buffers->Share(std::move(frame));
+    }
+
+    /**
+     * @brief Send an end signal to the client_socket
+     * 
+     * @param client_socket the client_socket to send
+     */
+    void Server::SendEndSignal(std::shared_ptr<ClientConnection> client_socket)
+    {
+        // Error if Thrown
+        boost::system::error_code error;
+
+        // Send an end signal of the Text
+        client_socket->Write(
+                boost::asio::buffer(this->end_signal),
+            error
+        );
+
+        // Check error
+        if (error)
+        {
+            std::cerr << "Error: " << error.message() << std::endl;
+        }
+    }
+
+    //* INFO: For Sending Protocol Method
+    /**
+     * @brief For Sending Simple Text To a Specify client_socket
+     *
+     * @param client_socket The Socket Want to Send
+     * @param text The Text To Send
+     */
+    void Server::SendText(std::shared_ptr<ClientConnection> client_socket, const std::string_view &text)
+    {
+        // Error if Thrown
+        boost::system::error_code error;
+
+        TraceSpan span("reply");
+
+        // On Shared Memory The Ring Record Is The Frame: No end_signal
+        if (std::shared_ptr<SharedMemoryChannel> channel = this->FindSharedMemory(client_socket.get()))
+        {
+            this->SendToSharedMemory(client_socket, channel, text);
+            return;
+        }
+
+        // The Text And Its end_signal Go Out As One Frame Through The Send Queue,
+        // So A Broadcast Can Never Land In The Middle Of It
+        std::size_t total_sent = client_socket->Send(this->MakeFrame(text), error);
+
+        // Check If All data has been sent
+        if (!error)
+        {
+            std::cout << "Message sent successfully to "
+                      << client_socket->RemoteAddress()
+                      << std::endl;
+        }
+        else
+        {
+            std::cerr << "Error: " << error.message() << std::endl;
+            std::cerr << "Not all data sent. Total sent: " << total_sent << " bytes out of " << text.size() + this->end_signal.size() << " bytes." << std::endl;
+        }
+    }
+
+    /**
+     * @brief Queue the same text to every connected client and return immediately \n
+     * The frame is built once and shared by every send queue, a slow client only delays itself \n
+     * A client in the middle of a request gets it right after the reply (See ClientConnection::AsyncSend)
+     *
+     * @param text The Text To Send
+     * @return std::size_t how many clients the frame was queued to
+     */
+    std::size_t Server::Broadcast(const std::string_view &text)
+    {
+        return this->Broadcast(this->MakeFrame(text));
+    }
+
+    /**
+     * @brief Queue an already built frame (e.g. from MakeJsonFrame) to every connected client
+     *
+     * @param frame the whole frame, end_signal included
+     * @return std::size_t how many clients the frame was queued to
+     */
+    std::size_t Server::Broadcast(SharedBuffer frame)
+    {
+        std::size_t queued_clients = 0;
+
+        // Send Outside The Lock: Under OverflowBlock One Slow Client Must Not Hold Up Accepting Others
+        std::vector<std::shared_ptr<ClientConnection>> receivers;
+        {
+            std::lock_guard<std::mutex> lock(this->clients_mutex);
+            receivers.assign(this->clients_connections.begin(), this->clients_connections.end());
+        }
+
+        for (const std::shared_ptr<ClientConnection> &client_socket : receivers)
+        {
+            SendOutcome outcome = client_socket->AsyncSend(frame, [client_socket](const boost::system::error_code &error, std::size_t) {
+                if (error)
+                {
+                    std::cerr << "Broadcast to " << client_socket->RemoteAddress() << " failed: " << error.message() << std::endl;
+                }
+            });
+
+            if (outcome != SendOutcome::SendRejected)
+            {
+                queued_clients++;
+            }
+        }
+
+        return queued_clients;
+    }
+
+    /**
+     * @brief Build a JSON frame in a pooled buffer: write_json fills it, the end_signal is added after \n
+     * The bytes written are the bytes sent, no std::string is built in between
+     *
+     * @param write_json writes one JSON value with the given writer
+     * @return SharedBuffer the frame, ready for AsyncSend/Broadcast
+     */
+    SharedBuffer Server::MakeJsonFrame(const std::function<void(JsonWriter &)> &write_json)
+    {
+        std::unique_ptr<std::string> frame = this->output_buffers->Acquire();
+        JsonWriter json_writer(*frame);
+        write_json(json_writer);
+
+        if (!json_writer.IsComplete())
+        {
+            std::cerr << "Warning: JSON frame has unclosed objects or arrays" << std::endl;
+        }
+
+        frame->append(this->end_signal);
+        return this->output_buffers->Share(std::move(frame));
+    }
+
+    /**
+     * @brief Send one JSON message to the client_socket and wait until it is written
+     *
+     * @param client_socket The client_socket to send to
+     * @param write_json writes the message with the given writer
+     */
+    void Server::SendJson(std::shared_ptr<ClientConnection> client_socket, const std::function<void(JsonWriter &)> &write_json)
+    {
+        SharedBuffer frame = this->MakeJsonFrame(write_json);
+        if (std::shared_ptr<SharedMemoryChannel> channel = this->FindSharedMemory(client_socket.get()))
+        {
+            this->SendToSharedMemory(client_socket, channel, std::string_view(*frame).substr(0, frame->size() - this->end_signal.size()));
+            return;
+        }
+
+        boost::system::error_code error;
+        client_socket->Send(std::move(frame), error);
+        if (error)
+        {
+            std::cerr << "Error: " << error.message() << std::endl;
+        }
+    }
+
+    /**
+     * @brief Call This Function within server object to send a Text-Based Formats \n
+     * For Sending Files ends with: \n
+     * 1. Plain Text Files (.txt) \n
+     * 2. JSON Files (.json) \n
+     * 3. XML Files (.xml) \n
+     * 4. CSV Files (.csv) \n
+     * 5. TCV Files (.tsx) \n
+     * And Many More...
+     *
+     * @param client_socket The client_socket to send the File
+     * @param file_to_send The file directory to send
+     */
+    void Server::SendTextBasedFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_send)
+    {
+        std::uint64_t total_sent = 0;
+        bool completed = this->SendFileFrame(client_socket, file_to_send, total_sent);
+        this->JournalTransfer(client_socket, "SendTextBasedFile", file_to_send, total_sent, completed ? "ok" : "incomplete");
+    }
+
+    /**
+     * @brief Send the file (Or length bytes of it from offset), the end_signal and (If enabled) the integrity trailer \n
+     * A send cut short closes the client instead of ending the frame
+     *
+     * @param client_socket The client_socket to send the File
+     * @param file_to_send The file directory to send
+     * @param total_sent set to the bytes sent (Of the encoded text with encode_base64)
+     * @param encode_base64 send the base 64 encoding of the file instead of its bytes
+     * @param offset the first byte to send
+     * @param length how many bytes to send at most (The rest of the file by default)
+     * @return true if every byte asked for was sent
+     */
+    bool Server::SendFileFrame(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_send, std::uint64_t &total_sent, bool encode_base64, std::uint64_t offset, std::uint64_t length)
+    {
+        // The Variable To check For The Bytes Have Send
+        total_sent = 0;
+
+        // Checksums Of The Bytes Sent
+        TransferChecksum checksum(this->transfer_integrity);
+
+        // A Hot File Sent Whole Is Queued As The Cached Buffer (Or Encoding), Shared With Every Other Download Of It
+        SharedBuffer cached_file;
+        if (offset == 0 && length == UINT64_MAX)
+        {
+            cached_file = (encode_base64 ? this->encoded_file_cache : this->file_cache)->Get(file_to_send);
+        }
+
+        bool completed = false;
+        if (cached_file)
+        {
+            boost::system::error_code error;
+            checksum.Update(*cached_file);
+            total_sent = client_socket->Send(cached_file, error);
+            completed = !error && total_sent == cached_file->size();
+            if (error)
+            {
+                std::cerr << "Error: " << error.message() << std::endl;
+            }
+        }
+        else
+        {
+            // Open The File To Send
+            int file_descriptor = ::open(file_to_send.c_str(), O_RDONLY | O_CLOEXEC);
+
+            // Check If the File Open Successfully
+            struct stat file_status;
+            if (file_descriptor < 0 || ::fstat(file_descriptor, &file_status) != 0)
+            {
+                std::cerr << "Error: Unable to open TEXT file " << file_to_send << std::endl;
+                if (file_descriptor >= 0)
+                {
+                    ::close(file_descriptor);
+                }
+                return false;
+            }
+            const std::uint64_t file_size = static_cast<std::uint64_t>(file_status.st_size);
+            offset = std::min(offset, file_size);
+            length = std::min(length, file_size - offset);
+
+            completed = this->SendFileBytes(client_socket, file_descriptor, checksum, total_sent, encode_base64, offset, length);
+
+            // Close the File after Sending
+            ::close(file_descriptor);
+        }
+
+        if (!completed)
+        {
+            // Cut Short: An end_signal Now Would Pass The Partial File Off As The Whole One, The Client Only Sees It Closed
+            std::cerr << "Not all data sent. Total sent: " << total_sent << " bytes of " << file_to_send
+                      << ", closing " << client_socket->RemoteAddress() << std::endl;
+            client_socket->Close();
+            return false;
+        }
+        std::cout << "All data sent successfully to " << client_socket->RemoteAddress() << "!" << std::endl;
+
+        //! Send an end signal
+        this->SendEndSignal(client_socket);
+
+        //! Send the integrity trailer
+        if (this->transfer_integrity != TransferIntegrity::IntegrityNone)
+        {
+            this->SendText(client_socket, checksum.FinalTrailer());
+        }
+
+        return completed;
+    }
+
+    /**
+     * @brief Send length bytes from offset of a file already open (No end_signal, no trailer) \n
+     * Without anything to look at the connection sends straight from the file (sendfile on plain TCP), \n
+     * otherwise a disk thread reads the next blocks (Through its own duplicate of the descriptor) while this one is sent
+     *
+     * @param client_socket The client_socket to send the bytes
+     * @param file_descriptor the open file (Still open when this returns)
+     * @param checksum updated with every byte sent (Encoded, with encode_base64)
+     * @param total_sent increased by the bytes sent (Of the encoded text with encode_base64)
+     * @param encode_base64 send the base 64 encoding of the bytes instead
+     * @param offset the first byte to send
+     * @param length how many bytes of the file to send
+     * @return true if all length bytes were sent (False if the file shrank meanwhile, a read failed or the client went away)
+     */
+    bool Server::SendFileBytes(std::shared_ptr<ClientConnection> client_socket, int file_descriptor, TransferChecksum &checksum, std::uint64_t &total_sent, bool encode_base64, std::uint64_t offset, std::uint64_t length)
+    {
+        // Error if Thrown
+        boost::system::error_code error;
+
+        bool completed = false;
+        if (this->transfer_integrity == TransferIntegrity::IntegrityNone && !encode_base64)
+        {
+            // Nothing To Look At -> Let The Connection Send Straight From The File (sendfile On Plain TCP)
+            std::uint64_t bytes_sent = client_socket->SendFile(file_descriptor, offset, length, error);
+            total_sent += bytes_sent;
+            completed = !error && bytes_sent == length;
+        }
+        else
+        {
+            // The Bytes Are Needed Here -> A Disk Thread Reads The Next Blocks While This One Is Sent
+            // (Base 64 Blocks Are A Multiple Of 3 Bytes, So Their Encodings Join Into The Encoding Of The File)
+            std::size_t block_size = encode_base64 ? 3 * 64 * 1024 : std::max<std::size_t>(this->CHUNK_SIZE, 64 * 1024);
+            std::shared_ptr<DiskReader> reader = this->disk_executor->OpenReader(file_descriptor, block_size, offset, length);
+            if (!reader)
+            {
+                return false;
+            }
+
+            std::uint64_t bytes_read = 0;
+            std::unique_ptr<std::string> block;
+            std::string encoded;
+            while (!error && reader->Read(block))
+            {
+                bytes_read += block->size();
+                std::string_view bytes(*block);
+                if (encode_base64)
+                {
+                    encoded = base64_encode(reinterpret_cast<const BYTE *>(block->data()), static_cast<unsigned int>(block->size()));
+                    bytes = encoded;
+                }
+                checksum.Update(bytes);
+
+                // Synchronous write
+                total_sent += client_socket->Write(boost::asio::buffer(bytes.data(), bytes.size()), error);
+                reader->Release(std::move(block));
+            }
+
+            // The Reader Stops At The End Of The File: Fewer Bytes Than Asked For If It Shrank Meanwhile
+            completed = !error && !reader->HasFailed() && bytes_read == length;
+        }
+
+        // Check If All data has been sent
+        if (error)
+        {
+            std::cerr << "Error: " << error.message() << std::endl;
+        }
+        return completed;
+    }
+
+    /**
+     * @brief Send only a range of a file, as its raw bytes straight from the file (sendfile) \n
+     * 1. Server replies "RANGE <offset> <length> <file size>", or "ERROR ..." if the range does not fit the file \n
+     * 2. Then exactly <length> bytes of the file from <offset>, the end_signal and (If enabled) the integrity trailer \n
+     * The client reads <length> bytes before looking for the end_signal (Raw bytes may contain it) \n
+     * Several connections can each fetch a part of one large file, a client can resume from what it has ("<bytes>-") \n
+     * or follow the tail of a growing log ("-<bytes>", or "<bytes>-" again later) \n
+     * The header and the bytes come from one open file: a log rotated meanwhile is still sent as announced. \n
+     * If it is truncated and fewer than <length> bytes can be sent, the connection is closed instead of \n
+     * sending the end_signal, as the client would otherwise take what follows for the missing bytes
+     *
+     * @param client_socket The client_socket to send the range
+     * @param file_to_send The file directory to send
+     * @param range "<first>-<last>" (Both included), "<first>-" (To the end) or "-<bytes>" (The last bytes)
+     * @return true if the whole range was sent
+     */
+    bool Server::SendFileRange(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_send, std::string_view range)
+    {
+        int file_descriptor = ::open(file_to_send.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat file_status;
+        if (file_descriptor < 0 || ::fstat(file_descriptor, &file_status) != 0 || !S_ISREG(file_status.st_mode))
+        {
+            if (file_descriptor >= 0)
+            {
+                ::close(file_descriptor);
+            }
+            this->SendText(client_socket, "ERROR no such file");
+            return false;
+        }
+
+        // The Size Goes With The Error, So A Client Can Ask Again Within It
+        const std::uint64_t file_size = static_cast<std::uint64_t>(file_status.st_size);
+        std::uint64_t offset = 0;
+        std::uint64_t length = 0;
+        if (!ResolveByteRange(range, file_size, offset, length))
+        {
+            ::close(file_descriptor);
+            this->SendText(client_socket, "ERROR invalid range " + std::to_string(file_size));
+            return false;
+        }
+
+        this->SendText(client_socket, "RANGE " + std::to_string(offset) + " " + std::to_string(length) + " " + std::to_string(file_size));
+
+        TransferChecksum checksum(this->transfer_integrity);
+        std::uint64_t total_sent = 0;
+        bool completed = this->SendFileBytes(client_socket, file_descriptor, checksum, total_sent, false, offset, length);
+        ::close(file_descriptor);
+
+        if (!completed)
+        {
+            // The Client Counts Raw Bytes: Anything Sent Now Would Be Read As Part Of The Range
+            std::cerr << "Not all data sent. Total sent: " << total_sent << " of " << length << " bytes of " << file_to_send
+                      << ", closing " << client_socket->RemoteAddress() << std::endl;
+            client_socket->Close();
+            this->JournalTransfer(client_socket, "SendFileRange", file_to_send, total_sent, "incomplete");
+            return false;
+        }
+
+        //! Send an end signal
+        this->SendEndSignal(client_socket);
+
+        //! Send the integrity trailer
+        if (this->transfer_integrity != TransferIntegrity::IntegrityNone)
+        {
+            this->SendText(client_socket, checksum.FinalTrailer());
+        }
+
+        this->JournalTransfer(client_socket, "SendFileRange", file_to_send, total_sent, "ok");
+        return true;
+    }
+
+    /**
+     * @brief Call This Function within server object to send a Binary File Formats \n
+     * For Sending Files likes: \n
+     * 1. Image Files (.jpg, .png, .gif, etc.) \n
+     * 2. Binary Documents (.pdf, .docx, .xlsx, etc.) \n
+     * 3. Executable Files (.exe) \n
+     * 4. Compressed Archives (.zip, .tar, .gz, etc.) \n
+     *
+     * @param client_socket The client_socket to send the File
+     * @param file_to_send The file directory to send
+     */
+    void Server::SendBinaryFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_send)
+    {
+        // FIXME: Sending Binary Files
+        //! Approach 1: Encoding Base 64
+        // A Hot File Goes Out As Its Cached Encoding, Others Are Encoded Block By Block While A Disk Thread Reads Ahead (No Temp File)
+        std::uint64_t total_sent = 0;
+        bool completed = this->SendFileFrame(client_socket, file_to_send, total_sent, true);
+        this->JournalTransfer(client_socket, "SendBinaryFile", file_to_send, total_sent, completed ? "ok" : "incomplete");
+
+        // //! Approach 2: Send Binary
+        // // Open The Binary Files
+        // std::ifstream binary_file(file_to_send, std::ios::binary);
+
+        // // Check If the file has opened successfully
+        // if (!binary_file.is_open())
+        // {
+        //     std::cerr << "Error: Unable to open binary file " << file_to_send << std::endl;
+        //     return;
+        // }
+
+        // // The Varible to check for the bytes sent
+        // std::size_t total_sent = 0;
+
+        // // Make A Buffer to send
+        // char buffer[this->CHUNK_SIZE];
+        // while (binary_file.read(buffer, this->CHUNK_SIZE))
+        // {
+        //     // Synchronous write
+        //     boost::system::error_code error;
+        //     std::size_t bytes_sent = client_socket->Write(boost::asio::buffer(buffer, binary_file.gcount()), error);
+
+        //     // Check whether an error happened
+        //     if (!error)
+        //     {
+        //         total_sent += bytes_sent;
+        //         std::cout << "Bytes chunk sent successfully to "
+        //                   << client_socket->remote_endpoint().address() << ":"
+        //                   << client_socket->remote_endpoint().port()
+        //                   << std::endl;
+        //     }
+        //     else
+        //     {
+        //         std::cerr << "Error: " << error.message() << std::endl;
+        //         break; // Break the loop on error
+        //     }
+        // }
+
+        // // Check for end-of-file or error
+        // if (binary_file.eof())
+        // {
+        //     std::cout << "All data sent successfully!" << std::endl;
+        // }
+        // else if (binary_file.fail())
+        // {
+        //     std::cerr << "Error reading binary file: " << file_to_send << std::endl;
+        // }
+
+        // // Check if all data has been sent
+        // if (total_sent == boost::filesystem::file_size(file_to_send))
+        // {
+        //     std::cout << "All data sent successfully!" << std::endl;
+        // }
+        // else
+        // {
+        //     std::cerr << "Not all data sent. Total sent: " << total_sent << " bytes out of "
+        //               << boost::filesystem::file_size(file_to_send) << " bytes." << std::endl;
+        // }
+
+        // // Close the file after sending successfully
+        // binary_file.close();
+    }
+
+    //* INFO: For Receiving Protocol Method
+    // Simple I/O Get Protocol
+    ClientConnectionStatus Server::GetText(std::shared_ptr<ClientConnection> client_socket, std::string &received_text)
+    {
+        // Variable o calculate bytes received
+        std::size_t total_received = 0;
+
+        // Read Until The end_signal
+        ClientConnectionStatus client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            // Append the received data to the text
+            total_received += chunk.size();
+            received_text.append(chunk);
+        });
+
+        if (client_connection_status == ClientConnectionStatus::ConnectionOpen)
+        {
+            // INFO: Receive Text Here
+            std::cout << "Received text: " << received_text << std::endl;
+        }
+
+        // Process the received text (you can modify this part based on your needs)
+        std::cout << "Send A Total Bytes of: " << total_received << std::endl;
+
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Use this method to get the Text-Based Data File From the given clien_socket and Store in the file_to_store directories
+     * 
+     * @param client_socket The client_socket sent from
+     * @param file_to_store The Place to store the Data
+     */
+    ClientConnectionStatus Server::GetTextBasedFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store)
+    {
+        // Return Value
+        ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
+
+        // Receive Into A File Of This Transfer Only, Moved Onto file_to_store Once Complete
+        // (Concurrent Uploads Of The Same File Never Write Into Each Other)
+        std::string transfer_file = CreateTransferFile(file_to_store);
+
+        // Open The file to store the received data (Written By A Disk Thread, This One Only Fills Blocks)
+        std::shared_ptr<DiskWriter> received_file = transfer_file.empty() ? nullptr : this->disk_executor->OpenWriter(transfer_file);
+
+        // Check if the file is opened successfully
+        if (!received_file)
+        {
+            std::cerr << "Error: Unable to open file for receiving data " << file_to_store << std::endl;
+            return client_connection_status;
+        }
+
+        // Amount of bytes received
+        std::size_t total_received = 0;
+
+        // Checksums Computed While The Bytes Arrive
+        TransferChecksum checksum(this->transfer_integrity);
+
+        client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            // Hand The Bytes To The Disk Thread (Waits Only While It Is queue_depth Blocks Behind)
+            {
+                TraceSpan span("disk queue");
+                received_file->Write(chunk);
+            }
+            checksum.Update(chunk);
+
+            total_received += chunk.size();
+            std::cout << "Received " << chunk.size() << " bytes from "
+                      << client_socket->RemoteAddress()
+                      << std::endl;
+        });
+
+        // Check If All data has been received
+        if (total_received > 0)
+        {
+            std::cout << "All data received successfully!" << std::endl;
+        }
+        else
+        {
+            std::cerr << "No data received or an error occurred." << std::endl;
+        }
+
+        // Wait For The Disk Thread, Then Close the file after receiving data
+        bool is_written = received_file->Finish();
+
+        // Compare With The Client's Checksums
+        // Only A Complete, Intact Transfer Replaces file_to_store
+        bool intact = this->VerifyIntegrityTrailer(client_socket, checksum, client_connection_status);
+        bool is_complete = client_connection_status != ClientConnectionStatus::ConnectionClose;
+        bool stored = is_complete && intact && is_written && CommitTransferFile(transfer_file, file_to_store);
+        if (!stored)
+        {
+            std::remove(transfer_file.c_str());
+        }
+        this->JournalTransfer(
+            client_socket, "GetTextBasedFile", file_to_store, total_received,
+            !is_complete ? "incomplete" : !intact ? "mismatch" : stored ? "ok" : "failed"
+        );
+
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Use this function to get The Binary-Text File from the Client_socket and Store in the file_to_store
+     * 
+     * @param client_socket The client_socket sent from
+     * @param file_to_store The file to place data into
+     */
+    ClientConnectionStatus Server::GetBinaryFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store)
+    {
+        // Return Value
+        ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
+
+        //! Decode Base 64
+        // Put All the data into a temp file of this transfer only
+        // (Concurrent Uploads Of The Same File Never Write Into Each Other)
+        std::string temp_file = CreateTransferFile(createTempFile(file_to_store));
+
+        // Open The file to store the received data (Written By A Disk Thread, This One Only Fills Blocks)
+        std::shared_ptr<DiskWriter> received_file = temp_file.empty() ? nullptr : this->disk_executor->OpenWriter(temp_file);
+
+        // Check if the file is opened successfully
+        if (!received_file)
+        {
+            std::cerr << "Error: Unable to open file for receiving data " << file_to_store << std::endl;
+            return client_connection_status;
+        }
+
+        // Amount of bytes received
+        std::size_t total_received = 0;
+
+        // Checksums Computed While The Bytes Arrive (Over The Base64 Text As Sent)
+        TransferChecksum checksum(this->transfer_integrity);
+
+        client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            // Hand The Bytes To The Disk Thread (Waits Only While It Is queue_depth Blocks Behind)
+            {
+                TraceSpan span("disk queue");
+                received_file->Write(chunk);
+            }
+            checksum.Update(chunk);
+
+            total_received += chunk.size();
+            std::cout << "Received " << chunk.size() << " bytes from "
+                      << client_socket->RemoteAddress()
+                      << std::endl;
+        });
+
+        // Check If All data has been received
+        if (total_received > 0)
+        {
+            std::cout << "All data received successfully!" << std::endl;
+        }
+        else
+        {
+            std::cerr << "No data received or an error occurred." << std::endl;
+        }
+
+        // Wait For The Disk Thread, Then Close the Received File
+        bool is_written = received_file->Finish();
+
+        // Compare With The Client's Checksums
+        // A Damaged Transfer Is Not Decoded Over The Previous file_to_store
+        // A Cut-Off Transfer Is Not Decoded Either
+        bool intact = this->VerifyIntegrityTrailer(client_socket, checksum, client_connection_status);
+        bool is_complete = client_connection_status != ClientConnectionStatus::ConnectionClose;
+        bool stored = false;
+        if (is_complete && intact && is_written)
+        {
+            // Decode Into Another File Of This Transfer, Then Move It Onto file_to_store At Once
+            TraceSpan span("decode file");
+            std::string decoded_file = CreateTransferFile(file_to_store);
+            stored = !decoded_file.empty() && decodeFileToFile(temp_file, decoded_file) && CommitTransferFile(decoded_file, file_to_store);
+            if (!stored)
+            {
+                std::remove(decoded_file.c_str());
+            }
+        }
+        this->JournalTransfer(
+            client_socket, "GetBinaryFile", file_to_store, total_received,
+            !is_complete ? "incomplete" : !intact ? "mismatch" : stored ? "ok" : "failed"
+        );
+
+        // Remove the temporary file
+        std::remove(temp_file.c_str());
+
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Get a Binary File whose size the client announced, straight into a preallocated file \n
+     * 1. The upload is refused at once ("ERROR ...") if it is over the quota or the free space of the disk \n
+     * 2. Otherwise the whole size is reserved with fallocate() and the client is told "SEND" \n
+     * 3. The base64 frame is decoded while it arrives and written with pwrite() into the reserved extent (No temp file) \n
+     * 4. Server replies "UPLOADED <bytes>" once it is at file_to_store, or "ERROR ..." if the size did not match
+     *
+     * @param client_socket The client_socket sent from
+     * @param file_to_store The file to place data into
+     * @param file_size the announced size of the decoded file
+     */
+    ClientConnectionStatus Server::GetSizedBinaryFile(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store, std::uint64_t file_size)
+    {
+        ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
+
+        //* Refuse What Cannot Fit Before A Byte Is Sent
+        if (this->max_upload_bytes > 0 && file_size > this->max_upload_bytes)
+        {
+            this->SendText(client_socket, "ERROR upload too large");
+            this->JournalTransfer(client_socket, "GetSizedBinaryFile", file_to_store, 0, "rejected");
+            return client_connection_status;
+        }
+
+        std::string transfer_file = CreateTransferFile(file_to_store);
+        if (!transfer_file.empty() && file_size > FreeDiskBytes(transfer_file))
+        {
+            std::remove(transfer_file.c_str());
+            this->SendText(client_socket, "ERROR not enough disk space");
+            this->JournalTransfer(client_socket, "GetSizedBinaryFile", file_to_store, 0, "rejected");
+            return client_connection_status;
+        }
+
+        // One Extent For The Whole File, Instead Of Growing It Chunk By Chunk
+        std::shared_ptr<DiskWriter> received_file = transfer_file.empty() ? nullptr : this->disk_executor->OpenWriter(transfer_file, 256 * 1024, file_size);
+        if (!received_file)
+        {
+            std::remove(transfer_file.c_str());
+            this->SendText(client_socket, "ERROR unable to store the file");
+            this->JournalTransfer(client_socket, "GetSizedBinaryFile", file_to_store, 0, "rejected");
+            return client_connection_status;
+        }
+        this->SendText(client_socket, "SEND");
+
+        //* Decode While The Frame Arrives
+        std::uint64_t total_received = 0;
+        std::uint64_t total_decoded = 0;
+        TransferChecksum checksum(this->transfer_integrity);
+
+        Base64FrameDecoder decoder;
+        auto write_decoded = [&](const std::vector<BYTE> &decoded) {
+            // Past The Announced Size Nothing More Is Written (The Upload Fails Anyway)
+            total_decoded += decoded.size();
+            if (!decoded.empty() && total_decoded <= file_size)
+            {
+                TraceSpan span("disk queue");
+                received_file->Write(std::string_view(reinterpret_cast<const char *>(decoded.data()), decoded.size()));
+            }
+        };
+
+        client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            checksum.Update(chunk);
+            total_received += chunk.size();
+            write_decoded(decoder.Feed(chunk));
+        });
+        write_decoded(decoder.Finish());
+
+        // Wait For The Disk Thread (A Short File Is Cut Back To What Was Written)
+        bool is_written = received_file->Finish();
+
+        // Compare With The Client's Checksums
+        bool intact = this->VerifyIntegrityTrailer(client_socket, checksum, client_connection_status);
+        bool is_complete = client_connection_status != ClientConnectionStatus::ConnectionClose;
+        bool is_whole = total_decoded == file_size;
+        bool stored = is_complete && intact && is_written && is_whole && CommitTransferFile(transfer_file, file_to_store);
+        if (!stored)
+        {
+            std::remove(transfer_file.c_str());
+        }
+
+        if (stored)
+        {
+            std::cout << "Stored " << total_decoded << " bytes at " << file_to_store
+                      << " (" << received_file->DirectBytesWritten() << " With Direct I/O)" << std::endl;
+            this->SendText(client_socket, "UPLOADED " + std::to_string(total_decoded));
+        }
+        else if (is_complete && intact)
+        {
+            // A Damaged Transfer Was Already Told MISMATCH By The Trailer Check
+            this->SendText(client_socket, is_whole ? "ERROR unable to store the file" : "ERROR size mismatch " + std::to_string(total_decoded));
+        }
+
+        this->JournalTransfer(
+            client_socket, "GetSizedBinaryFile", file_to_store, total_received,
+            !is_complete ? "incomplete" : !intact ? "mismatch" : stored ? "ok" : "failed"
+        );
+
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Run one "STRIPE <action> ..." request of a striped upload \n
+     * A file is opened once, then several connections send numbered block ranges of it at the same time: \n
+     * "STRIPE OPEN <file> size=<bytes>" -> "STRIPE <transfer id> <block size> <block count>" \n
+     * "STRIPE PUT <transfer id> <first block> <block count>" then the base 64 frame of those blocks (See GetStripe) \n
+     * "STRIPE STATUS <transfer id>" -> "STRIPE MISSING <received>/<block count> <first-last,...>" \n
+     * "STRIPE ABORT <transfer id>" -> "STRIPE ABORTED"
+     *
+     * @param client_socket the client the request comes from
+     * @param arguments what follows "STRIPE "
+     * @return ClientConnectionStatus ConnectionClose if the client closed
+     */
+    ClientConnectionStatus Server::HandleStripeRequest(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments)
+    {
+        std::string_view action = TakeWord(arguments);
+        if (action == "OPEN")
+        {
+            return this->OpenStripedUpload(client_socket, arguments);
+        }
+        if (action == "PUT")
+        {
+            return this->GetStripe(client_socket, arguments);
+        }
+
+        std::string transfer_id(TakeWord(arguments));
+        if (action == "STATUS")
+        {
+            std::shared_ptr<StripedTransfer> transfer = this->striped_uploads->Find(transfer_id);
+            if (!transfer)
+            {
+                this->SendText(client_socket, "ERROR unknown transfer");
+            }
+            else
+            {
+                this->SendText(client_socket, "STRIPE MISSING " + std::to_string(transfer->ReceivedCount()) + "/" +
+                                                  std::to_string(transfer->BlockCount()) + " " + transfer->MissingRanges());
+            }
+        }
+        else if (action == "ABORT")
+        {
+            this->SendText(client_socket, this->striped_uploads->Abort(transfer_id) ? "STRIPE ABORTED" : "ERROR unknown transfer");
+        }
+        else
+        {
+            this->SendText(client_socket, "ERROR unknown stripe request " + std::string(action));
+        }
+        return ClientConnectionStatus::ConnectionOpen;
+    }
+
+    /**
+     * @brief Answer "STRIPE OPEN <file> size=<bytes>": reserve the whole file and give the transfer its ID \n
+     * Refused like GetSizedBinaryFile: over the quota or the free space of the disk \n
+     * The file is cut into blocks of STRIPE_BLOCK_SIZE, the last one may be short
+     *
+     * @param client_socket the client the request comes from
+     * @param arguments "<file> size=<bytes>"
+     * @return ClientConnectionStatus ConnectionOpen (Nothing more is read)
+     */
+    ClientConnectionStatus Server::OpenStripedUpload(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments)
+    {
+        ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
+
+        bool has_size = false;
+        std::uint64_t file_size = 0;
+        if (!TakeSizeOption(arguments, has_size, file_size) || !has_size)
+        {
+            this->SendText(client_socket, "ERROR invalid size");
+            return client_connection_status;
+        }
+
+        std::string path;
+        if (!this->ResolveClientPath(arguments, path))
+        {
+            this->SendText(client_socket, "ERROR invalid file name");
+            return client_connection_status;
+        }
+
+        if (this->max_upload_bytes > 0 && file_size > this->max_upload_bytes)
+        {
+            this->SendText(client_socket, "ERROR upload too large");
+            this->JournalTransfer(client_socket, "OpenStripedUpload", path, 0, "rejected");
+            return client_connection_status;
+        }
+
+        std::string transfer_file = CreateTransferFile(path);
+        if (!transfer_file.empty() && file_size > FreeDiskBytes(transfer_file))
+        {
+            std::remove(transfer_file.c_str());
+            this->SendText(client_socket, "ERROR not enough disk space");
+            this->JournalTransfer(client_socket, "OpenStripedUpload", path, 0, "rejected");
+            return client_connection_status;
+        }
+
+        std::shared_ptr<StripedTransfer> transfer = std::make_shared<StripedTransfer>(transfer_file, path, file_size, STRIPE_BLOCK_SIZE);
+        if (transfer_file.empty() || !transfer->Reserve())
+        {
+            std::remove(transfer_file.c_str());
+            this->SendText(client_socket, "ERROR unable to store the file");
+            this->JournalTransfer(client_socket, "OpenStripedUpload", path, 0, "rejected");
+            return client_connection_status;
+        }
+
+        // Nothing To Wait For: An Empty File Is Complete Already
+        if (transfer->BlockCount() == 0)
+        {
+            bool stored = CommitTransferFile(transfer_file, path);
+            if (!stored)
+            {
+                std::remove(transfer_file.c_str());
+            }
+            this->SendText(client_socket, stored ? "STRIPE DONE 0" : "ERROR unable to store the file");
+            this->JournalTransfer(client_socket, "OpenStripedUpload", path, 0, stored ? "ok" : "failed");
+            return client_connection_status;
+        }
+
+        std::string transfer_id = this->striped_uploads->Add(transfer);
+        if (transfer_id.empty())
+        {
+            std::remove(transfer_file.c_str());
+            this->SendText(client_socket, "ERROR unable to open the transfer");
+            this->JournalTransfer(client_socket, "OpenStripedUpload", path, 0, "rejected");
+            return client_connection_status;
+        }
+        this->WatchStripedUpload(transfer_id);
+
+        this->SendText(client_socket, "STRIPE " + transfer_id + " " + std::to_string(transfer->BlockSize()) + " " + std::to_string(transfer->BlockCount()));
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Get one stripe of a striped upload: "STRIPE PUT <transfer id> <first block> <block count>" \n
+     * 1. The base 64 frame of those blocks follows the request at once (No reply in between, so stripes pipeline) \n
+     * 2. It is decoded while it arrives and written with pwrite() at the blocks' offset, through its own descriptor \n
+     * 3. Server replies "STRIPE OK <received>/<block count>", or "STRIPE DONE <bytes>" to the stripe that completed \n
+     *    the file (It is then at its place), or "ERROR ..." (The blocks stay missing and can be sent again)
+     *
+     * @param client_socket the client the stripe comes from
+     * @param arguments "<transfer id> <first block> <block count>"
+     * @return ClientConnectionStatus ConnectionClose if the client closed
+     */
+    ClientConnectionStatus Server::GetStripe(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments)
+    {
+        std::string transfer_id(TakeWord(arguments));
+        std::uint64_t first_block = 0;
+        std::uint64_t block_count = 0;
+        bool is_parsed = ParseUnsigned(TakeWord(arguments), first_block) && ParseUnsigned(arguments, block_count);
+
+        std::shared_ptr<StripedTransfer> transfer = this->striped_uploads->Find(transfer_id);
+        std::uint64_t offset = 0;
+        std::uint64_t stripe_size = 0;
+        bool is_valid_range = transfer && is_parsed && transfer->GetRange(first_block, block_count, offset, stripe_size);
+
+        std::shared_ptr<DiskWriter> stripe_file;
+        if (is_valid_range)
+        {
+            transfer->BeginStripe();
+            stripe_file = this->disk_executor->OpenRangeWriter(transfer->TransferFile(), offset);
+        }
+
+        //* The Frame Is Read Even When It Cannot Be Used, So The Next Request Starts In The Right Place
+        std::uint64_t total_received = 0;
+        std::uint64_t total_decoded = 0;
+        TransferChecksum checksum(this->transfer_integrity);
+
+        Base64FrameDecoder decoder;
+        auto write_decoded = [&](const std::vector<BYTE> &decoded) {
+            // Past The Stripe Nothing More Is Written (It Fails Anyway)
+            total_decoded += decoded.size();
+            if (stripe_file && !decoded.empty() && total_decoded <= stripe_size)
+            {
+                TraceSpan span("disk queue");
+                stripe_file->Write(std::string_view(reinterpret_cast<const char *>(decoded.data()), decoded.size()));
+            }
+        };
+
+        ClientConnectionStatus client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            checksum.Update(chunk);
+            total_received += chunk.size();
+            write_decoded(decoder.Feed(chunk));
+        });
+        write_decoded(decoder.Finish());
+
+        bool is_written = stripe_file && stripe_file->Finish();
+        if (is_valid_range)
+        {
+            transfer->EndStripe();
+        }
+
+        bool intact = this->VerifyIntegrityTrailer(client_socket, checksum, client_connection_status);
+        bool is_complete = client_connection_status != ClientConnectionStatus::ConnectionClose;
+        bool is_whole = total_decoded == stripe_size;
+        bool is_stored = is_valid_range && is_complete && intact && is_whole && is_written;
+
+        // A Damaged Stripe Was Already Told MISMATCH By The Trailer Check
+        const char *journal_status = !is_complete ? "incomplete" : !intact ? "mismatch" : is_stored ? "ok" : "failed";
+        if (!is_complete || !intact)
+        {
+            this->JournalTransfer(client_socket, "GetStripe", transfer ? transfer->Destination() : transfer_id, total_received, journal_status);
+            return client_connection_status;
+        }
+
+        if (!transfer)
+        {
+            this->SendText(client_socket, "ERROR unknown transfer");
+        }
+        else if (!is_valid_range)
+        {
+            this->SendText(client_socket, "ERROR invalid range");
+        }
+        else if (!is_whole)
+        {
+            this->SendText(client_socket, "ERROR size mismatch " + std::to_string(total_decoded));
+        }
+        else if (!is_written)
+        {
+            this->SendText(client_socket, "ERROR unable to store the file");
+        }
+        else if (transfer->MarkReceived(first_block, block_count))
+        {
+            //* Last Missing Blocks: Every Other Stripe Already Finished Writing, The File Is Whole
+            // Removed First, So An ABORT Racing With This Cannot Delete The File Under The Rename
+            bool stored = this->striped_uploads->Remove(transfer_id) != nullptr && CommitTransferFile(transfer->TransferFile(), transfer->Destination());
+            if (stored)
+            {
+                std::cout << "Stored " << transfer->FileSize() << " bytes at " << transfer->Destination() << " (" << transfer->BlockCount() << " Striped Blocks)" << std::endl;
+                this->SendText(client_socket, "STRIPE DONE " + std::to_string(transfer->FileSize()));
+            }
+            else
+            {
+                std::remove(transfer->TransferFile().c_str());
+                this->SendText(client_socket, "ERROR unable to store the file");
+                journal_status = "failed";
+            }
+        }
+        else
+        {
+            this->SendText(client_socket, "STRIPE OK " + std::to_string(transfer->ReceivedCount()) + "/" + std::to_string(transfer->BlockCount()));
+        }
+
+        this->JournalTransfer(client_socket, "GetStripe", transfer ? transfer->Destination() : transfer_id, total_received, journal_status);
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Receive a Binary File into the content-addressed store and place it at file_to_store \n
+     * 1. Client sends "sha256:<hex digest>" of the file \n
+     * 2. Server replies "HAVE" if it already stores that digest (the upload is skipped) or "SEND" \n
+     * 3. On "SEND", the client sends the base64 file which is decoded and hashed while it arrives \n
+     *    A local client that announced "sha256:<hex digest> fd" sends one frame carrying the open file (SCM_RIGHTS) instead \n
+     * 4. Server replies "STORED <digest>" or "MISMATCH <digest>" if the content differs from the announcement
+     *
+     * @param client_socket The client_socket sent from
+     * @param file_to_store The file to place data into (Hard-linked to the stored object)
+     */
+    ClientConnectionStatus Server::GetBinaryFileToStore(std::shared_ptr<ClientConnection> client_socket, const std::string &file_to_store)
+    {
+        // Keep The Store Alive Even If The Directory Is Changed Meanwhile
+        std::shared_ptr<ContentStore> store = this->content_store;
+
+        //* Get The Digest Announcement
+        std::string announcement;
+        ClientConnectionStatus client_connection_status = this->GetText(client_socket, announcement);
+        if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+        {
+            return client_connection_status;
+        }
+
+        const std::string_view digest_prefix = "sha256:";
+        const std::string_view descriptor_suffix = " fd";
+        std::string announced_digest;
+        bool is_file_passed = false;
+        if (announcement.compare(0, digest_prefix.size(), digest_prefix) == 0)
+        {
+            announced_digest = announcement.substr(digest_prefix.size());
+            if (announced_digest.size() > descriptor_suffix.size() &&
+                announced_digest.compare(announced_digest.size() - descriptor_suffix.size(), descriptor_suffix.size(), descriptor_suffix) == 0)
+            {
+                announced_digest.erase(announced_digest.size() - descriptor_suffix.size());
+                is_file_passed = true;
+            }
+        }
+
+        if (!ContentStore::IsValidDigest(announced_digest))
+        {
+            std::cerr << "Error: Invalid digest announcement: " << announcement << std::endl;
+            this->SendText(client_socket, "ERROR invalid digest announcement");
+            return client_connection_status;
+        }
+
+        // Only A Unix Domain Socket Can Carry A File Descriptor
+        if (is_file_passed && !client_socket->IsLocal())
+        {
+            this->SendText(client_socket, "ERROR file passing needs a local connection");
+            return client_connection_status;
+        }
+
+        //* Already Have It -> Skip The Upload
+        if (store->Contains(announced_digest) && store->LinkInto(announced_digest, file_to_store))
+        {
+            std::cout << "Already have " << announced_digest << ", linked into " << file_to_store << std::endl;
+            this->SendText(client_socket, "HAVE");
+            this->JournalTransfer(client_socket, "GetBinaryFileToStore", file_to_store, 0, "deduplicated");
+            return client_connection_status;
+        }
+
+        this->SendText(client_socket, "SEND");
+
+        //* Decode And Hash The Upload While It Arrives
+        ContentStore::Writer writer = store->BeginWrite();
+        if (!writer.IsOpen())
+        {
+            std::cerr << "Error: Unable to open staging file in " << store->GetRootDirectory() << std::endl;
+        }
+
+        //* The Client Passed Its Open File -> Copy It Into The Store, Not A Byte Went Through The Socket
+        if (is_file_passed)
+        {
+            // The Frame Only Carries The Descriptor, Its Payload Is Ignored
+            client_connection_status = this->ReceiveUntilEndSignal(client_socket, [](std::string_view) {});
+            int passed_file = client_socket->TakeReceivedDescriptor();
+            if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+            {
+                if (passed_file >= 0)
+                {
+                    ::close(passed_file);
+                }
+                writer.Abort();
+                this->JournalTransfer(client_socket, "GetBinaryFileToStore", file_to_store, 0, "incomplete");
+                return client_connection_status;
+            }
+
+            // Only Regular Files: A Pipe Or A Socket Could Keep This Thread Reading Forever
+            struct stat passed_status;
+            bool is_copied = passed_file >= 0 && ::fstat(passed_file, &passed_status) == 0 && S_ISREG(passed_status.st_mode);
+            if (is_copied)
+            {
+                TraceSpan span("disk write");
+                is_copied = writer.WriteFromDescriptor(passed_file);
+            }
+            if (passed_file >= 0)
+            {
+                ::close(passed_file);
+            }
+
+            if (!is_copied)
+            {
+                writer.Abort();
+                this->SendText(client_socket, passed_file < 0 ? "ERROR no file descriptor passed" : "ERROR unable to read passed file");
+                this->JournalTransfer(client_socket, "GetBinaryFileToStore", file_to_store, writer.TotalWritten(), "error");
+                return client_connection_status;
+            }
+        }
+        else
+        {
+            Base64FrameDecoder decoder;
+            auto write_decoded = [&](const std::vector<BYTE> &decoded) {
+                if (!decoded.empty())
+                {
+                    TraceSpan span("disk write");
+                    writer.Write(decoded.data(), decoded.size());
+                }
+            };
+
+            client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+                write_decoded(decoder.Feed(chunk));
+            });
+
+            if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+            {
+                // Partial Upload -> Nothing To Keep
+                writer.Abort();
+                this->JournalTransfer(client_socket, "GetBinaryFileToStore", file_to_store, writer.TotalWritten(), "incomplete");
+                return client_connection_status;
+            }
+
+            write_decoded(decoder.Finish());
+        }
+
+        std::uint64_t total_written = writer.TotalWritten();
+        std::string stored_digest;
+        {
+            TraceSpan span("store commit");
+            stored_digest = writer.Commit();
+        }
+        if (stored_digest.empty() || !store->LinkInto(stored_digest, file_to_store))
+        {
+            this->SendText(client_socket, "ERROR unable to store file");
+            this->JournalTransfer(client_socket, "GetBinaryFileToStore", file_to_store, total_written, "error");
+            return client_connection_status;
+        }
+
+        std::cout << "Stored " << total_written << " bytes as " << stored_digest << " at " << file_to_store << std::endl;
+        if (stored_digest == announced_digest)
+        {
+            this->SendText(client_socket, "STORED " + stored_digest);
+        }
+        else
+        {
+            std::cerr << "Digest mismatch: announced " << announced_digest << " got " << stored_digest << std::endl;
+            this->SendText(client_socket, "MISMATCH " + stored_digest);
+        }
+        this->JournalTransfer(client_socket, "GetBinaryFileToStore", file_to_store, total_written, stored_digest == announced_digest ? "ok" : "mismatch");
+
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Get one JSON message from the client_socket and run the handler of its "type" \n
+     * The frame is received into the session's padded buffer and parsed there with the session's parser, so nothing is copied
+     *
+     * @param client_socket The client_socket sent from
+     * @param json_session The parser and buffer of this client (Reused for every message)
+     * @return ClientConnectionStatus ConnectionClose if the client closed
+     */
+    ClientConnectionStatus Server::GetJsonMessage(std::shared_ptr<ClientConnection> client_socket, JsonSession &json_session)
+    {
+        json_session.Clear();
+        ClientConnectionStatus client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            json_session.Append(chunk);
+        });
+
+        if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+        {
+            return client_connection_status;
+        }
+
+        simdjson::ondemand::document document;
+        std::string_view type;
+        simdjson::error_code error = json_session.Parse(document);
+        if (!error)
+        {
+            error = document["type"].get_string().get(type);
+        }
+
+        if (error)
+        {
+            std::cerr << "Error: Invalid JSON message from " << client_socket->RemoteAddress()
+                      << ": " << simdjson::error_message(error) << std::endl;
+            this->SendText(client_socket, std::string("ERROR invalid JSON message: ") + simdjson::error_message(error));
+            return client_connection_status;
+        }
+
+        std::size_t handler = this->json_type_table.Find(type);
+        if (handler == CommandTable::NOT_FOUND)
+        {
+            std::cerr << "Error: No handler for JSON message type " << type << std::endl;
+            this->SendText(client_socket, "ERROR unknown type " + std::string(type));
+            return client_connection_status;
+        }
+
+        // Give The Handler The Document From The Start, It May Read The Fields In Any Order
+        document.rewind();
+        try
+        {
+            this->json_type_handlers[handler](client_socket, document);
+        }
+        catch (const simdjson::simdjson_error &handler_error)
+        {
+            std::cerr << "Error: JSON message " << type << " from " << client_socket->RemoteAddress()
+                      << ": " << handler_error.what() << std::endl;
+            this->SendText(client_socket, std::string("ERROR invalid JSON message: ") + handler_error.what());
+        }
+
+        return client_connection_status;
+    }
+
+    /**
+     * @brief Get a stream of newline-delimited JSON records in one frame, giving every record to on_record \n
+     * Whenever a batch has arrived, the records up to its last newline are parsed with iterate_many and \n
+     * the partial record after it is carried into the next batch, so the whole stream is never held in memory
+     *
+     * @param client_socket The client_socket sent from
+     * @param json_session The parser and buffer of this client (Reused for every stream)
+     * @param on_record called with every record, in order
+     * @return ClientConnectionStatus ConnectionClose if the client closed
+     */
+    ClientConnectionStatus Server::GetNdjsonStream(
+        std::shared_ptr<ClientConnection> client_socket,
+        JsonSession &json_session,
+        const JsonRecordHandler &on_record
+    )
+    {
+        std::size_t record_count = 0;
+        simdjson::error_code stream_error = simdjson::SUCCESS;
+        std::string handler_error;
+
+        // Parse Every Whole Record Received So Far (Or Everything At The End Of The Stream)
+        auto parse_records = [&](bool end_of_stream) {
+            std::string_view received = json_session.Frame();
+            std::size_t length = end_of_stream ? received.size() : received.rfind('\n') + 1; // npos + 1 == 0
+            if (received.find_first_not_of(" \t\r\n") >= length)
+            {
+                // Nothing But Whitespace Yet
+                return;
+            }
+
+            try
+            {
+                stream_error = json_session.ParseRecords(length, on_record, record_count);
+            }
+            catch (const simdjson::simdjson_error &error)
+            {
+                stream_error = error.error();
+                handler_error = error.what();
+            }
+            json_session.Consume(length);
+        };
+
+        json_session.Clear();
+        ClientConnectionStatus client_connection_status = this->ReceiveUntilEndSignal(client_socket, [&](std::string_view chunk) {
+            if (stream_error)
+            {
+                // Already Failed -> Only Drain The Rest Of The Frame
+                return;
+            }
+
+            json_session.Append(chunk);
+            if (json_session.Frame().size() >= this->ndjson_batch_size)
+            {
+                parse_records(false);
+            }
+        });
+
+        if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+        {
+            return client_connection_status;
+        }
+
+        if (!stream_error)
+        {
+            parse_records(true);
+        }
+        json_session.Clear();
+
+        if (stream_error)
+        {
+            std::string reason = handler_error.empty() ? simdjson::error_message(stream_error) : handler_error;
+            std::cerr << "Error: NDJSON stream from " << client_socket->RemoteAddress() << " stopped after "
+                      << record_count << " records: " << reason << std::endl;
+            this->SendText(client_socket, "ERROR after " + std::to_string(record_count) + " records: " + reason);
+            return client_connection_status;
+        }
+
+        std::cout << "Received " << record_count << " NDJSON records from " << client_socket->RemoteAddress() << std::endl;
+        this->SendText(client_socket, "OK " + std::to_string(record_count));
+        return client_connection_status;
+    }
+
+    //! PRIVATE METHODS SECTIONS
+    //!============================================================================
+    void Server::AcceptConnections()
+    {
+        // Start an asynchronous accept operation
+        this->StartAccept();
+        if (this->local_acceptor)
+        {
+            this->StartLocalAccept();
+        }
+
+        // Run the io_context to process asynchronous operations
+        this->io_context.run();
+    }
+
+    void Server::JournalTransfer(
+        std::shared_ptr<ClientConnection> client_socket,
+        const char *operation,
+        const std::string &file,
+        std::uint64_t bytes,
+        const char *status
+    )
+    {
+        if (!this->transfer_journal)
+        {
+            return;
+        }
+
+        TransferRecord record;
+        record.peer = client_socket->RemoteAddress();
+        record.operation = operation;
+        record.file = file;
+        record.bytes = bytes;
+        record.status = status;
+        this->transfer_journal->Record(std::move(record));
+    }
+
+    void Server::StartAccept()
+    {
+        // The Accepted Socket Is Moved Into The Handler, Then Into Its ClientConnection
+        // The Socket Gets The io_context's Executor (Not server_strand), Like Every Client Operation
+        this->acceptor_server->async_accept(
+            this->io_context,
+            [this](const boost::system::error_code &error, boost::asio::ip::tcp::socket socket) {
+                this->HandleAccept(error, std::move(socket));
+        });
+    }
+
+    void Server::HandleAccept(const boost::system::error_code &error, boost::asio::ip::tcp::socket socket)
+    {
+        if (error)
+        {
+            // The Acceptor Was Closed By Stop()
+            if (error != boost::asio::error::operation_aborted)
+            {
+                std::cerr << "Error: " << error.message() << std::endl;
+            }
+            return;
+        }
+
+        TraceScope trace(this->tracer.get(), "accept");
+
+        // Over A Limit -> Turn It Away Before Anything Is Allocated For It
+        boost::system::error_code endpoint_error;
+        boost::asio::ip::address peer_address = socket.remote_endpoint(endpoint_error).address();
+        AdmissionDecision decision = endpoint_error
+            ? AdmissionDecision::Admitted
+            : this->admission_control.Admit(peer_address, this->send_memory_account->TotalBytes());
+        if (endpoint_error || decision != AdmissionDecision::Admitted)
+        {
+            // No Endpoint: The Client Is Already Gone
+            this->RejectConnection(std::move(socket), decision);
+            this->StartAccept();
+            return;
+        }
+
+        this->ApplySocketOptions(socket);
+
+        // Connection accepted. Wrap it in a ClientConnection (TLS if enabled)
+        // Use Shared_ptr to share the owner ship instead of copying them
+        std::shared_ptr<ClientConnection> client_socket = this->tls_context
+            ? std::make_shared<ClientConnection>(std::move(socket), *this->tls_context)
+            : std::make_shared<ClientConnection>(std::move(socket));
+        client_socket->SetSendLimits(this->send_queue_limits, this->send_memory_account);
+
+        this->ServeClient(client_socket, peer_address);
+
+        // Keep Accepting (Unless A Drain Started Meanwhile)
+        if (!this->is_draining)
+        {
+            this->StartAccept();
         }
+    }
 
-        // Cut Into Chunk of Data to send
-        std::string chunk;
+    void Server::StartLocalAccept()
+    {
+        this->local_acceptor->async_accept(
+            this->io_context,
+            [this](const boost::system::error_code &error, LocalSocket socket) {
+                this->HandleLocalAccept(error, std::move(socket));
+        });
+    }
 
-        // The Variable To check For The Bytes Have Send
-        std::size_t total_sent = 0;
+    /**
+     * @brief Admit a client of the Unix domain socket, through the same limits and session as TCP clients \n
+     * Local clients are never TLS, and all of them share one per-address count (The unspecified address)
+     *
+     * @param error the accept's error (operation_aborted once the acceptor is closed)
+     * @param socket the accepted local socket
+     */
+    void Server::HandleLocalAccept(const boost::system::error_code &error, LocalSocket socket)
+    {
+        if (error)
+        {
+            if (error != boost::asio::error::operation_aborted)
+            {
+                std::cerr << "Error: " << error.message() << std::endl;
+            }
+            return;
+        }
 
-        // Error if Thrown
-        boost::system::error_code error;
+        TraceScope trace(this->tracer.get(), "accept");
 
-        while (std::getline(text_file, chunk, static_cast<char>(EOF)) && !chunk.empty())
+        boost::asio::ip::address peer_address;
+        AdmissionDecision decision = this->admission_control.Admit(peer_address, this->send_memory_account->TotalBytes());
+        if (decision != AdmissionDecision::Admitted)
         {
-            // Synchronous write
-            std::size_t bytes_sent = boost::asio::write(
-                *client_socket,
-                boost::asio::buffer(chunk), 
-                error
-            );
+            this->RejectConnection(std::move(socket), decision);
+            this->StartLocalAccept();
+            return;
+        }
 
-            // Check Whether Error Happen
-            if (!error)
+        std::shared_ptr<ClientConnection> client_socket = std::make_shared<ClientConnection>(std::move(socket));
+        client_socket->SetSendLimits(this->send_queue_limits, this->send_memory_account);
+        this->ServeClient(client_socket, peer_address);
+
+        if (!this->is_draining)
+        {
+            this->StartLocalAccept();
+        }
+    }
+
+    void Server::ServeClient(std::shared_ptr<ClientConnection> client_socket, boost::asio::ip::address peer_address)
+    {
+        // Get CLIENT'S IP Address and port
+        std::cout << "Connected To Client: "
+                  << client_socket->RemoteAddress()
+                  << (client_socket->IsTls() ? " (TLS)" : "")
+                  << (client_socket->IsLocal() ? " (Local)" : "")
+                  << std::endl;
+
+        // Greeting The User
+        // DEBUG: For Testing Send Data Section
+        // this->SendText(client_socket, "Hello World\n");
+        // this->SendTextBasedFile(client_socket, "hello.json");
+        // this->SendTextBasedFile(client_socket, "Road 4.png");
+
+        // Authentication Part
+
+        // Accepted Just As A Drain Started -> Turn It Away
+        if (this->is_draining)
+        {
+            this->admission_control.Release(peer_address);
+            client_socket->MarkClosing();
+            this->SayGoingAway(client_socket);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->clients_mutex);
+
+            // Accepted Just As The Server Stopped -> Stop() May Already Be Waiting For The Last Client Thread
+            if (!this->is_running)
+            {
+                this->admission_control.Release(peer_address);
+                client_socket->Close();
+                return;
+            }
+            this->clients_connections.insert(client_socket);
+            this->client_thread_count++;
+        }
+        this->WatchClient(client_socket, std::chrono::milliseconds(0));
+
+        // Create A thread To Handle The Client
+        // The TLS Handshake Runs There Too, So A Slow Client Never Holds Up Accepting
+        std::thread client_thread([this, peer_address](std::shared_ptr<ClientConnection> client_socket) { 
+            boost::system::error_code handshake_error;
             {
-                total_sent += bytes_sent;
-                std::cout << "Message chunk sent successfully to "
-                          << client_socket->remote_endpoint().address() << ":"
-                          << client_socket->remote_endpoint().port()
-                          << std::endl;
+                TraceScope trace(this->tracer.get(), "handshake");
+                client_socket->Handshake(handshake_error);
+            }
+            if (handshake_error)
+            {
+                std::cerr << "TLS handshake failed with " << client_socket->RemoteAddress()
+                          << ": " << handshake_error.message() << std::endl;
+                client_socket->Close();
+                this->ForgetClient(client_socket);
             }
             else
             {
-                std::cerr << "Error: " << error.message() << std::endl;
-                break; // Break the loop on error
+                if (client_socket->IsTls())
+                {
+                    std::cout << "TLS session with " << client_socket->RemoteAddress()
+                              << (client_socket->IsSessionReused() ? " resumed" : " established") << std::endl;
+                }
+
+                this->HandleClient(client_socket); 
             }
-        }
 
-        // Check for end-of-file or error
-        if (text_file.eof())
+            // Its Slot Is Free For The Next Client
+            this->admission_control.Release(peer_address);
+
+            // Last Use Of The Server From This Thread (The Connection Is Let Go First, Its Socket May Close Here)
+            client_socket.reset();
+            std::lock_guard<std::mutex> lock(this->clients_mutex);
+            if (--this->client_thread_count == 0)
+            {
+                this->client_threads_done.notify_all();
+            }
+        }, client_socket);
+        client_thread.detach();
+    }
+
+    void Server::ApplySocketOptions(boost::asio::ip::tcp::socket &socket) const
+    {
+        // Best Effort: A Refused Option Leaves The Kernel Default
+        boost::system::error_code error;
+        if (this->socket_options.no_delay)
+        {
+            socket.set_option(boost::asio::ip::tcp::no_delay(true), error);
+        }
+        if (this->socket_options.keep_alive)
         {
-            std::cout << "All data sent successfully!" << std::endl;
+            socket.set_option(boost::asio::socket_base::keep_alive(true), error);
         }
-        else if (text_file.fail())
+        if (this->socket_options.send_buffer_size > 0)
         {
-            std::cerr << "Error reading binary file: " << file_to_send << std::endl;
+            socket.set_option(boost::asio::socket_base::send_buffer_size(this->socket_options.send_buffer_size), error);
         }
+    }
+
+    /**
+     * @brief Answer a connection over an admission limit as cheaply as possible: \n
+     * One non-blocking write of "BUSY retry-after=<seconds>" (Plain TCP and local only, when enabled), then close
+     *
+     * @param socket the connection (TCP or local), closed when this returns
+     * @param decision which limit it is over (Admitted when the client vanished before it could be checked)
+     */
+    template <typename Socket>
+    void Server::RejectConnection(Socket socket, AdmissionDecision decision)
+    {
+        AdmissionLimits admission_limits = this->admission_control.GetLimits();
 
-        // Close the File after Sending Successfully
-        text_file.close();
+        // Local Clients Never Talk TLS
+        bool is_plain = std::is_same_v<Socket, LocalSocket> || !this->tls_context;
 
-        // Check If All data has been sent
-        if (total_sent == boost::filesystem::file_size(file_to_send))
+        boost::system::error_code error;
+        if (decision != AdmissionDecision::Admitted && admission_limits.send_busy_frame && is_plain)
         {
-            std::cout << " All data sent successfully!" << std::endl;
+            std::string busy_frame = "BUSY retry-after=" + std::to_string(admission_limits.retry_after.count()) + this->end_signal;
+
+            // Never Wait For A Client We Will Not Serve: Whatever Does Not Fit The Socket Buffer Is Lost
+            socket.non_blocking(true, error);
+            if (!error)
+            {
+                socket.write_some(boost::asio::buffer(busy_frame), error);
+            }
+            socket.shutdown(boost::asio::socket_base::shutdown_send, error);
         }
-        else
+        socket.close(error);
+    }
+
+    void Server::HandleClient(std::shared_ptr<ClientConnection> client_socket)
+    {
+        std::cout << "Handle Here!" << std::endl;
+
+        // To Check For the client_connection has closed 
+        ClientConnectionStatus clients_connection_status = ClientConnectionStatus::ConnectionOpen;
+
+        // JSON Request Mode: One Parser Per Client, Reused For Every Message
+        if (this->json_mode)
+        {
+            JsonSession json_session;
+            while (clients_connection_status == ClientConnectionStatus::ConnectionOpen)
+            {
+                TraceScope trace(this->tracer.get(), "request");
+                clients_connection_status = this->GetJsonMessage(client_socket, json_session);
+                if (!this->FinishRequest(client_socket))
+                {
+                    // Let Go By The Drain
+                    clients_connection_status = ClientConnectionStatus::ConnectionClose;
+                }
+            }
+        }
+
+        // Text Request Mode: Every Request Goes To The Handler Of Its Command
+        while (clients_connection_status == ClientConnectionStatus::ConnectionOpen)
         {
-            std::cerr << "Not all data sent. Total sent: " << total_sent << " bytes out of "
-                      << boost::filesystem::file_size(file_to_send) << " bytes." << std::endl;
+            TraceScope trace(this->tracer.get(), "request");
+            clients_connection_status = this->RouteRequest(client_socket);
+            if (!this->FinishRequest(client_socket))
+            {
+                // Let Go By The Drain
+                clients_connection_status = ClientConnectionStatus::ConnectionClose;
+            }
         }
 
-        //! Send an end signal
-        this->SendEndSignal(client_socket);
+        // Show A Log for close the client_socket
+        std::cout << "Close connection with Client: "
+                  << client_socket->RemoteAddress() << std::endl;
+
+        // Close the client_socket
+        client_socket->Close();
+
+        // If the client_socket closed
+        // -> Remove From The Set of client_sockets
+        this->ForgetClient(client_socket);
+
+        // -> end Thread
     }
 
     /**
-     * @brief Call This Function within server object to send a Binary File Formats \n
-     * For Sending Files likes: \n
-     * 1. Image Files (.jpg, .png, .gif, etc.) \n
-     * 2. Binary Documents (.pdf, .docx, .xlsx, etc.) \n
-     * 3. Executable Files (.exe) \n
-     * 4. Compressed Archives (.zip, .tar, .gz, etc.) \n
+     * @brief Get one text request and run the handler of its command \n
+     * The command is looked up in the built-in table (Perfect hash, made by the compiler), then in the table built
+     * from OnCommand at Start, so a request costs one hash and one comparison per table, never a map lookup
      *
-     * @param client_socket The client_socket to send the File
-     * @param file_to_send The file directory to send
+     * @param client_socket the client the request comes from
+     * @return ClientConnectionStatus ConnectionClose if the client closed
      */
-    void Server::SendBinaryFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string &file_to_send)
+    ClientConnectionStatus Server::RouteRequest(std::shared_ptr<ClientConnection> client_socket)
     {
-        // FIXME: Sending Binary Files
-        //! Approach 1: Encoding Base 64
-        // Create A temp file with subfix .txt
-        const std::string temp_file_directory = createTempFile(file_to_send);
+        std::string request;
+        ClientConnectionStatus client_connection_status = this->GetText(client_socket, request);
+        if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+        {
+            return client_connection_status;
+        }
 
-        // Encode Binary File into temp file
-        encodeFileToFile(file_to_send, temp_file_directory);
+        // "<COMMAND> <arguments>", The Arguments May Be Empty
+        std::string_view request_view(request);
+        std::size_t space_index = request_view.find(' ');
+        std::string_view command = request_view.substr(0, space_index);
+        std::string_view arguments = space_index == std::string_view::npos ? std::string_view() : request_view.substr(space_index + 1);
 
-        // Then send that temp file
-        this->SendTextBasedFile(client_socket, temp_file_directory);
+        std::size_t builtin_command = BUILTIN_COMMANDS.Find(command);
+        switch (builtin_command)
+        {
+        case BuiltinEcho:
+            this->SendText(client_socket, arguments);
+            return client_connection_status;
+
+        case BuiltinStats:
+            this->SendStats(client_socket);
+            return client_connection_status;
 
-        // Delete that temp file afterward
-        int result = std::remove(temp_file_directory.c_str());
+        case BuiltinStripe:
+            return this->HandleStripeRequest(client_socket, arguments);
 
-        // Check If delete success
-        if (result == 0)
+        case BuiltinShm:
+            this->SetUpSharedMemory(client_socket, arguments);
+            return client_connection_status;
+
+        case BuiltinNdjson:
         {
-            std::cout << "File '" << temp_file_directory << "' deleted successfully." << std::endl;
+            // The Stream Is The Next Frame: Its Records Go To The Handler From OnNdjsonRecord (Only Counted Without One)
+            JsonSession json_session;
+            return this->GetNdjsonStream(client_socket, json_session, [&](simdjson::ondemand::document_reference &record) {
+                if (this->ndjson_record_handler)
+                {
+                    this->ndjson_record_handler(client_socket, record);
+                }
+            });
         }
-        else
+
+        case BuiltinUpload:
+        case BuiltinStore:
+        case BuiltinDownload:
+            break;
+
+        default:
         {
-            std::cerr << "Error deleting file" << std::endl;
+            std::size_t handler = this->command_table.Find(command);
+            if (handler == CommandTable::NOT_FOUND)
+            {
+                std::cerr << "Error: Unknown command " << command << " from " << client_socket->RemoteAddress() << std::endl;
+                this->SendText(client_socket, "ERROR unknown command " + std::string(command));
+                return client_connection_status;
+            }
+            return this->command_handlers[handler](client_socket, arguments);
+        }
         }
 
-        // //! Approach 2: Send Binary
-        // // Open The Binary Files
-        // std::ifstream binary_file(file_to_send, std::ios::binary);
+        //* File Commands: The Argument Is A File Name Under files_directory
+        // An Upload Without One Gets A New Name, Told To The Client Before Its Data Is Read
+        bool has_size = false;
+        std::uint64_t file_size = 0;
+        if (builtin_command == BuiltinUpload && !TakeSizeOption(arguments, has_size, file_size))
+        {
+            this->SendText(client_socket, "ERROR invalid size");
+            return client_connection_status;
+        }
 
-        // // Check If the file has opened successfully
-        // if (!binary_file.is_open())
-        // {
-        //     std::cerr << "Error: Unable to open binary file " << file_to_send << std::endl;
-        //     return;
-        // }
+        std::string_view range;
+        bool has_range = builtin_command == BuiltinDownload && TakeOption(arguments, "range=", range);
 
-        // // The Varible to check for the bytes sent
-        // std::size_t total_sent = 0;
+        std::string path;
+        if (arguments.empty() && builtin_command != BuiltinDownload)
+        {
+            std::string file_name;
+            if (!this->GenerateClientPath(file_name, path))
+            {
+                this->SendText(client_socket, "ERROR unable to name the file");
+                return client_connection_status;
+            }
+            this->SendText(client_socket, "NAME " + file_name);
+        }
+        else if (!this->ResolveClientPath(arguments, path))
+        {
+            this->SendText(client_socket, "ERROR invalid file name");
+            return client_connection_status;
+        }
 
-        // // Make A Buffer to send
-        // char buffer[this->CHUNK_SIZE];
-        // while (binary_file.read(buffer, this->CHUNK_SIZE))
-        // {
-        //     // Synchronous write
-        //     boost::system::error_code error;
-        //     std::size_t bytes_sent = boost::asio::write(*client_socket, boost::asio::buffer(buffer, binary_file.gcount()), error);
+        if (builtin_command == BuiltinUpload)
+        {
+            return has_size ? this->GetSizedBinaryFile(client_socket, path, file_size) : this->GetBinaryFile(client_socket, path);
+        }
+        if (builtin_command == BuiltinStore)
+        {
+            return this->GetBinaryFileToStore(client_socket, path);
+        }
 
-        //     // Check whether an error happened
-        //     if (!error)
-        //     {
-        //         total_sent += bytes_sent;
-        //         std::cout << "Bytes chunk sent successfully to "
-        //                   << client_socket->remote_endpoint().address() << ":"
-        //                   << client_socket->remote_endpoint().port()
-        //                   << std::endl;
-        //     }
-        //     else
-        //     {
-        //         std::cerr << "Error: " << error.message() << std::endl;
-        //         break; // Break the loop on error
-        //     }
-        // }
+        if (has_range)
+        {
+            this->SendFileRange(client_socket, path, range);
+            return client_connection_status;
+        }
 
-        // // Check for end-of-file or error
-        // if (binary_file.eof())
-        // {
-        //     std::cout << "All data sent successfully!" << std::endl;
-        // }
-        // else if (binary_file.fail())
-        // {
-        //     std::cerr << "Error reading binary file: " << file_to_send << std::endl;
-        // }
+        if (!boost::filesystem::is_regular_file(path))
+        {
+            this->SendText(client_socket, "ERROR no such file");
+            return client_connection_status;
+        }
+        this->SendBinaryFile(client_socket, path);
+        return client_connection_status;
+    }
 
-        // // Check if all data has been sent
-        // if (total_sent == boost::filesystem::file_size(file_to_send))
-        // {
-        //     std::cout << "All data sent successfully!" << std::endl;
-        // }
-        // else
-        // {
-        //     std::cerr << "Not all data sent. Total sent: " << total_sent << " bytes out of "
-        //               << boost::filesystem::file_size(file_to_send) << " bytes." << std::endl;
-        // }
+    /**
+     * @brief Turn a file name from a client into a path under files_directory \n
+     * Refused: absolute names, empty parts ("a//b"), parts starting with '.' (So "..", And The Hidden Transfer Files),
+     * backslashes, control characters and overlong names \n
+     * Missing directories are created
+     *
+     * @param file_name the name the client sent (Relative, "/" separated)
+     * @param path set to files_directory/file_name
+     * @return true if the name is acceptable
+     */
+    bool Server::ResolveClientPath(std::string_view file_name, std::string &path) const
+    {
+        if (file_name.empty() || file_name.size() > MAX_CLIENT_PATH_LENGTH)
+        {
+            return false;
+        }
 
-        // // Close the file after sending successfully
-        // binary_file.close();
+        std::size_t part_start = 0;
+        while (part_start <= file_name.size())
+        {
+            std::size_t part_end = std::min(file_name.find('/', part_start), file_name.size());
+            std::string_view part = file_name.substr(part_start, part_end - part_start);
+            if (part.empty() || part.front() == '.' || part.size() > MAX_CLIENT_NAME_LENGTH)
+            {
+                return false;
+            }
+
+            for (char character : part)
+            {
+                if (static_cast<unsigned char>(character) < 0x20 || character == 0x7f || character == '\\')
+                {
+                    return false;
+                }
+            }
+
+            part_start = part_end + 1;
+        }
+
+        boost::filesystem::path relative_path{std::string(file_name)};
+
+        boost::filesystem::path full_path = boost::filesystem::path(this->files_directory) / relative_path;
+        boost::system::error_code error;
+        boost::filesystem::create_directories(full_path.parent_path(), error);
+
+        path = full_path.string();
+        return true;
     }
 
-    //* INFO: For Receiving Protocol Method
-    // Simple I/O Get Protocol
-    ClientConnectionStatus Server::GetText(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, std::string &received_text)
+    /**
+     * @brief Make up a new file name under files_directory for an upload that did not name one \n
+     * The name is reserved by creating the (empty) file, so two uploads never get the same one
+     *
+     * @param file_name set to the name the client should use for it later
+     * @param path set to files_directory/file_name
+     * @return true if a name was reserved
+     */
+    bool Server::GenerateClientPath(std::string &file_name, std::string &path) const
     {
-        // Return Value
-        ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
+        boost::system::error_code error;
+        boost::filesystem::create_directories(this->files_directory, error);
+
+        std::string reserved_path = (boost::filesystem::path(this->files_directory) / "upload-XXXXXX").string();
+        int descriptor = ::mkstemp(reserved_path.data());
+        if (descriptor < 0)
+        {
+            std::cerr << "Error: Unable to reserve a file name in " << this->files_directory << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        ::close(descriptor);
+
+        file_name = boost::filesystem::path(reserved_path).filename().string();
+        path = reserved_path;
+        return true;
+    }
+
+    /**
+     * @brief Reply to STATS with what the server is doing right now
+     *
+     * @param client_socket the client that asked
+     */
+    void Server::SendStats(std::shared_ptr<ClientConnection> client_socket)
+    {
+        std::size_t client_count;
+        {
+            std::lock_guard<std::mutex> lock(this->clients_mutex);
+            client_count = this->clients_connections.size();
+        }
+
+        std::size_t shared_memory_count;
+        {
+            std::lock_guard<std::mutex> lock(this->shared_memory_mutex);
+            shared_memory_count = this->shared_memory_channels.size();
+        }
+
+        std::size_t scheduled_timers = this->timing_wheel->ScheduledCount();
+        this->SendJson(client_socket, [&](JsonWriter &json) {
+            json.BeginObject()
+                .Key("clients").UInt(client_count)
+                .Key("admitted_connections").UInt(this->admission_control.OpenConnections())
+                .Key("rejected_connections").UInt(this->admission_control.RejectedCount())
+                .Key("queued_send_bytes").UInt(this->GetQueuedSendBytes())
+                .Key("send_memory_limit").UInt(this->GetSendMemoryLimit())
+                .Key("shared_memory_clients").UInt(shared_memory_count)
+                .Key("scheduled_timers").UInt(scheduled_timers)
+                .Key("io_threads").UInt(this->io_thread_count)
+                .Key("disk_threads").UInt(this->disk_executor->ThreadCount())
+                .Key("free_disk_bytes").UInt(FreeDiskBytes(this->files_directory))
+                .Key("striped_uploads").UInt(this->striped_uploads->Size())
+                .Key("file_cache_bytes").UInt(this->file_cache->CachedBytes())
+                .Key("file_cache_hits").UInt(this->file_cache->HitCount())
+                .Key("file_cache_misses").UInt(this->file_cache->MissCount())
+                .Key("encoded_cache_bytes").UInt(this->encoded_file_cache->CachedBytes())
+                .Key("encoded_cache_hits").UInt(this->encoded_file_cache->HitCount())
+                .Key("encoded_cache_misses").UInt(this->encoded_file_cache->MissCount())
+                .Key("draining").Bool(this->is_draining)
+                .EndObject();
+        });
+    }
+
+    /**
+     * @brief Mark the client's request as done and decide whether to wait for the next one \n
+     * While draining, the client gets the going-away frame here instead of another request
+     *
+     * @param client_socket the client that just finished a request
+     * @return true to keep serving the client
+     */
+    bool Server::FinishRequest(std::shared_ptr<ClientConnection> client_socket)
+    {
+        client_socket->EndRequest();
+        if (!this->is_draining)
+        {
+            return true;
+        }
+
+        // Otherwise The Drain Already Said Going Away To This (Then Idle) Client
+        if (client_socket->MarkClosing())
+        {
+            this->SendText(client_socket, this->going_away_text);
+        }
+        return false;
+    }
 
-        // Buffer for Receiving Data
-        char buffer[this->CHUNK_SIZE];
+    void Server::ForgetClient(std::shared_ptr<ClientConnection> client_socket)
+    {
+        bool was_last_client;
+        {
+            std::lock_guard<std::mutex> lock(this->clients_mutex);
+            this->clients_connections.erase(client_socket);
+            was_last_client = this->clients_connections.empty();
+        }
 
-        // Variable o calculate bytes received
-        std::size_t total_received = 0;
+        // Drop Whatever The Client Sent Past Its Last Frame
+        {
+            std::lock_guard<std::mutex> lock(this->pending_input_mutex);
+            this->pending_input.erase(client_socket.get());
+        }
 
-        // Error Code if Thrown
-        boost::system::error_code error;
+        // Its Rings Go Away With It (The Client's Mappings Stay Valid Until It Unmaps Them)
+        {
+            std::lock_guard<std::mutex> lock(this->shared_memory_mutex);
+            auto channel = this->shared_memory_channels.find(client_socket.get());
+            if (channel != this->shared_memory_channels.end())
+            {
+                channel->second->Close();
+                this->shared_memory_channels.erase(channel);
+            }
+        }
 
-        // Read Until End-Of-Stream
-        while (true)
+        if (was_last_client && this->is_draining)
         {
-            // Synchronous Read
-            std::size_t bytes_received = client_socket->read_some(
-                boost::asio::buffer(buffer, this->CHUNK_SIZE),
-                error
-            );
+            boost::asio::post(this->server_strand, [this]() { this->FinishDrain(); });
+        }
+    }
 
-            if (!error)
+    /**
+     * @brief Expire a striped upload that nothing was received for in STRIPED_UPLOAD_IDLE_TIMEOUT \n
+     * Checked again later while it is busy or was recently, so a client that went away does not leave its file behind
+     *
+     * @param transfer_id the striped upload to watch
+     */
+    void Server::WatchStripedUpload(const std::string &transfer_id)
+    {
+        this->timing_wheel->Schedule(STRIPED_UPLOAD_IDLE_TIMEOUT, [this, transfer_id]() {
+            std::shared_ptr<StripedTransfer> transfer = this->striped_uploads->Find(transfer_id);
+            if (!transfer)
             {
-                // Append the received data to the text
-                total_received += bytes_received;
-                received_text.append(buffer, bytes_received);
-                std::cout << "Received " << bytes_received << " bytes from "
-                          << client_socket->remote_endpoint().address() << ":"
-                          << client_socket->remote_endpoint().port()
-                          << std::endl;
-
-                // Find If there is an end_signal 
-                // If yes -> Break The Loop
-                std::size_t index_to_del = -1;
-                if (this->HasEndSignal(received_text, &index_to_del))
-                {
-                    // Strip that end_signal part
-                    received_text = this->RemoveEndSignal(received_text, index_to_del);
+                // Finished Or Aborted Meanwhile
+                return;
+            }
 
-                    // INFO: Receive Text Here
-                    std::cout << "Received text: " << received_text << std::endl;
+            if (transfer->IsIdleFor(STRIPED_UPLOAD_IDLE_TIMEOUT) && this->striped_uploads->Abort(transfer_id))
+            {
+                std::cerr << "Error: Striped upload of " << transfer->Destination() << " expired with "
+                          << transfer->ReceivedCount() << "/" << transfer->BlockCount() << " blocks" << std::endl;
+                return;
+            }
+            this->WatchStripedUpload(transfer_id);
+        });
+    }
 
-                    // Break the loop because there is an end_signal
-                    break; 
+    /**
+     * @brief Check the client's timeouts after delay (The shortest timeout when delay is 0) \n
+     * The wheel only holds a weak_ptr, so a client that is gone just drops out of it
+     *
+     * @param client_socket the client to watch
+     * @param delay until the next check
+     */
+    void Server::WatchClient(std::weak_ptr<ClientConnection> client_socket, std::chrono::milliseconds delay)
+    {
+        if (delay.count() <= 0)
+        {
+            for (std::chrono::milliseconds timeout : {this->session_timeouts.idle_timeout, this->session_timeouts.read_timeout,
+                                                      this->session_timeouts.write_timeout, this->session_timeouts.heartbeat_interval})
+            {
+                if (timeout.count() > 0 && (delay.count() <= 0 || timeout < delay))
+                {
+                    delay = timeout;
                 }
             }
-            else if (error == boost::asio::error::eof)
-            {
-                // Connection closed by the client
-                std::cout << "Connection closed by the client." << std::endl;
-
-                // Change The Status of the Client_connection
-                client_connection_status = ClientConnectionStatus::ConnectionClose;
 
-                break; // Because The Client Close the Stream
-            }
-            else
+            // Every Timeout Off -> Nothing To Watch
+            if (delay.count() <= 0)
             {
-                // Change The Status of the Client_connection
-                client_connection_status = ClientConnectionStatus::ConnectionClose;
-
-                // An error occurred
-                std::cerr << "Error: " << error.message() << std::endl;
-                break;
+                return;
             }
         }
 
-        // Process the received text (you can modify this part based on your needs)
-        std::cout << "Client: " << client_socket->remote_endpoint().address() << ":"
-                                << client_socket->remote_endpoint().port()
-                                << std::endl;
-        std::cout << "Send A Total Bytes of: " << total_received << std::endl;
-
-        return client_connection_status;
+        this->timing_wheel->Schedule(delay, [this, client_socket]() {
+            this->CheckClientTimeouts(client_socket);
+        });
     }
 
     /**
-     * @brief Use this method to get the Text-Based Data File From the given clien_socket and Store in the file_to_store directories
-     * 
-     * @param client_socket The client_socket sent from
-     * @param file_to_store The Place to store the Data
+     * @brief Close the client if it is over a timeout, send a heartbeat if one is due, \n
+     * else check again when the earliest deadline comes (So activity never touches the wheel)
+     *
+     * @param client_socket the client to check
      */
-    ClientConnectionStatus Server::GetTextBasedFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string &file_to_store)
+    void Server::CheckClientTimeouts(std::weak_ptr<ClientConnection> client_socket)
     {
-        // Return Value
-        ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
-
-        // Open The file to store the received data
-        std::ofstream received_file(file_to_store, std::ios::binary | std::ios::app);
-
-        // Check if the file is opened successfully
-        if (!received_file.is_open())
+        std::shared_ptr<ClientConnection> client = client_socket.lock();
+        if (!client || !client->IsOpen())
         {
-            std::cerr << "Error: Unable to open file for receiving data " << file_to_store << std::endl;
-            return client_connection_status;
+            return;
         }
 
-        // Buffer for receiving data
-        std::string buffer;
-        buffer.resize(this->CHUNK_SIZE);
-
-        // Amount of bytes received
-        std::size_t total_received = 0;
-
-        // Error Code if Thrown
-        boost::system::error_code error;
+        const SessionTimeouts &timeouts = this->session_timeouts;
+        const std::chrono::steady_clock::time_point not_waiting{};
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point next_check = std::chrono::steady_clock::time_point::max();
 
-        // Check if there is an end_signal
-        bool has_end_signal = false;    
-        while (!has_end_signal)
+        // Waiting For Bytes: Idle Between Requests, Stalled Inside One
+        std::chrono::steady_clock::time_point read_waiting_since = client->ReadWaitingSince();
+        bool is_busy = client->GetRequestState() == RequestState::RequestBusy;
+        std::chrono::milliseconds read_limit = is_busy ? timeouts.read_timeout : timeouts.idle_timeout;
+        if (read_waiting_since != not_waiting && read_limit.count() > 0)
         {
-            // Synchronous read
-            std::size_t bytes_received = client_socket->read_some(
-                boost::asio::buffer(&buffer[0], this->CHUNK_SIZE),
-                error
-            );
-
-            // Find If there is an end_signal 
-            // If yes -> Strip That end_signal
-            std::size_t index_to_del = -1;
-            if (this->HasEndSignal(buffer, &index_to_del))
+            if (now - read_waiting_since >= read_limit)
             {
-                // Have an end_signal
-                has_end_signal = true;
-                buffer = this->RemoveEndSignal(buffer, index_to_del);
+                std::cerr << "Closing " << client->RemoteAddress() << ": " << (is_busy ? "read" : "idle") << " timeout" << std::endl;
+                client->Close();
+                return;
             }
+            next_check = std::min(next_check, read_waiting_since + read_limit);
+        }
 
-            // If received bytes
-            if (bytes_received > 0)
+        // A Write Making No Progress
+        std::chrono::steady_clock::time_point write_waiting_since = client->WriteWaitingSince();
+        if (write_waiting_since != not_waiting && timeouts.write_timeout.count() > 0)
+        {
+            if (now - write_waiting_since >= timeouts.write_timeout)
             {
-                // Synchronous write to the received file
-                received_file.write(buffer.data(), bytes_received);
-                received_file.flush(); // Flush the data to the file
-
-                total_received += bytes_received;
-                std::cout << "Received " << bytes_received << " bytes from "
-                          << client_socket->remote_endpoint().address() << ":"
-                          << client_socket->remote_endpoint().port()
-                          << std::endl;
+                std::cerr << "Closing " << client->RemoteAddress() << ": write timeout" << std::endl;
+                client->Close();
+                return;
             }
-            else if (error == boost::asio::error::eof)
-            {
-                // Connection closed by the client
-                std::cout << "Connection closed by the client." << std::endl;
-
-                // Change The Status of the Client_connection
-                client_connection_status = ClientConnectionStatus::ConnectionClose;
+            next_check = std::min(next_check, write_waiting_since + timeouts.write_timeout);
+        }
 
-                break; // Because The Client Close the Stream
-            }
-            else
+        // Heartbeat Only Between Requests, When Nothing Else Is Being Sent
+        if (timeouts.heartbeat_interval.count() > 0)
+        {
+            std::chrono::steady_clock::time_point heartbeat_due = client->LastWriteTime() + timeouts.heartbeat_interval;
+            if (now >= heartbeat_due && !is_busy && client->QueuedBytes() == 0)
             {
-                // No more data or error on the Client Side
-                break;
+                client->AsyncSend(this->MakeFrame(this->heartbeat_text));
+                heartbeat_due = now + timeouts.heartbeat_interval;
             }
+            next_check = std::min(next_check, heartbeat_due);
         }
 
-        // Check If All data has been received
-        if (total_received > 0)
+        // Nothing Pending -> Look Again After The Shortest Timeout (A Wait Starting Meanwhile Is Caught Then)
+        std::chrono::milliseconds delay(0);
+        if (next_check != std::chrono::steady_clock::time_point::max())
         {
-            std::cout << "All data received successfully!" << std::endl;
+            delay = std::chrono::duration_cast<std::chrono::milliseconds>(next_check - now) + std::chrono::milliseconds(1);
         }
-        else
+        this->WatchClient(client_socket, delay);
+    }
+
+    /**
+     * @brief Queue the going-away frame behind everything already queued, then close the client
+     *
+     * @param client_socket the client to let go
+     */
+    void Server::SayGoingAway(std::shared_ptr<ClientConnection> client_socket)
+    {
+        client_socket->AsyncSend(this->MakeFrame(this->going_away_text), [client_socket](const boost::system::error_code &, std::size_t) {
+            client_socket->Close();
+        });
+    }
+
+    /**
+     * @brief End the drain: close every client still connected and let IsRunning() turn false \n
+     * Runs when the last client is gone or at the deadline, whichever comes first
+     */
+    void Server::FinishDrain()
+    {
+        if (this->drain_finished)
         {
-            std::cerr << "No data received or an error occurred." << std::endl;
+            return;
         }
+        this->drain_finished = true;
 
-        // Close the file after receiving data
-        received_file.close();
+        if (this->drain_timer)
+        {
+            this->drain_timer->cancel();
+        }
 
-        return client_connection_status;
+        std::lock_guard<std::mutex> lock(this->clients_mutex);
+        if (!this->clients_connections.empty())
+        {
+            std::cerr << "Drain deadline passed, closing " << this->clients_connections.size() << " clients." << std::endl;
+        }
+        for (const std::shared_ptr<ClientConnection> &client_socket : this->clients_connections)
+        {
+            client_socket->Close();
+        }
+
+        std::cout << "Drain finished." << std::endl;
+        this->is_running = false;
+    }
+
+    void Server::WaitForSignal(std::function<void(int)> handler)
+    {
+        this->signals->async_wait([this, handler](const boost::system::error_code &error, int signal_number) {
+            if (error)
+            {
+                // Cancelled By Stop()
+                return;
+            }
+
+            handler(signal_number);
+            this->WaitForSignal(handler);
+        });
     }
 
     /**
-     * @brief Use this function to get The Binary-Text File from the Client_socket and Store in the file_to_store
-     * 
+     * @brief Read from client_socket until the end_signal, giving the payload to on_chunk piece by piece \n
+     * The last (end_signal.size() - 1) bytes are held back until the next read, so an end_signal split over two reads is still found \n
+     * Bytes after the end_signal belong to the next frame and are kept for the next call
+     *
      * @param client_socket The client_socket sent from
-     * @param file_to_store The file to place data into
+     * @param on_chunk Called with every piece of payload (Never contains the end_signal)
+     * @return ClientConnectionStatus ConnectionClose if the client closed or the read failed
      */
-    ClientConnectionStatus Server::GetBinaryFile(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket, const std::string &file_to_store)
+    ClientConnectionStatus Server::ReceiveUntilEndSignal(
+        std::shared_ptr<ClientConnection> client_socket,
+        const std::function<void(std::string_view)> &on_chunk
+    )
     {
+        TraceSpan frame_span("read frame");
+
+        // Every Ring Record Is A Whole Frame
+        if (std::shared_ptr<SharedMemoryChannel> channel = this->FindSharedMemory(client_socket.get()))
+        {
+            return this->ReceiveFromSharedMemory(client_socket, channel, on_chunk);
+        }
+
         // Return Value
         ClientConnectionStatus client_connection_status = ClientConnectionStatus::ConnectionOpen;
 
-        //! Decode Base 64
-        // Put All the data into a temp file
-        std::string temp_file = createTempFile(file_to_store);
+        // Bytes That May Be The Start Of An end_signal
+        const std::size_t max_held = this->end_signal.size() - 1;
 
-        // Open The file to store the received data
-        std::ofstream received_file(temp_file, std::ios::binary | std::ios::app);
+        // Received Bytes Not Given To on_chunk Yet
+        // Starts With What The Previous Frame Read Past Its end_signal
+        std::string window;
+        {
+            std::lock_guard<std::mutex> lock(this->pending_input_mutex);
+            auto pending = this->pending_input.find(client_socket.get());
+            if (pending != this->pending_input.end())
+            {
+                window = std::move(pending->second);
+                this->pending_input.erase(pending);
+            }
+        }
 
-        // Check if the file is opened successfully
-        if (!received_file.is_open())
+        // A Pipelined Request Is Already Here -> It Is In Flight
+        if (!window.empty() && !client_socket->BeginRequest())
         {
-            std::cerr << "Error: Unable to open file for receiving data " << file_to_store << std::endl;
-            return client_connection_status;
+            return ClientConnectionStatus::ConnectionClose;
         }
 
         // Buffer for receiving data
-        std::string buffer;
-        buffer.resize(this->CHUNK_SIZE);
-
-        // Amount of bytes received
-        std::size_t total_received = 0;
+        std::string buffer(this->CHUNK_SIZE, '\0');
 
         // Error Code if Thrown
         boost::system::error_code error;
 
-        // Check if there is an end_signal
-        bool has_end_signal = false;   
-        while (!has_end_signal)
+        while (true)
         {
-            // Synchronous read
-            std::size_t bytes_received = client_socket->read_some(
-                boost::asio::buffer(&buffer[0], this->CHUNK_SIZE),
-                error
-            );
-
-            // Find If there is an end_signal 
-            // If yes -> Strip That end_signal
-            std::size_t index_to_del = -1;
-            if (this->HasEndSignal(buffer, &index_to_del))
+            // Find If there is an end_signal
+            // If yes -> Give The Part Before It, Keep The Part After It And Stop
+            std::size_t index_to_del = std::string::npos;
+            if (this->HasEndSignal(window, &index_to_del))
             {
-                // Have an end_signal
-                has_end_signal = true;
-                buffer = this->RemoveEndSignal(buffer, index_to_del);
+                if (index_to_del > 0)
+                {
+                    on_chunk(std::string_view(window).substr(0, index_to_del));
+                }
+
+                if (index_to_del + this->end_signal.size() < window.size())
+                {
+                    std::lock_guard<std::mutex> lock(this->pending_input_mutex);
+                    this->pending_input[client_socket.get()] = window.substr(index_to_del + this->end_signal.size());
+                }
+                break;
             }
 
-            // If received bytes
-            if (bytes_received > 0)
+            // Give Everything Except The Possible Start Of An end_signal
+            if (window.size() > max_held)
             {
-                // Synchronous write to the received file
-                received_file.write(buffer.data(), bytes_received);
-                received_file.flush(); // Flush the data to the file
+                on_chunk(std::string_view(window).substr(0, window.size() - max_held));
+                window.erase(0, window.size() - max_held);
+            }
 
-                total_received += bytes_received;
-                std::cout << "Received " << bytes_received << " bytes from "
-                          << client_socket->remote_endpoint().address() << ":"
-                          << client_socket->remote_endpoint().port()
-                          << std::endl;
+            // Synchronous read
+            std::size_t bytes_received;
+            {
+                TraceSpan span("socket read");
+                bytes_received = client_socket->ReadSome(
+                    boost::asio::buffer(&buffer[0], this->CHUNK_SIZE),
+                    error
+                );
             }
-            else if (error == boost::asio::error::eof)
+
+            if (error)
             {
-                // Connection closed by the client
-                std::cout << "Connection closed by the client." << std::endl;
+                // A TLS Client May Close Without close_notify -> Same As EOF
+                if (error == boost::asio::error::eof || error == boost::asio::ssl::error::stream_truncated)
+                {
+                    // Connection closed by the client
+                    std::cout << "Connection closed by the client." << std::endl;
+                }
+                else
+                {
+                    std::cerr << "Error: " << error.message() << std::endl;
+                }
 
                 // Change The Status of the Client_connection
                 client_connection_status = ClientConnectionStatus::ConnectionClose;
-
-                break; // Because The Client Close the Stream
+                break;
             }
-            else
+
+            // Bytes Of A Request Arrived -> It Is In Flight Until FinishRequest()
+            // A Client The Drain Already Let Go Gets No New Request Started
+            if (!client_socket->BeginRequest())
             {
-                // No more data or error on the Client Side
+                client_connection_status = ClientConnectionStatus::ConnectionClose;
                 break;
             }
+
+            window.append(buffer.data(), bytes_received);
         }
 
-        // Check If All data has been received
-        if (total_received > 0)
+        return client_connection_status;
+    }
+
+    std::shared_ptr<SharedMemoryChannel> Server::FindSharedMemory(ClientConnection *client_socket)
+    {
+        std::lock_guard<std::mutex> lock(this->shared_memory_mutex);
+        auto channel = this->shared_memory_channels.find(client_socket);
+        return channel != this->shared_memory_channels.end() ? channel->second : nullptr;
+    }
+
+    /**
+     * @brief Create the two rings of a local client and pass them over its Unix domain socket \n
+     * Reply "SHM <capacity>" carrying six descriptors: the client -> server ring (memfd, data doorbell, space doorbell), \n
+     * then the server -> client ring. From then on every frame of this client goes through the rings
+     *
+     * @param client_socket the local client asking
+     * @param arguments "<ring bytes>" of the "SHM" request (Capped at max_ring_bytes)
+     */
+    void Server::SetUpSharedMemory(std::shared_ptr<ClientConnection> client_socket, std::string_view arguments)
+    {
+        if (!this->shared_memory_options.enabled)
         {
-            std::cout << "All data received successfully!" << std::endl;
+            this->SendText(client_socket, "ERROR shared memory is disabled");
+            return;
         }
-        else
+        if (!client_socket->IsLocal())
         {
-            std::cerr << "No data received or an error occurred." << std::endl;
+            this->SendText(client_socket, "ERROR shared memory needs a local connection");
+            return;
+        }
+        if (this->FindSharedMemory(client_socket.get()))
+        {
+            this->SendText(client_socket, "ERROR shared memory already set up");
+            return;
         }
 
-        // Close the Received File
-        received_file.close();
+        std::uint64_t ring_bytes = 0;
+        if (!ParseUnsigned(arguments, ring_bytes) || ring_bytes == 0)
+        {
+            this->SendText(client_socket, "ERROR invalid ring size");
+            return;
+        }
+        ring_bytes = std::min<std::uint64_t>(ring_bytes, this->shared_memory_options.max_ring_bytes);
 
-        // Open Another File to put the final production
-        decodeFileToFile(temp_file, file_to_store);
+        std::shared_ptr<SharedMemoryChannel> channel = std::make_shared<SharedMemoryChannel>(ring_bytes, this->shared_memory_options.busy_poll_spins);
+        if (!channel->IsOpen())
+        {
+            this->SendText(client_socket, "ERROR unable to create shared memory");
+            return;
+        }
 
-        // Remove the temporary file
-        // TODO: Remember to Uncomment this line below 
-        // std::remove(temp_file.c_str());
+        // The Reply Still Goes Over The Socket: It Is What Carries The Rings
+        boost::system::error_code error;
+        client_socket->SendDescriptors(this->MakeFrame("SHM " + std::to_string(channel->Capacity())), channel->Descriptors(), error);
+        if (error)
+        {
+            std::cerr << "Error: Unable to pass shared memory to " << client_socket->RemoteAddress() << ": " << error.message() << std::endl;
+            return;
+        }
 
-        return client_connection_status;
+        std::lock_guard<std::mutex> lock(this->shared_memory_mutex);
+        this->shared_memory_channels[client_socket.get()] = channel;
+        std::cout << "Shared memory rings of " << channel->Capacity() << " bytes set up with " << client_socket->RemoteAddress() << std::endl;
     }
 
-    //! PRIVATE METHODS SECTIONS
-    //!============================================================================
-    void Server::AcceptConnections()
+    ClientConnectionStatus Server::ReceiveFromSharedMemory(
+        std::shared_ptr<ClientConnection> client_socket,
+        std::shared_ptr<SharedMemoryChannel> channel,
+        const std::function<void(std::string_view)> &on_chunk
+    )
     {
-        // Creating a socket to represent a connected client
-        // Use Shared_ptr to share the owner ship instead of copying them
-        std::shared_ptr<boost::asio::ip::tcp::socket> client_socket = std::make_shared<boost::asio::ip::tcp::socket>(this->io_context);
+        std::string message;
+        while (true)
+        {
+            RingStatus status;
+            {
+                TraceSpan span("ring read");
+                status = channel->Receive(message, SHARED_MEMORY_POLL_INTERVAL, client_socket->NativeHandle());
+            }
 
-        // Start an asynchronous accept operation
-        this->acceptor_server->async_accept(
-            *client_socket,
-            [this, client_socket](const boost::system::error_code &error) {
-                this->HandleAccept(error, client_socket);
-        });
+            if (status == RingStatus::RingOk)
+            {
+                // A Client The Drain Already Let Go Gets No New Request Started
+                if (!client_socket->BeginRequest())
+                {
+                    return ClientConnectionStatus::ConnectionClose;
+                }
+                if (!message.empty())
+                {
+                    on_chunk(message);
+                }
+                return ClientConnectionStatus::ConnectionOpen;
+            }
 
-        // Run the io_context to process asynchronous operations
-        this->io_context.run();
+            if (status == RingStatus::RingClosed)
+            {
+                std::cout << "Connection closed by the client." << std::endl;
+                return ClientConnectionStatus::ConnectionClose;
+            }
+
+            // Closed By The Server Meanwhile (Timeout, Drain, Stop)
+            if (!client_socket->IsOpen())
+            {
+                return ClientConnectionStatus::ConnectionClose;
+            }
+        }
     }
 
-    void Server::HandleAccept(const boost::system::error_code &error, std::shared_ptr<boost::asio::ip::tcp::socket> client_socket)
+    bool Server::SendToSharedMemory(
+        std::shared_ptr<ClientConnection> client_socket,
+        std::shared_ptr<SharedMemoryChannel> channel,
+        std::string_view message
+    )
     {
-        if (!error)
+        RingStatus status;
+        do
         {
-            // Connection accepted. Handle the connection using client_socket.
-            // Get CLIENT'S IP Address and port
-            boost::asio::ip::tcp::endpoint client_endpoint = client_socket->remote_endpoint();
-            std::cout << "Connected To Client: "
-                      << client_endpoint.address()
-                      << ":"
-                      << client_endpoint.port()
-                      << std::endl;
-
-            // Greeting The User
-            // DEBUG: For Testing Send Data Section
-            // this->SendText(client_socket, "Hello World\n");
-            // this->SendTextBasedFile(client_socket, "hello.json");
-            // this->SendTextBasedFile(client_socket, "Road 4.png");
-
-            // Authentication Part
-
-            // Create A thread To Handle The Client
-            std::thread client_thread([this](std::shared_ptr<boost::asio::ip::tcp::socket> client_socket) { 
-                this->HandleClient(client_socket); 
-            }, client_socket);
-            client_thread.detach();
+            status = channel->Send(message, SHARED_MEMORY_POLL_INTERVAL, client_socket->NativeHandle());
+        } while (status == RingStatus::RingFull && client_socket->IsOpen());
 
-            this->clients_connections.insert(client_socket);
+        if (status != RingStatus::RingOk)
+        {
+            std::cerr << "Error: Unable to send to the shared memory of " << client_socket->RemoteAddress()
+                      << (status == RingStatus::RingTooLarge ? ": message larger than the ring" : ": ring closed") << std::endl;
+            return false;
         }
+        return true;
     }
 
-    void Server::HandleClient(std::shared_ptr<boost::asio::ip::tcp::socket> client_socket)
+    /**
+     * @brief Read the trailer frame after a received file and compare it with the checksums computed while receiving \n
+     * Reply "OK <trailer>" if they agree or "MISMATCH <computed trailer>" otherwise
+     *
+     * @param client_socket The client_socket sent from
+     * @param checksum The checksums of the received bytes
+     * @param client_connection_status Set to ConnectionClose if the client closed while sending the trailer
+     * @return true if the transfer is intact or no trailer is expected
+     */
+    bool Server::VerifyIntegrityTrailer(
+        std::shared_ptr<ClientConnection> client_socket,
+        TransferChecksum &checksum,
+        ClientConnectionStatus &client_connection_status
+    )
     {
-        std::cout << "Handle Here!" << std::endl;
-
-        // To Check For the client_connection has closed 
-        ClientConnectionStatus clients_connection_status = ClientConnectionStatus::ConnectionOpen;
+        if (this->transfer_integrity == TransferIntegrity::IntegrityNone)
+        {
+            return true;
+        }
 
-        // DEBUG: For Testing Listenning Method Protocol
-        // While the Server is Running
-        // Still Listen
-        // std::string received_text;
-        std::string file_to_store = "decoded.png";
-        // std::string file_to_store = "hello.txt";
-        while (clients_connection_status == ClientConnectionStatus::ConnectionOpen)
+        if (client_connection_status == ClientConnectionStatus::ConnectionClose)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            // clients_connection_status = this->GetText(client_socket, received_text);
-            // clients_connection_status = this->GetTextBasedFile(client_socket, file_to_store);
-            clients_connection_status = this->GetBinaryFile(client_socket, file_to_store);
+            // Truncated -> No Trailer Will Come
+            std::cerr << "Transfer truncated before the integrity trailer." << std::endl;
+            return false;
         }
 
-        // Show A Log for close the client_socket
-        std::cout << "Close connection with Client: "
-                  << client_socket->remote_endpoint().address() << ":"
-                  << client_socket->remote_endpoint().port() << std::endl;
+        std::string computed_trailer = checksum.FinalTrailer();
 
-        // If the client_socket closed
-        // -> Remove From The Set of client_sockets
-        this->clients_connections.erase(client_socket);
+        std::string received_trailer;
+        client_connection_status = this->GetText(client_socket, received_trailer);
+        if (client_connection_status == ClientConnectionStatus::ConnectionClose)
+        {
+            std::cerr << "Transfer truncated before the integrity trailer." << std::endl;
+            return false;
+        }
 
-        // Close the client_socket
-        client_socket->close();
+        if (TransferChecksum::TrailerMatches(received_trailer, computed_trailer))
+        {
+            this->SendText(client_socket, "OK " + computed_trailer);
+            return true;
+        }
 
-        // -> end Thread
+        std::cerr << "Integrity mismatch: client sent [" << received_trailer << "] computed [" << computed_trailer << "]" << std::endl;
+        this->SendText(client_socket, "MISMATCH " + computed_trailer);
+        return false;
     }
 } // namespace SN_Server
@@ -0,0 +1,502 @@
+#include "../include/ServerConfig.h"
+#include "../include/simdjson.h"
+#include <charconv>
+#include <functional>
+#include <map>
+
+namespace SN_Server
+{
+    namespace
+    {
+        //* Text Values Of A Key (From The Command Line, Or A JSON Scalar Printed Back)
+        template <typename Number>
+        bool ParseNumber(std::string_view value, Number &number)
+        {
+            const char *end = value.data() + value.size();
+            std::from_chars_result result = std::from_chars(value.data(), end, number);
+            return result.ec == std::errc() && result.ptr == end;
+        }
+
+        bool ParseBool(std::string_view value, bool &flag)
+        {
+            if (value == "true" || value == "1" || value == "on")
+            {
+                flag = true;
+                return true;
+            }
+            if (value == "false" || value == "0" || value == "off")
+            {
+                flag = false;
+                return true;
+            }
+            return false;
+        }
+
+        bool ParseMilliseconds(std::string_view value, std::chrono::milliseconds &duration)
+        {
+            std::int64_t count;
+            if (!ParseNumber(value, count) || count < 0)
+            {
+                return false;
+            }
+            duration = std::chrono::milliseconds(count);
+            return true;
+        }
+
+        using ConfigSetter = std::function<bool(std::string_view, ServerConfig &)>;
+
+        template <typename Number>
+        ConfigSetter NumberSetter(Number ServerConfig::*member_of_config)
+        {
+            return [member_of_config](std::string_view value, ServerConfig &config) {
+                return ParseNumber(value, config.*member_of_config);
+            };
+        }
+
+        ConfigSetter StringSetter(std::string ServerConfig::*member_of_config)
+        {
+            return [member_of_config](std::string_view value, ServerConfig &config) {
+                config.*member_of_config = std::string(value);
+                return true;
+            };
+        }
+
+        //* Every Key The Configuration Knows
+        const std::map<std::string_view, ConfigSetter> &ConfigKeys()
+        {
+            static const std::map<std::string_view, ConfigSetter> config_keys = {
+                {"bind_address", StringSetter(&ServerConfig::bind_address)},
+                {"port", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.port) && config.port != 0;
+                }},
+                {"local_socket", StringSetter(&ServerConfig::local_socket)},
+                {"io_threads", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.io_threads) && config.io_threads > 0;
+                }},
+                {"disk_threads", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.disk_threads) && config.disk_threads > 0;
+                }},
+                {"direct_io.threshold_bytes", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.direct_io.threshold_bytes);
+                }},
+                {"framing", [](std::string_view value, ServerConfig &config) {
+                    config.framing = std::string(value);
+                    return value == "text" || value == "json";
+                }},
+                {"end_signal", [](std::string_view value, ServerConfig &config) {
+                    config.end_signal = std::string(value);
+                    return !value.empty();
+                }},
+                {"chunk_size", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.chunk_size) && config.chunk_size > 0;
+                }},
+                {"ndjson_batch_size", NumberSetter(&ServerConfig::ndjson_batch_size)},
+                {"content_store", StringSetter(&ServerConfig::content_store)},
+                {"files_directory", StringSetter(&ServerConfig::files_directory)},
+                {"max_upload_bytes", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.max_upload_bytes);
+                }},
+                {"file_cache_bytes", NumberSetter(&ServerConfig::file_cache_bytes)},
+                {"encoded_cache_bytes", NumberSetter(&ServerConfig::encoded_cache_bytes)},
+                {"integrity", [](std::string_view value, ServerConfig &config) {
+                    if (value == "none")
+                    {
+                        config.integrity = TransferIntegrity::IntegrityNone;
+                    }
+                    else if (value == "crc32c")
+                    {
+                        config.integrity = TransferIntegrity::IntegrityCrc32c;
+                    }
+                    else if (value == "crc32c+sha256")
+                    {
+                        config.integrity = TransferIntegrity::IntegrityCrc32cSha256;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    return true;
+                }},
+                {"transfer_journal", StringSetter(&ServerConfig::transfer_journal)},
+                {"tls.certificate", StringSetter(&ServerConfig::tls_certificate)},
+                {"tls.private_key", StringSetter(&ServerConfig::tls_private_key)},
+                {"send_queue.high_watermark", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.send_queue.high_watermark);
+                }},
+                {"send_queue.low_watermark", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.send_queue.low_watermark);
+                }},
+                {"send_queue.overflow_policy", [](std::string_view value, ServerConfig &config) {
+                    if (value == "block")
+                    {
+                        config.send_queue.overflow_policy = OverflowPolicy::OverflowBlock;
+                    }
+                    else if (value == "drop_oldest")
+                    {
+                        config.send_queue.overflow_policy = OverflowPolicy::OverflowDropOldest;
+                    }
+                    else if (value == "disconnect")
+                    {
+                        config.send_queue.overflow_policy = OverflowPolicy::OverflowDisconnect;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    return true;
+                }},
+                {"send_queue.memory_limit", NumberSetter(&ServerConfig::send_memory_limit)},
+                {"admission.max_connections", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.admission.max_connections);
+                }},
+                {"admission.max_connections_per_address", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.admission.max_connections_per_address);
+                }},
+                {"admission.accepts_per_second", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.admission.accepts_per_second) && config.admission.accepts_per_second >= 0;
+                }},
+                {"admission.accept_burst", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.admission.accept_burst);
+                }},
+                {"admission.max_buffered_bytes", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.admission.max_buffered_bytes);
+                }},
+                {"admission.send_busy_frame", [](std::string_view value, ServerConfig &config) {
+                    return ParseBool(value, config.admission.send_busy_frame);
+                }},
+                {"admission.retry_after_seconds", [](std::string_view value, ServerConfig &config) {
+                    std::int64_t seconds;
+                    if (!ParseNumber(value, seconds) || seconds < 0)
+                    {
+                        return false;
+                    }
+                    config.admission.retry_after = std::chrono::seconds(seconds);
+                    return true;
+                }},
+                {"timeouts.idle_ms", [](std::string_view value, ServerConfig &config) {
+                    return ParseMilliseconds(value, config.timeouts.idle_timeout);
+                }},
+                {"timeouts.read_ms", [](std::string_view value, ServerConfig &config) {
+                    return ParseMilliseconds(value, config.timeouts.read_timeout);
+                }},
+                {"timeouts.write_ms", [](std::string_view value, ServerConfig &config) {
+                    return ParseMilliseconds(value, config.timeouts.write_timeout);
+                }},
+                {"timeouts.heartbeat_ms", [](std::string_view value, ServerConfig &config) {
+                    return ParseMilliseconds(value, config.timeouts.heartbeat_interval);
+                }},
+                {"drain_deadline_ms", [](std::string_view value, ServerConfig &config) {
+                    return ParseMilliseconds(value, config.drain_deadline);
+                }},
+                {"socket.no_delay", [](std::string_view value, ServerConfig &config) {
+                    return ParseBool(value, config.socket.no_delay);
+                }},
+                {"socket.keep_alive", [](std::string_view value, ServerConfig &config) {
+                    return ParseBool(value, config.socket.keep_alive);
+                }},
+                {"socket.receive_buffer_size", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.socket.receive_buffer_size) && config.socket.receive_buffer_size >= 0;
+                }},
+                {"socket.send_buffer_size", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.socket.send_buffer_size) && config.socket.send_buffer_size >= 0;
+                }},
+                {"socket.reuse_address", [](std::string_view value, ServerConfig &config) {
+                    return ParseBool(value, config.socket.reuse_address);
+                }},
+                {"socket.listen_backlog", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.socket.listen_backlog) && config.socket.listen_backlog > 0;
+                }},
+                {"shared_memory.enabled", [](std::string_view value, ServerConfig &config) {
+                    return ParseBool(value, config.shared_memory.enabled);
+                }},
+                {"shared_memory.max_ring_bytes", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.shared_memory.max_ring_bytes) && config.shared_memory.max_ring_bytes > 0;
+                }},
+                {"shared_memory.busy_poll_spins", [](std::string_view value, ServerConfig &config) {
+                    return ParseNumber(value, config.shared_memory.busy_poll_spins);
+                }},
+                {"trace.sample_every", NumberSetter(&ServerConfig::trace_sample_every)},
+                {"trace.file", StringSetter(&ServerConfig::trace_file)},
+            };
+            return config_keys;
+        }
+
+        //* Walk A JSON Value: Objects Add A Level To The Dotted Key, Scalars Are Set As Text
+        bool SetFromJson(simdjson::dom::element element, std::string &key, ServerConfig &config, std::string &error)
+        {
+            switch (element.type())
+            {
+            case simdjson::dom::element_type::OBJECT:
+            {
+                for (simdjson::dom::key_value_pair field : element.get_object())
+                {
+                    // "profile" Was Applied Before Everything Else
+                    if (key.empty() && field.key == "profile")
+                    {
+                        continue;
+                    }
+
+                    std::size_t parent_size = key.size();
+                    if (!key.empty())
+                    {
+                        key += '.';
+                    }
+                    key += field.key;
+                    if (!SetFromJson(field.value, key, config, error))
+                    {
+                        return false;
+                    }
+                    key.resize(parent_size);
+                }
+                return true;
+            }
+
+            case simdjson::dom::element_type::STRING:
+                return SetServerConfigValue(key, element.get_string().value(), config, error);
+
+            case simdjson::dom::element_type::BOOL:
+                return SetServerConfigValue(key, element.get_bool().value() ? "true" : "false", config, error);
+
+            case simdjson::dom::element_type::INT64:
+            case simdjson::dom::element_type::UINT64:
+            case simdjson::dom::element_type::DOUBLE:
+                return SetServerConfigValue(key, simdjson::minify(element), config, error);
+
+            default:
+                error = "\"" + key + "\": arrays and null are not configuration values";
+                return false;
+            }
+        }
+
+        bool LoadConfigFile(const std::string &config_file, ServerConfig &config, std::string &error, bool apply_file_profile)
+        {
+            simdjson::dom::parser parser;
+            simdjson::dom::element root;
+            simdjson::error_code parse_error = parser.load(config_file).get(root);
+            if (parse_error)
+            {
+                error = config_file + ": " + simdjson::error_message(parse_error);
+                return false;
+            }
+
+            if (root.type() != simdjson::dom::element_type::OBJECT)
+            {
+                error = config_file + ": the configuration must be a JSON object";
+                return false;
+            }
+
+            std::string_view profile;
+            if (apply_file_profile && root["profile"].get(profile) == simdjson::SUCCESS && !ApplyTuningProfile(profile, config, error))
+            {
+                error = config_file + ": " + error;
+                return false;
+            }
+
+            std::string key;
+            if (!SetFromJson(root, key, config, error))
+            {
+                error = config_file + ": " + error;
+                return false;
+            }
+            return true;
+        }
+
+        //* "--key=value" Or "--key value" (index Then Moves Onto The Value)
+        bool SplitArgument(int argc, char const *argv[], int &index, std::string_view &key, std::string_view &value)
+        {
+            std::string_view argument = argv[index];
+            if (argument.substr(0, 2) != "--")
+            {
+                return false;
+            }
+            argument.remove_prefix(2);
+
+            std::size_t equals = argument.find('=');
+            if (equals != std::string_view::npos)
+            {
+                key = argument.substr(0, equals);
+                value = argument.substr(equals + 1);
+                return true;
+            }
+
+            if (index + 1 >= argc)
+            {
+                return false;
+            }
+            key = argument;
+            value = argv[++index];
+            return true;
+        }
+    }
+
+    /**
+     * @brief Set the starting values of a tuning profile: \n
+     * "latency": TCP_NODELAY, small read chunks, short send queues, so a frame is never waiting behind a big one, busy-polled rings \n
+     * "throughput": large read chunks, large socket buffers and send queues, big NDJSON batches, direct I/O from 256 MiB
+     *
+     * @param profile "default", "latency" or "throughput"
+     * @param config the configuration to change
+     * @param error why it failed
+     * @return true if the profile exists
+     */
+    bool ApplyTuningProfile(std::string_view profile, ServerConfig &config, std::string &error)
+    {
+        if (profile == "default")
+        {
+            return true;
+        }
+
+        if (profile == "latency")
+        {
+            config.socket.no_delay = true;
+            config.chunk_size = 4 * 1024;
+            config.ndjson_batch_size = 64 * 1024;
+            config.send_queue.high_watermark = 1024 * 1024;
+            config.send_queue.low_watermark = 256 * 1024;
+            config.shared_memory.busy_poll_spins = 100000;
+            return true;
+        }
+
+        if (profile == "throughput")
+        {
+            config.socket.no_delay = false;
+            config.socket.receive_buffer_size = 4 * 1024 * 1024;
+            config.socket.send_buffer_size = 4 * 1024 * 1024;
+            config.chunk_size = 64 * 1024;
+            config.direct_io.threshold_bytes = 256 * 1024 * 1024;
+            config.ndjson_batch_size = 4 * 1024 * 1024;
+            config.send_queue.high_watermark = 32 * 1024 * 1024;
+            config.send_queue.low_watermark = 8 * 1024 * 1024;
+            return true;
+        }
+
+        error = "unknown profile \"" + std::string(profile) + "\" (default, latency, throughput)";
+        return false;
+    }
+
+    bool SetServerConfigValue(std::string_view key, std::string_view value, ServerConfig &config, std::string &error)
+    {
+        const std::map<std::string_view, ConfigSetter> &config_keys = ConfigKeys();
+        auto config_key = config_keys.find(key);
+        if (config_key == config_keys.end())
+        {
+            error = "unknown configuration key \"" + std::string(key) + "\"";
+            return false;
+        }
+
+        if (!config_key->second(value, config))
+        {
+            error = "invalid value \"" + std::string(value) + "\" for \"" + std::string(key) + "\"";
+            return false;
+        }
+        return true;
+    }
+
+    bool LoadServerConfigFile(const std::string &config_file, ServerConfig &config, std::string &error)
+    {
+        return LoadConfigFile(config_file, config, error, true);
+    }
+
+    /**
+     * @brief Build the configuration from the command line: \n
+     * 1. The profile (--profile, else the file's "profile") \n
+     * 2. The JSON file of --config \n
+     * 3. Every other --key=value, in order (e.g. --port=7000 --admission.max_connections 512)
+     *
+     * @param argc from main
+     * @param argv from main
+     * @param config starts from its current values
+     * @param error why it failed
+     * @return true if every argument and the file were valid
+     */
+    bool LoadServerConfig(int argc, char const *argv[], ServerConfig &config, std::string &error)
+    {
+        std::string_view config_file;
+        std::string_view profile;
+        for (int index = 1; index < argc; index++)
+        {
+            std::string_view key;
+            std::string_view value;
+            if (!SplitArgument(argc, argv, index, key, value))
+            {
+                error = "expected --key=value, got \"" + std::string(argv[index]) + "\"";
+                return false;
+            }
+
+            if (key == "config")
+            {
+                config_file = value;
+            }
+            else if (key == "profile")
+            {
+                profile = value;
+            }
+        }
+
+        if (!profile.empty() && !ApplyTuningProfile(profile, config, error))
+        {
+            return false;
+        }
+
+        if (!config_file.empty() && !LoadConfigFile(std::string(config_file), config, error, profile.empty()))
+        {
+            return false;
+        }
+
+        for (int index = 1; index < argc; index++)
+        {
+            std::string_view key;
+            std::string_view value;
+            SplitArgument(argc, argv, index, key, value);
+            if (key != "config" && key != "profile" && !SetServerConfigValue(key, value, config, error))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Hand every setting to the server (It must not be started yet)
+     *
+     * @param config the configuration
+     * @param server a server built on config.bind_address and config.port
+     * @return true unless TLS or the transfer journal could not be set up
+     */
+    bool ApplyServerConfig(const ServerConfig &config, Server &server)
+    {
+        server.SetIoThreads(config.io_threads);
+        server.SetDiskThreads(config.disk_threads);
+        server.SetDirectIoOptions(config.direct_io);
+        server.SetLocalSocketPath(config.local_socket);
+        server.SetSocketOptions(config.socket);
+        server.SetChunkData(config.chunk_size);
+        server.SetEndSignal(config.end_signal);
+        server.SetJsonMode(config.framing == "json");
+        server.SetNdjsonBatchSize(config.ndjson_batch_size);
+        server.SetContentStoreDirectory(config.content_store);
+        server.SetFilesDirectory(config.files_directory);
+        server.SetMaxUploadBytes(config.max_upload_bytes);
+        server.SetFileCacheBytes(config.file_cache_bytes);
+        server.SetEncodedCacheBytes(config.encoded_cache_bytes);
+        server.SetTransferIntegrity(config.integrity);
+        server.SetSendQueueLimits(config.send_queue);
+        server.SetSendMemoryLimit(config.send_memory_limit);
+        server.SetAdmissionLimits(config.admission);
+        server.SetSessionTimeouts(config.timeouts);
+        server.SetSharedMemoryOptions(config.shared_memory);
+        server.EnableTracing(config.trace_sample_every);
+
+        if (!config.tls_certificate.empty() && !config.tls_private_key.empty() &&
+            !server.EnableTls(config.tls_certificate, config.tls_private_key))
+        {
+            return false;
+        }
+
+        if (!config.transfer_journal.empty() && !server.EnableTransferJournal(config.transfer_journal))
+        {
+            return false;
+        }
+        return true;
+    }
+}
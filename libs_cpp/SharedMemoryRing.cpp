@@ -0,0 +1,481 @@
+#include "../include/SharedMemoryRing.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SN_Server
+{
+    namespace
+    {
+        // "SNRING01", Tells A Ring Apart From Any Other memfd
+        constexpr std::uint64_t RING_MAGIC = 0x3130474E49524E53ULL;
+
+        constexpr std::size_t MIN_CAPACITY = 4096;
+
+        // Records Start On 8-Byte Boundaries: 4 Bytes Of Length, Then The Message
+        constexpr std::size_t RECORD_ALIGNMENT = 8;
+        constexpr std::size_t LENGTH_SIZE = sizeof(std::uint32_t);
+
+        // Length Meaning "The Rest Up To The End Is Unused, Continue At The Start"
+        constexpr std::uint32_t WRAP_MARKER = 0xFFFFFFFFu;
+
+        // A Mapped Ring That Could Shrink Would Turn Any Access Past Its New End Into SIGBUS
+        constexpr int RING_SEALS = F_SEAL_SHRINK | F_SEAL_GROW;
+
+        std::size_t RecordSize(std::size_t message_size)
+        {
+            return (LENGTH_SIZE + message_size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+        }
+
+        std::size_t RoundUpToPowerOfTwo(std::size_t value)
+        {
+            std::size_t power = MIN_CAPACITY;
+            while (power < value)
+            {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        void RingDoorbell(int doorbell)
+        {
+            if (doorbell >= 0)
+            {
+                ::eventfd_write(doorbell, 1);
+            }
+        }
+    }
+
+    //* INFO: SharedMemoryRing
+    /**
+     * @brief Create a new ring in an anonymous memfd, with its two eventfd doorbells \n
+     * Hand Descriptors() to the other process (e.g. with SCM_RIGHTS) so it can map the same ring \n
+     * The memfd is sealed at its size first, so the other process can never shrink it under our mapping
+     *
+     * @param capacity bytes of records (Rounded up to a power of two, at least 4 KiB)
+     */
+    SharedMemoryRing::SharedMemoryRing(std::size_t capacity)
+    {
+        std::size_t ring_capacity = RoundUpToPowerOfTwo(capacity);
+        std::size_t total_bytes = sizeof(Header) + ring_capacity;
+
+        this->memory_descriptor = ::memfd_create("sn-server-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        this->data_ready_descriptor = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        this->space_ready_descriptor = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (this->memory_descriptor < 0 || this->data_ready_descriptor < 0 || this->space_ready_descriptor < 0 ||
+            ::ftruncate(this->memory_descriptor, static_cast<off_t>(total_bytes)) != 0 ||
+            ::fcntl(this->memory_descriptor, F_ADD_SEALS, RING_SEALS) != 0 ||
+            !this->Map(total_bytes))
+        {
+            std::cerr << "Error: Unable to create shared memory ring: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        // A Fresh memfd Is All Zeros: Positions Start At 0
+        this->header = new (this->header) Header();
+        this->header->magic = RING_MAGIC;
+        this->header->capacity = ring_capacity;
+        this->capacity = ring_capacity;
+    }
+
+    /**
+     * @brief Map a ring created by the other process \n
+     * The header is checked, a memfd that is not a ring (Or not sealed against shrinking) leaves this closed (IsOpen() false) \n
+     * The capacity and positions are taken from the header once, here, and never again
+     *
+     * @param memory_descriptor the ring's memfd
+     * @param data_ready_descriptor eventfd rung when a message is written
+     * @param space_ready_descriptor eventfd rung when a message is read
+     */
+    SharedMemoryRing::SharedMemoryRing(int memory_descriptor, int data_ready_descriptor, int space_ready_descriptor)
+        : memory_descriptor(memory_descriptor),
+          data_ready_descriptor(data_ready_descriptor),
+          space_ready_descriptor(space_ready_descriptor)
+    {
+        struct stat memory_status;
+        int seals = ::fcntl(this->memory_descriptor, F_GET_SEALS);
+        if (seals < 0 || (seals & F_SEAL_SHRINK) == 0 ||
+            ::fstat(this->memory_descriptor, &memory_status) != 0 ||
+            static_cast<std::size_t>(memory_status.st_size) < sizeof(Header) + MIN_CAPACITY ||
+            !this->Map(static_cast<std::size_t>(memory_status.st_size)))
+        {
+            std::cerr << "Error: Unable to map shared memory ring" << std::endl;
+            return;
+        }
+
+        std::uint64_t capacity = this->header->capacity;
+        std::uint64_t write_position = this->header->write_position.load(std::memory_order_acquire);
+        std::uint64_t read_position = this->header->read_position.load(std::memory_order_acquire);
+        bool is_ring = this->header->magic == RING_MAGIC && capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+                       sizeof(Header) + capacity == this->mapped_bytes;
+        bool is_consistent = write_position % RECORD_ALIGNMENT == 0 && read_position % RECORD_ALIGNMENT == 0 &&
+                             write_position - read_position <= capacity;
+        if (is_ring && is_consistent)
+        {
+            this->capacity = capacity;
+            this->own_write_position = write_position;
+            this->own_read_position = read_position;
+        }
+        else
+        {
+            std::cerr << "Error: Shared memory is not a ring" << std::endl;
+            ::munmap(this->header, this->mapped_bytes);
+            this->header = nullptr;
+            this->records = nullptr;
+        }
+    }
+
+    SharedMemoryRing::~SharedMemoryRing()
+    {
+        if (this->header != nullptr)
+        {
+            ::munmap(this->header, this->mapped_bytes);
+        }
+        for (int descriptor : {this->memory_descriptor, this->data_ready_descriptor, this->space_ready_descriptor})
+        {
+            if (descriptor >= 0)
+            {
+                ::close(descriptor);
+            }
+        }
+    }
+
+    bool SharedMemoryRing::Map(std::size_t mapped_bytes)
+    {
+        void *address = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->memory_descriptor, 0);
+        if (address == MAP_FAILED)
+        {
+            return false;
+        }
+
+        this->header = static_cast<Header *>(address);
+        this->records = static_cast<char *>(address) + sizeof(Header);
+        this->mapped_bytes = mapped_bytes;
+        return true;
+    }
+
+    bool SharedMemoryRing::IsOpen() const
+    {
+        return this->header != nullptr;
+    }
+
+    std::size_t SharedMemoryRing::Capacity() const
+    {
+        return this->header != nullptr ? this->capacity : 0;
+    }
+
+    std::size_t SharedMemoryRing::MaxMessageSize() const
+    {
+        // Half The Ring: Even After Skipping To The Start, An Empty Ring Has Room For It
+        return this->header != nullptr ? this->capacity / 2 - LENGTH_SIZE : 0;
+    }
+
+    void SharedMemoryRing::SetBusyPollSpins(std::size_t busy_poll_spins)
+    {
+        this->busy_poll_spins = busy_poll_spins;
+    }
+
+    bool SharedMemoryRing::HasMessage() const
+    {
+        return this->own_read_position != this->header->write_position.load(std::memory_order_acquire);
+    }
+
+    bool SharedMemoryRing::HasRoom() const
+    {
+        // Any Room At All: TryWrite Tells Whether The Message Fits (Or That The Reader's Position Is Corrupt)
+        std::uint64_t used = this->own_write_position - this->header->read_position.load(std::memory_order_acquire);
+        return used != this->capacity;
+    }
+
+    /**
+     * @brief Wait for the other side: spin busy_poll_spins times, then announce the sleep and block on the doorbell \n
+     * The announcement is re-checked after a full fence, so a message written meanwhile is never slept through
+     *
+     * @return RingOk once ready, RingClosed if the ring closed or hangup_descriptor hung up, RingEmpty at the timeout
+     */
+    RingStatus SharedMemoryRing::WaitFor(
+        int doorbell,
+        std::atomic<std::uint32_t> &is_sleeping,
+        bool (SharedMemoryRing::*is_ready)() const,
+        std::chrono::milliseconds timeout,
+        int hangup_descriptor
+    )
+    {
+        for (std::size_t spin = 0; spin < this->busy_poll_spins; spin++)
+        {
+            if ((this->*is_ready)() || this->IsClosed())
+            {
+                return RingStatus::RingOk;
+            }
+        }
+
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            is_sleeping.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if ((this->*is_ready)() || this->IsClosed())
+            {
+                is_sleeping.store(0, std::memory_order_relaxed);
+                return RingStatus::RingOk;
+            }
+
+            std::chrono::milliseconds remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+            {
+                is_sleeping.store(0, std::memory_order_relaxed);
+                return RingStatus::RingEmpty;
+            }
+
+            // Also Watch The Connection: A Client That Died Never Rings Again
+            pollfd waits[2] = {{doorbell, POLLIN, 0}, {hangup_descriptor, POLLRDHUP, 0}};
+            int ready = ::poll(waits, hangup_descriptor >= 0 ? 2 : 1, static_cast<int>(remaining.count()));
+            is_sleeping.store(0, std::memory_order_relaxed);
+
+            if (ready > 0 && (waits[0].revents & POLLIN))
+            {
+                eventfd_t rings;
+                ::eventfd_read(doorbell, &rings);
+            }
+            if (ready > 0 && hangup_descriptor >= 0 && (waits[1].revents & (POLLRDHUP | POLLHUP | POLLERR)))
+            {
+                return RingStatus::RingClosed;
+            }
+        }
+    }
+
+    RingStatus SharedMemoryRing::TryWrite(std::string_view message)
+    {
+        if (this->header == nullptr || this->IsClosed())
+        {
+            return RingStatus::RingClosed;
+        }
+        if (message.size() > this->MaxMessageSize())
+        {
+            return RingStatus::RingTooLarge;
+        }
+
+        const std::uint64_t capacity = this->capacity;
+        std::uint64_t write_position = this->own_write_position;
+        std::uint64_t read_position = this->header->read_position.load(std::memory_order_acquire);
+        if (write_position - read_position > capacity)
+        {
+            // Scribbled Over By The Other Process: The Reader Cannot Be Ahead, Nor A Whole Ring Behind
+            std::cerr << "Error: Corrupt shared memory ring, closing it" << std::endl;
+            this->Close();
+            return RingStatus::RingClosed;
+        }
+
+        std::size_t record_size = RecordSize(message.size());
+        std::size_t offset = write_position & (capacity - 1);
+        std::size_t to_end = capacity - offset;
+        std::size_t skipped = to_end < record_size ? to_end : 0;
+        if (capacity - (write_position - read_position) < skipped + record_size)
+        {
+            return RingStatus::RingFull;
+        }
+
+        if (skipped > 0)
+        {
+            std::memcpy(this->records + offset, &WRAP_MARKER, LENGTH_SIZE);
+            write_position += skipped;
+            offset = 0;
+        }
+
+        std::uint32_t length = static_cast<std::uint32_t>(message.size());
+        std::memcpy(this->records + offset, &length, LENGTH_SIZE);
+        std::memcpy(this->records + offset + LENGTH_SIZE, message.data(), message.size());
+        this->own_write_position = write_position + record_size;
+        this->header->write_position.store(this->own_write_position, std::memory_order_release);
+
+        // Pairs With The Fence In WaitFor: Either The Reader Sees The Message Or We See It Sleeping
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->header->is_reader_sleeping.load(std::memory_order_relaxed))
+        {
+            RingDoorbell(this->data_ready_descriptor);
+        }
+        return RingStatus::RingOk;
+    }
+
+    RingStatus SharedMemoryRing::Write(std::string_view message, std::chrono::milliseconds timeout, int hangup_descriptor)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            RingStatus status = this->TryWrite(message);
+            if (status != RingStatus::RingFull)
+            {
+                return status;
+            }
+
+            std::chrono::milliseconds remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+            {
+                return RingStatus::RingFull;
+            }
+
+            // Room Was Made, But Maybe Not Enough: Try Again
+            RingStatus waited = this->WaitFor(this->space_ready_descriptor, this->header->is_writer_sleeping, &SharedMemoryRing::HasRoom, remaining, hangup_descriptor);
+            if (waited == RingStatus::RingClosed)
+            {
+                return waited;
+            }
+        }
+    }
+
+    RingStatus SharedMemoryRing::TryRead(std::string &message)
+    {
+        if (this->header == nullptr)
+        {
+            return RingStatus::RingClosed;
+        }
+
+        const std::uint64_t capacity = this->capacity;
+        std::uint64_t read_position = this->own_read_position;
+        std::uint64_t write_position = this->header->write_position.load(std::memory_order_acquire);
+        if (read_position == write_position)
+        {
+            // Closed Only Once Everything Written Before The Close Was Read
+            if (!this->IsClosed())
+            {
+                return RingStatus::RingEmpty;
+            }
+            return read_position == this->header->write_position.load(std::memory_order_acquire) ? RingStatus::RingClosed : this->TryRead(message);
+        }
+
+        // Never Trust The Other Process: Its Position Is Bounded By Ours And The Capacity We Validated,
+        // Every Offset Comes From Our Own Position, And Every Record Must Lie Inside What It Published
+        std::size_t offset = read_position & (capacity - 1);
+        std::uint32_t length = 0;
+        std::uint64_t available = write_position - read_position;
+        bool is_valid = available <= capacity && available >= LENGTH_SIZE;
+        if (is_valid)
+        {
+            std::memcpy(&length, this->records + offset, LENGTH_SIZE);
+            if (length == WRAP_MARKER)
+            {
+                std::uint64_t skipped = capacity - offset;
+                is_valid = available > skipped && available - skipped >= LENGTH_SIZE;
+                read_position += skipped;
+                available -= skipped;
+                offset = 0;
+                if (is_valid)
+                {
+                    std::memcpy(&length, this->records, LENGTH_SIZE);
+                }
+            }
+            is_valid = is_valid && length <= this->MaxMessageSize() && RecordSize(length) <= available && offset + RecordSize(length) <= capacity;
+        }
+        if (!is_valid)
+        {
+            std::cerr << "Error: Corrupt shared memory ring, closing it" << std::endl;
+            this->Close();
+            return RingStatus::RingClosed;
+        }
+
+        message.assign(this->records + offset + LENGTH_SIZE, length);
+        this->own_read_position = read_position + RecordSize(length);
+        this->header->read_position.store(this->own_read_position, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->header->is_writer_sleeping.load(std::memory_order_relaxed))
+        {
+            RingDoorbell(this->space_ready_descriptor);
+        }
+        return RingStatus::RingOk;
+    }
+
+    RingStatus SharedMemoryRing::Read(std::string &message, std::chrono::milliseconds timeout, int hangup_descriptor)
+    {
+        RingStatus status = this->TryRead(message);
+        if (status != RingStatus::RingEmpty)
+        {
+            return status;
+        }
+
+        RingStatus waited = this->WaitFor(this->data_ready_descriptor, this->header->is_reader_sleeping, &SharedMemoryRing::HasMessage, timeout, hangup_descriptor);
+        if (waited != RingStatus::RingOk)
+        {
+            return waited;
+        }
+        return this->TryRead(message);
+    }
+
+    void SharedMemoryRing::Close()
+    {
+        if (this->header == nullptr)
+        {
+            return;
+        }
+
+        this->header->is_closed.store(1, std::memory_order_release);
+        RingDoorbell(this->data_ready_descriptor);
+        RingDoorbell(this->space_ready_descriptor);
+    }
+
+    bool SharedMemoryRing::IsClosed() const
+    {
+        return this->header == nullptr || this->header->is_closed.load(std::memory_order_acquire) != 0;
+    }
+
+    std::array<int, 3> SharedMemoryRing::Descriptors() const
+    {
+        return {this->memory_descriptor, this->data_ready_descriptor, this->space_ready_descriptor};
+    }
+
+    //* INFO: SharedMemoryChannel
+    SharedMemoryChannel::SharedMemoryChannel(std::size_t ring_bytes, std::size_t busy_poll_spins)
+        : inbound(ring_bytes), outbound(ring_bytes)
+    {
+        this->inbound.SetBusyPollSpins(busy_poll_spins);
+        this->outbound.SetBusyPollSpins(busy_poll_spins);
+    }
+
+    bool SharedMemoryChannel::IsOpen() const
+    {
+        return this->inbound.IsOpen() && this->outbound.IsOpen();
+    }
+
+    std::size_t SharedMemoryChannel::Capacity() const
+    {
+        return this->inbound.Capacity();
+    }
+
+    RingStatus SharedMemoryChannel::Send(std::string_view message, std::chrono::milliseconds timeout, int hangup_descriptor)
+    {
+        std::lock_guard<std::mutex> lock(this->outbound_mutex);
+        return this->outbound.Write(message, timeout, hangup_descriptor);
+    }
+
+    RingStatus SharedMemoryChannel::Receive(std::string &message, std::chrono::milliseconds timeout, int hangup_descriptor)
+    {
+        return this->inbound.Read(message, timeout, hangup_descriptor);
+    }
+
+    void SharedMemoryChannel::Close()
+    {
+        this->inbound.Close();
+        this->outbound.Close();
+    }
+
+    std::vector<int> SharedMemoryChannel::Descriptors() const
+    {
+        std::vector<int> descriptors;
+        for (int descriptor : this->inbound.Descriptors())
+        {
+            descriptors.push_back(descriptor);
+        }
+        for (int descriptor : this->outbound.Descriptors())
+        {
+            descriptors.push_back(descriptor);
+        }
+        return descriptors;
+    }
+}
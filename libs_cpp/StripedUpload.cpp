@@ -0,0 +1,277 @@
+#include "../include/StripedUpload.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+namespace SN_Server
+{
+    namespace
+    {
+        bool DrawRandom(std::uint64_t &value)
+        {
+            std::size_t filled = 0;
+            while (filled < sizeof(value))
+            {
+                ssize_t bytes_drawn = ::getrandom(reinterpret_cast<char *>(&value) + filled, sizeof(value) - filled, 0);
+                if (bytes_drawn < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (bytes_drawn < 0)
+                {
+                    std::cerr << "Error: Unable to draw a transfer ID: " << std::strerror(errno) << std::endl;
+                    return false;
+                }
+                filled += static_cast<std::size_t>(bytes_drawn);
+            }
+            return true;
+        }
+    }
+
+    //* INFO: Striped Transfer
+    //*========================================================
+    StripedTransfer::StripedTransfer(const std::string &transfer_file, const std::string &destination, std::uint64_t file_size, std::size_t block_size)
+        : transfer_file(transfer_file),
+          destination(destination),
+          file_size(file_size),
+          block_size(block_size),
+          block_count(static_cast<std::size_t>((file_size + block_size - 1) / block_size)),
+          received_blocks(block_count, false),
+          last_activity(std::chrono::steady_clock::now())
+    {
+    }
+
+    /**
+     * @brief Reserve the whole file in one extent before any stripe arrives \n
+     * The file gets its final size at once, so every connection can write at its own offset
+     *
+     * @return true if the space is reserved (Or the filesystem cannot reserve, then the file is only sized)
+     */
+    bool StripedTransfer::Reserve()
+    {
+        int descriptor = ::open(this->transfer_file.c_str(), O_WRONLY | O_CLOEXEC);
+        if (descriptor < 0)
+        {
+            std::cerr << "Error: Unable to open " << this->transfer_file << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        bool is_reserved = this->file_size == 0 || ::fallocate(descriptor, 0, 0, static_cast<off_t>(this->file_size)) == 0;
+        if (!is_reserved && (errno == EOPNOTSUPP || errno == ENOSYS))
+        {
+            // No Single Extent, But The Stripes Still Need The File At Its Size
+            is_reserved = ::ftruncate(descriptor, static_cast<off_t>(this->file_size)) == 0;
+        }
+
+        if (!is_reserved)
+        {
+            std::cerr << "Error: Unable to reserve " << this->file_size << " bytes for " << this->transfer_file << ": " << std::strerror(errno) << std::endl;
+        }
+        ::close(descriptor);
+        return is_reserved;
+    }
+
+    bool StripedTransfer::GetRange(std::uint64_t first_block, std::uint64_t block_count, std::uint64_t &offset, std::uint64_t &bytes) const
+    {
+        if (block_count == 0 || first_block >= this->block_count || block_count > this->block_count - first_block)
+        {
+            return false;
+        }
+
+        offset = first_block * this->block_size;
+        bytes = std::min<std::uint64_t>(block_count * this->block_size, this->file_size - offset);
+        return true;
+    }
+
+    bool StripedTransfer::MarkReceived(std::uint64_t first_block, std::uint64_t block_count)
+    {
+        std::lock_guard<std::mutex> lock(this->blocks_mutex);
+        if (this->received_count == this->block_count)
+        {
+            // Completed Before, By Another Stripe
+            return false;
+        }
+
+        for (std::uint64_t block = first_block; block < first_block + block_count && block < this->block_count; block++)
+        {
+            if (!this->received_blocks[block])
+            {
+                this->received_blocks[block] = true;
+                this->received_count++;
+            }
+        }
+        return this->received_count == this->block_count;
+    }
+
+    std::string StripedTransfer::MissingRanges(std::size_t max_ranges) const
+    {
+        std::lock_guard<std::mutex> lock(this->blocks_mutex);
+
+        std::string ranges;
+        std::size_t range_count = 0;
+        std::size_t block = 0;
+        while (block < this->block_count)
+        {
+            if (this->received_blocks[block])
+            {
+                block++;
+                continue;
+            }
+
+            std::size_t last_block = block;
+            while (last_block + 1 < this->block_count && !this->received_blocks[last_block + 1])
+            {
+                last_block++;
+            }
+
+            if (range_count == max_ranges)
+            {
+                ranges += ",...";
+                break;
+            }
+            if (range_count > 0)
+            {
+                ranges += ',';
+            }
+            ranges += std::to_string(block) + "-" + std::to_string(last_block);
+            range_count++;
+
+            block = last_block + 1;
+        }
+        return ranges;
+    }
+
+    void StripedTransfer::BeginStripe()
+    {
+        std::lock_guard<std::mutex> lock(this->blocks_mutex);
+        this->active_stripes++;
+        this->last_activity = std::chrono::steady_clock::now();
+    }
+
+    void StripedTransfer::EndStripe()
+    {
+        std::lock_guard<std::mutex> lock(this->blocks_mutex);
+        this->active_stripes--;
+        this->last_activity = std::chrono::steady_clock::now();
+    }
+
+    bool StripedTransfer::IsIdleFor(std::chrono::steady_clock::duration idle_timeout) const
+    {
+        std::lock_guard<std::mutex> lock(this->blocks_mutex);
+        return this->active_stripes == 0 && std::chrono::steady_clock::now() - this->last_activity >= idle_timeout;
+    }
+
+    const std::string &StripedTransfer::TransferFile() const
+    {
+        return this->transfer_file;
+    }
+
+    const std::string &StripedTransfer::Destination() const
+    {
+        return this->destination;
+    }
+
+    std::uint64_t StripedTransfer::FileSize() const
+    {
+        return this->file_size;
+    }
+
+    std::size_t StripedTransfer::BlockSize() const
+    {
+        return this->block_size;
+    }
+
+    std::size_t StripedTransfer::BlockCount() const
+    {
+        return this->block_count;
+    }
+
+    std::size_t StripedTransfer::ReceivedCount() const
+    {
+        std::lock_guard<std::mutex> lock(this->blocks_mutex);
+        return this->received_count;
+    }
+
+    //* INFO: Striped Uploads
+    //*========================================================
+    std::string StripedUploads::Add(std::shared_ptr<StripedTransfer> transfer)
+    {
+        std::lock_guard<std::mutex> lock(this->transfers_mutex);
+        while (true)
+        {
+            // 16 Hex Digits Straight From The Kernel's CSPRNG: Unlike A Seeded PRNG, The IDs
+            // Handed Out Before Tell Nothing About The Next One, So No Client Can Guess Its Way In
+            std::uint64_t random_id = 0;
+            if (!DrawRandom(random_id))
+            {
+                return "";
+            }
+
+            char transfer_id[17];
+            std::snprintf(transfer_id, sizeof(transfer_id), "%016llx", static_cast<unsigned long long>(random_id));
+            if (this->transfers.emplace(transfer_id, transfer).second)
+            {
+                return transfer_id;
+            }
+        }
+    }
+
+    std::shared_ptr<StripedTransfer> StripedUploads::Find(const std::string &transfer_id)
+    {
+        std::lock_guard<std::mutex> lock(this->transfers_mutex);
+        auto transfer = this->transfers.find(transfer_id);
+        return transfer == this->transfers.end() ? nullptr : transfer->second;
+    }
+
+    std::shared_ptr<StripedTransfer> StripedUploads::Remove(const std::string &transfer_id)
+    {
+        std::lock_guard<std::mutex> lock(this->transfers_mutex);
+        auto transfer = this->transfers.find(transfer_id);
+        if (transfer == this->transfers.end())
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<StripedTransfer> removed = transfer->second;
+        this->transfers.erase(transfer);
+        return removed;
+    }
+
+    bool StripedUploads::Abort(const std::string &transfer_id)
+    {
+        std::shared_ptr<StripedTransfer> transfer = this->Remove(transfer_id);
+        if (!transfer)
+        {
+            return false;
+        }
+
+        // A Stripe Still Being Written Keeps Writing Into The Deleted File, Then Fails To Complete
+        std::remove(transfer->TransferFile().c_str());
+        return true;
+    }
+
+    void StripedUploads::AbortAll()
+    {
+        std::unordered_map<std::string, std::shared_ptr<StripedTransfer>> aborted;
+        {
+            std::lock_guard<std::mutex> lock(this->transfers_mutex);
+            aborted.swap(this->transfers);
+        }
+
+        for (auto &transfer : aborted)
+        {
+            std::remove(transfer.second->TransferFile().c_str());
+        }
+    }
+
+    std::size_t StripedUploads::Size()
+    {
+        std::lock_guard<std::mutex> lock(this->transfers_mutex);
+        return this->transfers.size();
+    }
+}
@@ -0,0 +1,151 @@
+#include "../include/TimingWheel.h"
+
+namespace SN_Server
+{
+    /**
+     * @brief Construct a new Timing Wheel object \n
+     * One turn of the wheel lasts tick * slot_count, longer delays just wait some more turns
+     *
+     * @param io_context where the ticks and the handlers run
+     * @param tick the resolution of every timer
+     * @param slot_count how many slots the timers are hashed into
+     */
+    TimingWheel::TimingWheel(boost::asio::io_context &io_context, std::chrono::milliseconds tick, std::size_t slot_count)
+        : wheel_strand(boost::asio::make_strand(io_context)),
+          tick_timer(wheel_strand),
+          tick(tick.count() > 0 ? tick : std::chrono::milliseconds(1)),
+          slots(slot_count > 0 ? slot_count : 1)
+    {
+    }
+
+    void TimingWheel::Start()
+    {
+        boost::asio::post(this->wheel_strand, [self = this->shared_from_this()]() {
+            if (self->is_running)
+            {
+                return;
+            }
+            self->is_running = true;
+            {
+                std::lock_guard<std::mutex> lock(self->wheel_mutex);
+                self->next_tick = std::chrono::steady_clock::now() + self->tick;
+            }
+            self->WaitForTick();
+        });
+    }
+
+    void TimingWheel::Stop()
+    {
+        boost::asio::post(this->wheel_strand, [self = this->shared_from_this()]() {
+            self->is_running = false;
+            self->tick_timer.cancel();
+        });
+    }
+
+    void TimingWheel::WaitForTick()
+    {
+        // Deadlines Are Absolute, So A Late Tick Does Not Push Back The Ones After It
+        this->tick_timer.expires_at(this->next_tick);
+        this->tick_timer.async_wait([weak_wheel = this->weak_from_this()](const boost::system::error_code &error) {
+            std::shared_ptr<TimingWheel> wheel = weak_wheel.lock();
+            if (error || !wheel || !wheel->is_running)
+            {
+                return;
+            }
+            wheel->Advance();
+            wheel->WaitForTick();
+        });
+    }
+
+    /**
+     * @brief Move the wheel over every tick that has passed (More than one if the io_context was busy) \n
+     * and run the timers that are due in those slots
+     */
+    void TimingWheel::Advance()
+    {
+        std::list<Entry> expired;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(this->wheel_mutex);
+            while (this->next_tick <= now)
+            {
+                this->next_tick += this->tick;
+                this->current_slot = (this->current_slot + 1) % this->slots.size();
+
+                std::list<Entry> &slot = this->slots[this->current_slot];
+                for (auto entry = slot.begin(); entry != slot.end();)
+                {
+                    if (entry->rounds > 0)
+                    {
+                        // Due On A Later Turn
+                        entry->rounds--;
+                        ++entry;
+                        continue;
+                    }
+
+                    this->scheduled.erase(entry->id);
+                    auto due = entry++;
+                    expired.splice(expired.end(), slot, due);
+                }
+            }
+        }
+
+        for (Entry &entry : expired)
+        {
+            entry.handler();
+        }
+    }
+
+    TimerId TimingWheel::Schedule(std::chrono::milliseconds delay, std::function<void()> handler)
+    {
+        std::lock_guard<std::mutex> lock(this->wheel_mutex);
+
+        // Count From The Next Tick (Not From Now), So A Timer Never Fires Early
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::milliseconds after_next_tick = delay;
+        if (this->next_tick > now)
+        {
+            after_next_tick -= std::chrono::ceil<std::chrono::milliseconds>(this->next_tick - now);
+        }
+        std::uint64_t ticks = 1;
+        if (after_next_tick.count() > 0)
+        {
+            ticks += static_cast<std::uint64_t>((after_next_tick.count() + this->tick.count() - 1) / this->tick.count());
+        }
+        std::size_t slot_index = (this->current_slot + ticks % this->slots.size()) % this->slots.size();
+
+        // A Whole Number Of Turns Lands Back On The Current Slot, Which Is Next Visited One Turn From Now
+        std::uint64_t rounds = (ticks - 1) / this->slots.size();
+
+        TimerId id = ++this->last_id;
+        std::list<Entry> &slot = this->slots[slot_index];
+        slot.push_back(Entry{id, rounds, std::move(handler)});
+        this->scheduled.emplace(id, std::make_pair(slot_index, std::prev(slot.end())));
+        return id;
+    }
+
+    bool TimingWheel::Cancel(TimerId id)
+    {
+        std::lock_guard<std::mutex> lock(this->wheel_mutex);
+        auto found = this->scheduled.find(id);
+        if (found == this->scheduled.end())
+        {
+            return false;
+        }
+
+        this->slots[found->second.first].erase(found->second.second);
+        this->scheduled.erase(found);
+        return true;
+    }
+
+    std::size_t TimingWheel::ScheduledCount()
+    {
+        std::lock_guard<std::mutex> lock(this->wheel_mutex);
+        return this->scheduled.size();
+    }
+
+    std::chrono::milliseconds TimingWheel::Tick() const
+    {
+        return this->tick;
+    }
+}
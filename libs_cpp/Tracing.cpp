@@ -0,0 +1,327 @@
+#include "../include/Tracing.h"
+#include "../include/JsonMessage.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace SN_Server
+{
+    namespace
+    {
+        std::atomic<std::uint64_t> last_tracer_id{0};
+
+        //* What The Calling Thread Is Tracing Right Now
+        struct ThreadTraceContext
+        {
+            Tracer *tracer = nullptr;
+            std::uint64_t trace_id = 0;
+
+            // This Thread's Buffer, And Which Tracer It Belongs To
+            std::uint64_t buffer_owner = 0;
+            std::shared_ptr<TraceBuffer> buffer;
+
+            ~ThreadTraceContext()
+            {
+                if (this->buffer)
+                {
+                    this->buffer->Retire();
+                }
+            }
+        };
+
+        thread_local ThreadTraceContext thread_trace;
+
+        void RecordSpan(const char *name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+        {
+            Tracer *tracer = thread_trace.tracer;
+            if (thread_trace.buffer_owner != tracer->GetId())
+            {
+                if (thread_trace.buffer)
+                {
+                    thread_trace.buffer->Retire();
+                }
+                thread_trace.buffer = tracer->RegisterThread();
+                thread_trace.buffer_owner = tracer->GetId();
+            }
+
+            TraceEvent event;
+            event.name = name;
+            event.trace_id = thread_trace.trace_id;
+            event.start_us = tracer->MicrosecondsSinceOrigin(start);
+            event.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            thread_trace.buffer->Push(event);
+        }
+    }
+
+    //* INFO: TraceBuffer
+    TraceBuffer::TraceBuffer(std::size_t capacity, std::uint32_t thread_index)
+        : events(std::max<std::size_t>(capacity, 1)), thread_index(thread_index)
+    {
+    }
+
+    void TraceBuffer::Push(const TraceEvent &event)
+    {
+        std::lock_guard<std::mutex> lock(this->events_mutex);
+        this->events[this->next_event] = event;
+        if (++this->next_event == this->events.size())
+        {
+            // Full -> Overwrite The Oldest
+            this->next_event = 0;
+            this->is_full = true;
+        }
+    }
+
+    void TraceBuffer::Retire()
+    {
+        std::lock_guard<std::mutex> lock(this->events_mutex);
+        if (!this->is_full)
+        {
+            // Most Connections Exit Long Before Their Ring Fills: Keep Only The Spans They Recorded
+            this->events.resize(this->next_event);
+            this->events.shrink_to_fit();
+        }
+        this->is_retired = true;
+    }
+
+    //* INFO: Tracer
+    /**
+     * @brief Construct a new Tracer object
+     *
+     * @param sample_every trace one request out of this many (1 traces all, 0 none)
+     * @param events_per_thread spans each thread keeps (Its oldest are overwritten past this)
+     * @param max_retired_buffers buffers of exited threads kept for the next trace file (Oldest are dropped past this)
+     */
+    Tracer::Tracer(std::uint32_t sample_every, std::size_t events_per_thread, std::size_t max_retired_buffers)
+        : tracer_id(++last_tracer_id),
+          sample_every(sample_every),
+          events_per_thread(events_per_thread),
+          max_retired_buffers(max_retired_buffers),
+          origin(std::chrono::steady_clock::now())
+    {
+    }
+
+    void Tracer::SetSampleEvery(std::uint32_t sample_every)
+    {
+        this->sample_every = sample_every;
+    }
+
+    std::uint32_t Tracer::GetSampleEvery() const
+    {
+        return this->sample_every;
+    }
+
+    std::uint64_t Tracer::StartTrace()
+    {
+        std::uint32_t every = this->sample_every;
+        if (every == 0 || this->requests_seen++ % every != 0)
+        {
+            return 0;
+        }
+        return ++this->last_trace_id;
+    }
+
+    /**
+     * @brief Give the calling thread its own buffer \n
+     * Threads come and go with their clients, so buffers of exited threads beyond max_retired_buffers are let go here
+     *
+     * @return std::shared_ptr<TraceBuffer> the new buffer
+     */
+    std::shared_ptr<TraceBuffer> Tracer::RegisterThread()
+    {
+        std::lock_guard<std::mutex> lock(this->buffers_mutex);
+
+        std::size_t retired = std::count_if(this->buffers.begin(), this->buffers.end(), [](const std::shared_ptr<TraceBuffer> &buffer) {
+            return buffer->is_retired.load();
+        });
+        for (auto buffer = this->buffers.begin(); buffer != this->buffers.end() && retired > this->max_retired_buffers;)
+        {
+            if ((*buffer)->is_retired)
+            {
+                buffer = this->buffers.erase(buffer);
+                retired--;
+                continue;
+            }
+            ++buffer;
+        }
+
+        std::shared_ptr<TraceBuffer> buffer = std::make_shared<TraceBuffer>(this->events_per_thread, this->next_thread_index++);
+        this->buffers.push_back(buffer);
+        return buffer;
+    }
+
+    std::uint64_t Tracer::GetId() const
+    {
+        return this->tracer_id;
+    }
+
+    std::int64_t Tracer::MicrosecondsSinceOrigin(std::chrono::steady_clock::time_point time) const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time - this->origin).count();
+    }
+
+    /**
+     * @brief Write every buffered span as complete ("X") events, one "tid" per thread, "trace" in the args \n
+     * Recording goes on meanwhile: each buffer is only locked while it is copied
+     *
+     * @param trace_file the JSON file to write
+     * @return true if the file was written
+     */
+    bool Tracer::WriteChromeTrace(const std::string &trace_file)
+    {
+        std::vector<std::shared_ptr<TraceBuffer>> buffers_to_write;
+        {
+            std::lock_guard<std::mutex> lock(this->buffers_mutex);
+            buffers_to_write = this->buffers;
+        }
+
+        std::string trace_json;
+        JsonWriter writer(trace_json);
+        writer.BeginObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.BeginArray();
+
+        std::vector<TraceEvent> events;
+        for (const std::shared_ptr<TraceBuffer> &buffer : buffers_to_write)
+        {
+            {
+                std::lock_guard<std::mutex> lock(buffer->events_mutex);
+                if (buffer->is_full)
+                {
+                    events.assign(buffer->events.begin() + buffer->next_event, buffer->events.end());
+                    events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next_event);
+                }
+                else
+                {
+                    events.assign(buffer->events.begin(), buffer->events.begin() + buffer->next_event);
+                }
+            }
+
+            if (events.empty())
+            {
+                continue;
+            }
+
+            // Name The Thread's Track
+            writer.BeginObject();
+            writer.Key("name");
+            writer.String("thread_name");
+            writer.Key("ph");
+            writer.String("M");
+            writer.Key("pid");
+            writer.UInt(1);
+            writer.Key("tid");
+            writer.UInt(buffer->thread_index);
+            writer.Key("args");
+            writer.BeginObject();
+            writer.Key("name");
+            writer.String("thread " + std::to_string(buffer->thread_index));
+            writer.EndObject();
+            writer.EndObject();
+
+            for (const TraceEvent &event : events)
+            {
+                writer.BeginObject();
+                writer.Key("name");
+                writer.String(event.name);
+                writer.Key("cat");
+                writer.String("server");
+                writer.Key("ph");
+                writer.String("X");
+                writer.Key("ts");
+                writer.Int(event.start_us);
+                writer.Key("dur");
+                writer.Int(event.duration_us);
+                writer.Key("pid");
+                writer.UInt(1);
+                writer.Key("tid");
+                writer.UInt(buffer->thread_index);
+                writer.Key("args");
+                writer.BeginObject();
+                writer.Key("trace");
+                writer.UInt(event.trace_id);
+                writer.EndObject();
+                writer.EndObject();
+            }
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+
+        std::ofstream output(trace_file, std::ios::binary | std::ios::trunc);
+        if (!output.is_open())
+        {
+            std::cerr << "Error: Unable to open trace file " << trace_file << std::endl;
+            return false;
+        }
+        output.write(trace_json.data(), static_cast<std::streamsize>(trace_json.size()));
+        return static_cast<bool>(output);
+    }
+
+    void Tracer::Clear()
+    {
+        std::lock_guard<std::mutex> lock(this->buffers_mutex);
+        for (auto buffer = this->buffers.begin(); buffer != this->buffers.end();)
+        {
+            if ((*buffer)->is_retired)
+            {
+                buffer = this->buffers.erase(buffer);
+                continue;
+            }
+
+            std::lock_guard<std::mutex> events_lock((*buffer)->events_mutex);
+            (*buffer)->next_event = 0;
+            (*buffer)->is_full = false;
+            ++buffer;
+        }
+    }
+
+    //* INFO: TraceScope
+    TraceScope::TraceScope(Tracer *tracer, const char *name)
+        : name(name),
+          previous_tracer(thread_trace.tracer),
+          previous_trace_id(thread_trace.trace_id)
+    {
+        // Inside A Sampled Request -> Part Of It, Else Sample A New One
+        if (this->previous_trace_id == 0)
+        {
+            std::uint64_t trace_id = tracer != nullptr ? tracer->StartTrace() : 0;
+            thread_trace.tracer = trace_id != 0 ? tracer : nullptr;
+            thread_trace.trace_id = trace_id;
+        }
+
+        if (thread_trace.trace_id != 0)
+        {
+            this->start = std::chrono::steady_clock::now();
+        }
+    }
+
+    TraceScope::~TraceScope()
+    {
+        if (thread_trace.trace_id != 0)
+        {
+            RecordSpan(this->name, this->start, std::chrono::steady_clock::now());
+        }
+        thread_trace.tracer = this->previous_tracer;
+        thread_trace.trace_id = this->previous_trace_id;
+    }
+
+    //* INFO: TraceSpan
+    TraceSpan::TraceSpan(const char *name)
+        : name(name), is_recording(thread_trace.trace_id != 0)
+    {
+        if (this->is_recording)
+        {
+            this->start = std::chrono::steady_clock::now();
+        }
+    }
+
+    TraceSpan::~TraceSpan()
+    {
+        if (this->is_recording)
+        {
+            RecordSpan(this->name, this->start, std::chrono::steady_clock::now());
+        }
+    }
+}
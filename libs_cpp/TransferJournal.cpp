@@ -0,0 +1,211 @@
+#include "../include/TransferJournal.h"
+#include <chrono>
+#include <iostream>
+
+namespace SN_Server
+{
+    namespace
+    {
+        const char *const CREATE_TABLE_SQL =
+            "CREATE TABLE IF NOT EXISTS transfers ("
+            "id INTEGER PRIMARY KEY, "
+            "time_ms INTEGER NOT NULL, "
+            "peer TEXT NOT NULL, "
+            "operation TEXT NOT NULL, "
+            "file TEXT NOT NULL, "
+            "bytes INTEGER NOT NULL, "
+            "status TEXT NOT NULL)";
+
+        const char *const INSERT_SQL =
+            "INSERT INTO transfers (time_ms, peer, operation, file, bytes, status) VALUES (?1, ?2, ?3, ?4, ?5, ?6)";
+
+        bool Execute(sqlite3 *database, const char *sql)
+        {
+            char *error_message = nullptr;
+            if (sqlite3_exec(database, sql, nullptr, nullptr, &error_message) != SQLITE_OK)
+            {
+                std::cerr << "Error: Transfer journal: " << (error_message ? error_message : "unknown error") << " (" << sql << ")" << std::endl;
+                sqlite3_free(error_message);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Open (or create) the journal and start its writer thread
+     *
+     * @param database_file the SQLite database file
+     * @param max_pending_records how many records may wait for the writer before new ones are dropped
+     */
+    TransferJournal::TransferJournal(const std::string &database_file, std::size_t max_pending_records)
+        : max_pending_records(max_pending_records)
+    {
+        // Only The Writer Thread Uses The Connection
+        if (sqlite3_open_v2(database_file.c_str(), &this->database,
+                            SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "Error: Unable to open transfer journal " << database_file << ": " << sqlite3_errmsg(this->database) << std::endl;
+            sqlite3_close(this->database);
+            this->database = nullptr;
+            return;
+        }
+
+        // WAL: Readers Never Block The Writer, And A Commit Is One Sequential Append
+        // synchronous=NORMAL: fsync At Checkpoints Only (A Crash Can Lose The Last Batches, Never Corrupt)
+        bool ready = Execute(this->database, "PRAGMA journal_mode=WAL") &&
+                     Execute(this->database, "PRAGMA synchronous=NORMAL") &&
+                     Execute(this->database, CREATE_TABLE_SQL) &&
+                     sqlite3_prepare_v3(this->database, INSERT_SQL, -1, SQLITE_PREPARE_PERSISTENT, &this->insert_statement, nullptr) == SQLITE_OK;
+        if (!ready)
+        {
+            std::cerr << "Error: Unable to prepare transfer journal " << database_file << ": " << sqlite3_errmsg(this->database) << std::endl;
+            sqlite3_finalize(this->insert_statement);
+            this->insert_statement = nullptr;
+            sqlite3_close(this->database);
+            this->database = nullptr;
+            return;
+        }
+
+        this->writer_thread = std::thread([this]() {
+            this->WriterLoop();
+        });
+    }
+
+    TransferJournal::~TransferJournal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->pending_mutex);
+            this->stopping = true;
+        }
+        this->pending_ready.notify_all();
+
+        // The Writer Drains The Queue Before It Exits
+        if (this->writer_thread.joinable())
+        {
+            this->writer_thread.join();
+        }
+
+        sqlite3_finalize(this->insert_statement);
+        sqlite3_close(this->database);
+    }
+
+    bool TransferJournal::IsOpen() const
+    {
+        return this->database != nullptr;
+    }
+
+    void TransferJournal::Record(TransferRecord record)
+    {
+        if (!this->IsOpen())
+        {
+            return;
+        }
+
+        if (record.time_ms == 0)
+        {
+            record.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()
+            ).count();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->pending_mutex);
+            if (this->pending_records.size() >= this->max_pending_records)
+            {
+                // The Disk Cannot Keep Up -> Lose The Record Rather Than Stall The Transfer
+                this->dropped_records++;
+                return;
+            }
+            this->pending_records.push_back(std::move(record));
+        }
+        this->pending_ready.notify_one();
+    }
+
+    void TransferJournal::Flush()
+    {
+        std::unique_lock<std::mutex> lock(this->pending_mutex);
+        this->pending_written.wait(lock, [this]() {
+            return !this->writer_thread.joinable() || (this->pending_records.empty() && !this->writer_busy);
+        });
+    }
+
+    std::uint64_t TransferJournal::WrittenRecords() const
+    {
+        return this->written_records;
+    }
+
+    std::uint64_t TransferJournal::DroppedRecords() const
+    {
+        return this->dropped_records;
+    }
+
+    /**
+     * @brief Take everything queued in one swap and write it as one transaction \n
+     * While a batch is written new records pile up in the other vector, so a busy server gets bigger batches
+     */
+    void TransferJournal::WriterLoop()
+    {
+        std::vector<TransferRecord> batch;
+        std::unique_lock<std::mutex> lock(this->pending_mutex);
+        while (true)
+        {
+            this->pending_ready.wait(lock, [this]() {
+                return this->stopping || !this->pending_records.empty();
+            });
+
+            if (this->pending_records.empty())
+            {
+                // Stopping And Nothing Left
+                break;
+            }
+
+            // Swap Keeps The Capacity Of Both Vectors
+            batch.swap(this->pending_records);
+            this->writer_busy = true;
+            lock.unlock();
+
+            this->WriteBatch(batch);
+            batch.clear();
+
+            lock.lock();
+            this->writer_busy = false;
+            this->pending_written.notify_all();
+        }
+    }
+
+    void TransferJournal::WriteBatch(const std::vector<TransferRecord> &batch)
+    {
+        if (!Execute(this->database, "BEGIN"))
+        {
+            return;
+        }
+
+        for (const TransferRecord &record : batch)
+        {
+            // The Strings Outlive The Step -> Bind Them Without Copies
+            sqlite3_bind_int64(this->insert_statement, 1, record.time_ms);
+            sqlite3_bind_text(this->insert_statement, 2, record.peer.data(), static_cast<int>(record.peer.size()), SQLITE_STATIC);
+            sqlite3_bind_text(this->insert_statement, 3, record.operation.data(), static_cast<int>(record.operation.size()), SQLITE_STATIC);
+            sqlite3_bind_text(this->insert_statement, 4, record.file.data(), static_cast<int>(record.file.size()), SQLITE_STATIC);
+            sqlite3_bind_int64(this->insert_statement, 5, static_cast<sqlite3_int64>(record.bytes));
+            sqlite3_bind_text(this->insert_statement, 6, record.status.data(), static_cast<int>(record.status.size()), SQLITE_STATIC);
+
+            if (sqlite3_step(this->insert_statement) != SQLITE_DONE)
+            {
+                std::cerr << "Error: Transfer journal insert: " << sqlite3_errmsg(this->database) << std::endl;
+            }
+            sqlite3_reset(this->insert_statement);
+        }
+        sqlite3_clear_bindings(this->insert_statement);
+
+        if (Execute(this->database, "COMMIT"))
+        {
+            this->written_records += batch.size();
+        }
+        else
+        {
+            Execute(this->database, "ROLLBACK");
+        }
+    }
+}
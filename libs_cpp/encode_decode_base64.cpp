@@ -20,8 +20,15 @@ namespace JB_Encode_Decode_Base64
         // Find the position of the dot before the file extension
         std::size_t dot_position = input_file_name.find_last_of('.');
 
-        // Extract The substring before the dot
-        std::string prefix = input_file_name.substr(0, dot_position  - 1);
+        // A Dot In A Directory Name Is Not An Extension
+        std::size_t slash_position = input_file_name.find_last_of("/\\");
+        if (slash_position != std::string::npos && dot_position != std::string::npos && dot_position < slash_position)
+        {
+            dot_position = std::string::npos;
+        }
+
+        // Extract The substring before the dot (The Whole Name If There Is No Extension)
+        std::string prefix = input_file_name.substr(0, dot_position);
 
         // Create a new file name by appending '.txt'
         std::string new_file_name = prefix + "_temp.txt";
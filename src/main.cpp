@@ -1,5 +1,6 @@
 #include <utility> // Include this line before Boost.Asio headers
 #include "../include/Server.h"
+#include "../include/ServerConfig.h"
 #include "../include/encode_decode_base64.h"
 #include <iostream>
 #include <csignal>
@@ -11,12 +12,44 @@ void HandleSignal(int signal);
 // The Server
 std::shared_ptr<Server> server;
 
+// Its Configuration: Defaults < Profile < --config File < --key=value Arguments
+// e.g. ./main --config server.json --profile throughput --port 7000
+ServerConfig config;
+
 int main(int argc, char const *argv[])
 {
+    std::string config_error;
+    if (!LoadServerConfig(argc, argv, config, config_error))
+    {
+        std::cerr << "Error: " << config_error << std::endl;
+        return 1;
+    }
+
+    server = std::make_shared<Server>(config.bind_address, config.port);
+    if (!ApplyServerConfig(config, *server))
+    {
+        return 1;
+    }
+
     // Make a Signal To Turn Off the Server
-    std::signal(SIGINT, HandleSignal);
+    // HandleSignal Runs On The Server's Event Loop, Not Inside The Signal Context
+    server->OnSignals({SIGINT, SIGTERM}, HandleSignal);
+
+    // TLS, The Transfer Journal And JSON Framing Come From The Configuration
+    // ("tls.certificate"/"tls.private_key", "transfer_journal", "framing": "json")
+    // JSON Messages Are Dispatched By Their "type"
+    // server->OnJsonMessage("echo", [](std::shared_ptr<ClientConnection> client_socket, simdjson::ondemand::document &message) {
+    //     std::string_view text = message["text"];
+    //     server->SendJson(client_socket, [&](JsonWriter &reply) {
+    //         reply.BeginObject().Key("type").String("echo").Key("text").String(text).EndObject();
+    //     });
+    // });
 
-    server = std::make_shared<Server>("172.29.163.214", 6969);
+    // Text Requests Are "<COMMAND> <arguments>": ECHO, UPLOAD, STORE, DOWNLOAD And STATS Are Built In
+    // server->OnCommand("TIME", [](std::shared_ptr<ClientConnection> client_socket, std::string_view arguments) {
+    //     server->SendText(client_socket, std::to_string(std::time(nullptr)));
+    //     return ClientConnectionStatus::ConnectionOpen;
+    // });
 
     // Start The Server
     server->Start();
@@ -30,6 +63,14 @@ int main(int argc, char const *argv[])
                   << "In PID: " << getpid() << std::endl;
     }
 
+    // The Drain Is Over -> Join The Server's Threads
+    server->Stop();
+
+    if (!config.trace_file.empty())
+    {
+        server->WriteTrace(config.trace_file);
+    }
+
     return 0;
 }
 
@@ -42,12 +83,13 @@ void HandleSignal(int signal)
         statement = std::format("Received signal {0}. Initiating graceful shutdown.\n", signal);
         write(STDOUT_FILENO, statement.c_str(), statement.size());
         
-        // Call The Server To Stop
-        server->Stop();
+        // Let In-Flight Transfers Finish (Up To drain_deadline_ms), The Main Loop Stops Once The Drain Is Over
+        server->BeginDrain(config.drain_deadline);
         break;
 
     case SIGTERM:
         write(STDOUT_FILENO, "Terminate Called!\n", 19);
+        server->BeginDrain(config.drain_deadline);
         break;
 
     case SIGTSTP: